@@ -0,0 +1,11 @@
+# Write the bytes of the file INPUT to the file OUTPUT as a list of hexadecimal
+# literals, which can be included in the initializer of a C++ array.
+#
+#   cmake -DINPUT=<file> -DOUTPUT=<file> -P EmbedFile.cmake
+file(READ ${INPUT} content HEX)
+string(REGEX REPLACE "([0-9a-f][0-9a-f])" "0x\\1," content "${content}")
+
+# Sixteen bytes to a line
+string(REPEAT "0x..," 16 line)
+string(REGEX REPLACE "(${line})" "\\1\n" content "${content}")
+file(WRITE ${OUTPUT} "${content}\n")
@@ -2,6 +2,7 @@
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <time.h>
 
 /*
  * These are defined for each TIP program in the compiled code.
@@ -30,6 +31,18 @@ void _tip_error(int64_t x) {
   exit(-1);
 }
 
+/*
+ * runtime library function for the SIP clock expression
+ *    t = clock;
+ * The nanoseconds elapsed on a monotonic clock since an arbitrary point
+ * in the past, so only the differences between readings are meaningful.
+ */
+int64_t _tip_clock() {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (int64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+}
+
 /*
  * If the compiled program has no "main" function then one is created
  * that calls this function.
@@ -0,0 +1,23 @@
+#include "CodeGenContext.h"
+
+CodeGenContext::CodeGenContext(const CodeGenContext *program)
+    : ownedContext(std::make_shared<llvm::LLVMContext>()),
+      tables(program ? program->tables : std::make_shared<ProgramTables>()),
+      llvmContext(*ownedContext), irBuilder(llvmContext),
+      functionIndex(tables->functionIndex),
+      functionFormalNames(tables->functionFormalNames),
+      fieldIndex(tables->fieldIndex), fieldVector(tables->fieldVector),
+      zeroV(llvm::ConstantInt::get(llvm::Type::getInt64Ty(llvmContext), 0)),
+      oneV(llvm::ConstantInt::get(llvm::Type::getInt64Ty(llvmContext), 1)) {}
+
+/*
+ * The deleter of the module holds a reference to the LLVM context, which
+ * is released only after the module has been destroyed.
+ */
+std::shared_ptr<llvm::Module>
+CodeGenContext::createModule(const std::string &name) {
+  auto context = ownedContext;
+  return std::shared_ptr<llvm::Module>(
+      new llvm::Module(name, llvmContext),
+      [context](llvm::Module *module) { delete module; });
+}
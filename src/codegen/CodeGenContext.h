@@ -0,0 +1,126 @@
+#pragma once
+
+#include "llvm/IR/Constants.h"
+#include "llvm/IR/DerivedTypes.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/GlobalVariable.h"
+#include "llvm/IR/IRBuilder.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+/*! \class CodeGenContext
+ *  \brief State of the code generation for a single program.
+ *
+ * The code generation routines of the AST nodes share this state while
+ * they generate a module.  Each context owns its own LLVM context, so
+ * several programs can be compiled concurrently as long as each compilation
+ * uses a context of its own.  A context must not be shared between threads.
+ *
+ * The functions of a program can also be generated concurrently, each in a
+ * context derived from the context of the program.  Derived contexts share
+ * the function and field tables of the program, which are read-only once
+ * they have been built.
+ */
+class CodeGenContext {
+  // Owning reference to the LLVM context, shared with the generated modules
+  std::shared_ptr<llvm::LLVMContext> ownedContext;
+
+  // Tables describing the program, shared with derived contexts
+  struct ProgramTables {
+    std::map<std::string, int> functionIndex;
+    std::map<std::string, std::vector<std::string>> functionFormalNames;
+    std::map<std::string, int> fieldIndex;
+    std::vector<std::string> fieldVector;
+  };
+  std::shared_ptr<ProgramTables> tables;
+
+public:
+  /*! \brief Construct a context with an LLVM context of its own.
+   *
+   * \param program If not null, the new context is derived from the context
+   * of the program and shares its function and field tables.
+   */
+  explicit CodeGenContext(const CodeGenContext *program = nullptr);
+  CodeGenContext(const CodeGenContext &) = delete;
+  CodeGenContext &operator=(const CodeGenContext &) = delete;
+
+  /*! \brief Create a module in the LLVM context of this code generation.
+   *
+   * The module keeps the LLVM context alive, so it may outlive the
+   * CodeGenContext that created it.
+   * \param name The identifier of the module.
+   * \return The new module.
+   */
+  std::shared_ptr<llvm::Module> createModule(const std::string &name);
+
+  llvm::LLVMContext &llvmContext;
+  llvm::IRBuilder<> irBuilder;
+
+  /*
+   * Functions are represented with indices into a table.
+   * This permits function values to be passed, i.e, as Int64 indices.
+   */
+  std::map<std::string, int> &functionIndex;
+  std::map<std::string, std::vector<std::string>> &functionFormalNames;
+
+  std::map<std::string, llvm::AllocaInst *> namedValues;
+
+  llvm::StructType *globalRecordType = nullptr;
+  llvm::PointerType *pointerToGlobalRecordType = nullptr;
+
+  // Maps field names to their index in the globalRecord
+  std::map<std::string, int> &fieldIndex;
+
+  // Vector of fields in a global record
+  std::vector<std::string> &fieldVector;
+
+  // Permits getFunction to access the current module being compiled
+  std::shared_ptr<llvm::Module> CurrentModule;
+
+  // Directory caching the code generated for functions, none if empty
+  std::string functionCache;
+
+  /*
+   * We use calls to llvm intrinsics for several purposes.  To construct a
+   * "nop", using an LLVM internal intrinsic, to perform TIP specific IO, and
+   * to allocate heap memory.
+   */
+  llvm::Function *nop = nullptr;
+  llvm::Function *inputIntrinsic = nullptr;
+  llvm::Function *clockIntrinsic = nullptr;
+  llvm::Function *outputIntrinsic = nullptr;
+  llvm::Function *errorIntrinsic = nullptr;
+  llvm::Function *callocFun = nullptr;
+
+  // A counter to create shared labels
+  int labelNum = 0;
+
+  // Indicate whether the expression code gen is for an L-value
+  bool lValueGen = false;
+
+  // Indicate whether the expression code gen is for an alloc'd value
+  bool allocFlag = false;
+
+  llvm::GlobalVariable *tipFunctionTable = nullptr;
+
+  int64_t numTIPArgs = 0;
+
+  /*
+   * The global argument count and array are used to communicate command
+   * line inputs to the TIP main function.
+   */
+  llvm::GlobalVariable *tipNumInputs = nullptr;
+  llvm::GlobalVariable *tipInputArray = nullptr;
+
+  /*
+   * Some constants are used repeatedly in code generation.  We define them
+   * here to eliminate redundancy.
+   */
+  llvm::Constant *zeroV;
+  llvm::Constant *oneV;
+};
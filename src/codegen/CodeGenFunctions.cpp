@@ -2,8 +2,12 @@
 #include <ASTDeclNode.h>
 
 #include "AST.h"
+#include "CodeGenContext.h"
+#include "CompileCache.h"
 #include "InternalError.h"
+#include "Parallel.h"
 #include "SemanticAnalysis.h"
+#include "llvm/Bitcode/BitcodeReader.h"
 #include "llvm/Bitcode/BitcodeWriter.h"
 #include "llvm/IR/BasicBlock.h"
 #include "llvm/IR/Constants.h"
@@ -17,81 +21,19 @@
 #include "llvm/IR/Module.h"
 #include "llvm/IR/Type.h"
 #include "llvm/IR/Verifier.h"
+#include "llvm/Linker/Linker.h"
+#include "llvm/Support/raw_ostream.h"
 #include "llvm/Target/TargetMachine.h"
 #include "llvm/TargetParser/Host.h"
 #include "llvm/Transforms/Scalar.h"
 
 #include "loguru.hpp"
 
+#include <sstream>
+
 namespace
 {
 
-  llvm::LLVMContext llvmContext;
-  llvm::IRBuilder<> irBuilder(llvmContext);
-
-  /*
-   * Functions are represented with indices into a table.
-   * This permits function values to be passed, i.e, as Int64 indices.
-   */
-  std::map<std::string, int> functionIndex;
-  std::map<std::string, std::vector<std::string>> functionFormalNames;
-
-  std::map<std::string, llvm::AllocaInst *> namedValues;
-
-  llvm::StructType *globalRecordType;
-  llvm::StructType *globalArrayType;
-
-  llvm::PointerType *pointerToGlobalRecordType;
-
-  // Maps field names to their index in the globalRecord
-  std::map<std::basic_string<char>, int> fieldIndex;
-
-  // Vector of fields in a global record
-  std::vector<std::basic_string<char>> fieldVector;
-
-  // Permits getFunction to access the current module being compiled
-  std::shared_ptr<llvm::Module> CurrentModule;
-
-  /*
-   * We use calls to llvm intrinsics for several purposes.  To construct a "nop",
-   * using an LLVM internal intrinsic, to perform TIP specific IO, and
-   * to allocate heap memory.
-   */
-  llvm::Function *nop = nullptr;
-  llvm::Function *inputIntrinsic = nullptr;
-  llvm::Function *outputIntrinsic = nullptr;
-  llvm::Function *errorIntrinsic = nullptr;
-  llvm::Function *callocFun = nullptr;
-
-  // A counter to create shared labels
-  int labelNum = 0;
-
-  // Indicate whether the expression code gen is for an L-value
-  bool lValueGen = false;
-
-  // Indicate whether the expression code gen is for an alloc'd value
-  bool allocFlag = false;
-
-  llvm::GlobalVariable *tipFunctionTable = nullptr;
-
-  int64_t numTIPArgs = 0;
-
-  /*
-   * The global argument count and array are used to communicate command
-   * line inputs to the TIP main function.
-   */
-  llvm::GlobalVariable *tipNumInputs = nullptr;
-  llvm::GlobalVariable *tipInputArray = nullptr;
-
-  /*
-   * Some constants are used repeatedly in code generation.  We define them
-   * hear to eliminate redundancy.
-   */
-  llvm::Constant *zeroV =
-      llvm::ConstantInt::get(llvm::Type::getInt64Ty(llvmContext), 0);
-  llvm::Constant *oneV =
-      llvm::ConstantInt::get(llvm::Type::getInt64Ty(llvmContext), 1);
-
   /*
    * Create LLVM Function in Module associated with current program.
    * This function declares the function, but it does not generate code.
@@ -99,9 +41,10 @@ namespace
    * dispatch table.
    */
 
-  llvm::Function *getFunction(const std::string &functionName)
+  llvm::Function *getFunction(CodeGenContext &ctx,
+                              const std::string &functionName)
   {
-    auto formalNames = functionFormalNames[functionName];
+    auto formalNames = ctx.functionFormalNames.at(functionName);
 
     /*
      * Main is handled specially.  It is declared as "_tip_main" with
@@ -111,40 +54,42 @@ namespace
 
     if (functionName == "main")
     {
-      if (auto *M = CurrentModule->getFunction("_tip_main"))
+      if (auto *M = ctx.CurrentModule->getFunction("_tip_main"))
       {
         return M;
       }
 
-      numTIPArgs = formalNames.size();
+      ctx.numTIPArgs = formalNames.size();
 
       // Declare "_tip_main"
       auto *scratchModule = llvm::Function::Create(
-          llvm::FunctionType::get(llvm::Type::getInt64Ty(llvmContext), false),
+          llvm::FunctionType::get(llvm::Type::getInt64Ty(ctx.llvmContext),
+                                  false),
           llvm::Function::ExternalLinkage, "_tip_" + functionName,
-          CurrentModule.get());
+          ctx.CurrentModule.get());
       return scratchModule;
     }
     else
     {
-      if (auto *F = CurrentModule->getFunction(functionName))
+      if (auto *F = ctx.CurrentModule->getFunction(functionName))
       {
         return F;
       }
 
       // Function Not Found, Create it.
 
-      std::vector<llvm::Type *> FormalTypes(formalNames.size(),
-                                            llvm::Type::getInt64Ty(llvmContext));
+      std::vector<llvm::Type *> FormalTypes(
+          formalNames.size(), llvm::Type::getInt64Ty(ctx.llvmContext));
 
       // Use type factory to create function from formal type to int
 
       auto *scratchFunctionType = llvm::FunctionType::get(
-          llvm::Type::getInt64Ty(llvmContext), FormalTypes, false);
+          llvm::Type::getInt64Ty(ctx.llvmContext), FormalTypes, false);
 
+      // Made internal once the functions of the program have been linked
       auto *scratchFunction = llvm::Function::Create(
-          scratchFunctionType, llvm::Function::InternalLinkage, functionName,
-          CurrentModule.get());
+          scratchFunctionType, llvm::Function::ExternalLinkage, functionName,
+          ctx.CurrentModule.get());
 
       // assign names to function arguments
       unsigned i = 0;
@@ -165,8 +110,120 @@ namespace
   {
     llvm::IRBuilder<> tmpAlloca(&TheFunction->getEntryBlock(),
                                 TheFunction->getEntryBlock().begin());
-    return tmpAlloca.CreateAlloca(llvm::Type::getInt64Ty(llvmContext), nullptr,
-                                  VarName);
+    return tmpAlloca.CreateAlloca(
+        llvm::Type::getInt64Ty(TheFunction->getContext()), nullptr, VarName);
+  }
+  /*
+   * Declare the runtime support that is shared by all modules of a program,
+   * i.e., the calloc function used for heap allocation and the global record
+   * type.  The field table must be complete.
+   */
+  void declareRuntime(CodeGenContext &ctx)
+  {
+    // declare the calloc function
+    // the calloc function takes in two ints: the number of items and the size
+    // of the items
+    std::vector<llvm::Type *> twoInt(2,
+                                     llvm::Type::getInt64Ty(ctx.llvmContext));
+    auto *FT = llvm::FunctionType::get(
+        llvm::PointerType::get(ctx.llvmContext, 0), twoInt, false);
+    ctx.callocFun = llvm::Function::Create(FT, llvm::Function::ExternalLinkage,
+                                           "calloc", ctx.CurrentModule.get());
+    ctx.callocFun->addFnAttr(llvm::Attribute::NoUnwind);
+
+    ctx.callocFun->setAttributes(
+        ctx.callocFun->getAttributes().addAttributeAtIndex(
+            ctx.callocFun->getContext(), 0, llvm::Attribute::NoAlias));
+
+    /* We create a single unified record structure that is capable of
+     * representing all records in a TIP program.  While wasteful of memory,
+     * this approach is compatible with the limited type checking provided for
+     * records in TIP.
+     *
+     * We refer to this single unified record structure as the "global record"
+     */
+    std::vector<llvm::Type *> member_values(
+        ctx.fieldVector.size(), llvm::IntegerType::getInt64Ty(ctx.llvmContext));
+    ctx.globalRecordType = llvm::StructType::create(
+        ctx.llvmContext, member_values, "globalRecord");
+    ctx.pointerToGlobalRecordType = llvm::PointerType::get(ctx.llvmContext, 0);
+  }
+
+  /*
+   * Generate a function of the program compiled in the context program into
+   * a module of its own, which is returned as bitcode.  The module declares
+   * the globals of the program that the function refers to; they are
+   * resolved when the module is linked into the module of the program.
+   *
+   * Functions are generated concurrently, so the function is generated in a
+   * derived context that has an LLVM context of its own.
+   */
+  llvm::SmallVector<char, 0> generateFunction(const CodeGenContext &program,
+                                              const std::string &triple,
+                                              ASTFunction *fn)
+  {
+    CodeGenContext ctx(&program);
+    ctx.CurrentModule = ctx.createModule(fn->getName());
+    ctx.CurrentModule->setTargetTriple(triple);
+
+    ctx.nop = llvm::Intrinsic::getDeclaration(ctx.CurrentModule.get(),
+                                              llvm::Intrinsic::donothing);
+    declareRuntime(ctx);
+
+    auto *functionTableType =
+        llvm::ArrayType::get(llvm::PointerType::get(ctx.llvmContext, 0),
+                             ctx.functionIndex.size());
+    ctx.tipFunctionTable = new llvm::GlobalVariable(
+        *ctx.CurrentModule, functionTableType, true,
+        llvm::GlobalValue::ExternalLinkage, nullptr, "_tip_ftable");
+
+    if (fn->getName() == "main")
+    {
+      auto *inputArrayType =
+          llvm::ArrayType::get(llvm::Type::getInt64Ty(ctx.llvmContext),
+                               ctx.functionFormalNames.at("main").size());
+      ctx.tipInputArray = new llvm::GlobalVariable(
+          *ctx.CurrentModule, inputArrayType, false,
+          llvm::GlobalValue::ExternalLinkage, nullptr, "_tip_input_array");
+    }
+
+    fn->codegen(ctx);
+
+    llvm::SmallVector<char, 0> bitcode;
+    llvm::raw_svector_ostream stream(bitcode);
+    llvm::WriteBitcodeToFile(*ctx.CurrentModule, stream);
+    return bitcode;
+  }
+
+  /*
+   * The fingerprint of a function is the key of its code in the function
+   * cache.  Besides the source of the function, its code depends on the
+   * tables of the program, i.e., the indices and formals of the functions and
+   * the fields of the global record, which are described by layout.  The
+   * inferred types of the function and its callees are included too, so that
+   * its code is not reused once the types it is checked against change.
+   */
+  std::string fingerprint(SemanticAnalysis *semanticAnalysis,
+                          const std::string &layout, ASTFunction *fn)
+  {
+    auto *types = semanticAnalysis->getTypeResults();
+    std::vector<std::string> settings{layout};
+    std::stringstream type;
+    type << *types->getInferredType(fn->getDecl());
+    settings.push_back(type.str());
+
+    std::map<std::string, std::string> callees;
+    for (auto *callee : semanticAnalysis->getCallGraph()->getCallees(fn))
+    {
+      std::stringstream calleeType;
+      calleeType << *types->getInferredType(callee->getDecl());
+      callees[callee->getName()] = calleeType.str();
+    }
+    for (auto &callee : callees)
+    {
+      settings.push_back(callee.first + ":" + callee.second);
+    }
+    return CompileCache::key(fn->getSourceHash(), settings);
   }
 } // namespace
 
@@ -174,22 +231,37 @@ namespace
 
 std::shared_ptr<llvm::Module>
 ASTProgram::codegen(SemanticAnalysis *semanticAnalysis,
-                    const std::string &programName)
+                    const std::string &programName, unsigned jobs)
+{
+  CodeGenContext ctx;
+  return codegen(ctx, semanticAnalysis, programName, jobs);
+}
+
+/*
+ * The program module holds the globals of the program and declarations of its
+ * functions.  The functions themselves are generated concurrently, each into
+ * a module of its own, and are then linked into the program module in program
+ * order.  Each function is generated and linked the same way regardless of the
+ * number of jobs, so the resulting module does not depend on it.
+ */
+std::shared_ptr<llvm::Module>
+ASTProgram::codegen(CodeGenContext &ctx, SemanticAnalysis *semanticAnalysis,
+                    const std::string &programName, unsigned jobs)
 {
   LOG_S(1) << "Generating code for program " << programName;
 
-  auto TheModule = std::make_shared<llvm::Module>(programName, llvmContext);
+  auto TheModule = ctx.createModule(programName);
 
   llvm::Triple targetTriple(llvm::sys::getProcessTriple());
   TheModule->setTargetTriple(targetTriple.str());
 
-  nop = llvm::Intrinsic::getDeclaration(TheModule.get(),
-                                        llvm::Intrinsic::donothing);
+  ctx.nop = llvm::Intrinsic::getDeclaration(TheModule.get(),
+                                            llvm::Intrinsic::donothing);
 
-  labelNum = 0;
+  ctx.labelNum = 0;
 
   // Transfer the module for access by shared codegen routines
-  CurrentModule = std::move(TheModule);
+  ctx.CurrentModule = std::move(TheModule);
 
   /*
    * This shallow pass over the function declarations builds the
@@ -205,7 +277,7 @@ ASTProgram::codegen(SemanticAnalysis *semanticAnalysis,
     int funIndex = 0;
     for (auto const &fn : ASTProgram::getFunctions())
     {
-      functionIndex[fn->getName()] = funIndex++;
+      ctx.functionIndex[fn->getName()] = funIndex++;
 
       auto formalNames = fn->getFormals();
       std::vector<std::string> names;
@@ -214,7 +286,7 @@ ASTProgram::codegen(SemanticAnalysis *semanticAnalysis,
                      [](auto &d)
                      { return d->getName(); });
 
-      functionFormalNames[fn->getName()] = names;
+      ctx.functionFormalNames[fn->getName()] = names;
     }
 
     /*
@@ -228,11 +300,11 @@ ASTProgram::codegen(SemanticAnalysis *semanticAnalysis,
     std::vector<llvm::Constant *> programFunctions;
     for (auto const &func : ASTProgram::getFunctions())
     {
-      programFunctions.emplace_back(getFunction(func->getName()));
+      programFunctions.emplace_back(getFunction(ctx, func->getName()));
     }
 
     // Holder for function pointer.
-    auto *FunctionOpaquePtrType = llvm::PointerType::get(llvmContext, 0);
+    auto *FunctionOpaquePtrType = llvm::PointerType::get(ctx.llvmContext, 0);
     // Create Record Dispatch Table
 
     // Function table is array of pointers, which is the size of funIndex, i.e.
@@ -254,10 +326,14 @@ ASTProgram::codegen(SemanticAnalysis *semanticAnalysis,
     auto *ftableInit =
         llvm::ConstantArray::get(functionTableType, castProgramFunctions);
 
-    // Create the global function dispatch table
-    tipFunctionTable = new llvm::GlobalVariable(
-        *CurrentModule, functionTableType, true,
-        llvm::GlobalValue::InternalLinkage, ftableInit, "_tip_ftable");
+    /*
+     * Create the global function dispatch table.  It is external until
+     * the functions have been linked so that their references to it are
+     * resolved.
+     */
+    ctx.tipFunctionTable = new llvm::GlobalVariable(
+        *ctx.CurrentModule, functionTableType, true,
+        llvm::GlobalValue::ExternalLinkage, ftableInit, "_tip_ftable");
   }
 
   /*
@@ -273,95 +349,162 @@ ASTProgram::codegen(SemanticAnalysis *semanticAnalysis,
      * we never visit it during the codegen() traversals - since
      * the function doesn't exist in the TIP program.
      */
-    auto fidx = functionIndex.find("main");
-    if (fidx == functionIndex.end())
+    auto fidx = ctx.functionIndex.find("main");
+    if (fidx == ctx.functionIndex.end())
     {
       auto *M = llvm::Function::Create(
-          llvm::FunctionType::get(llvm::Type::getInt64Ty(llvmContext), false),
-          llvm::Function::ExternalLinkage, "_tip_main", CurrentModule.get());
-      llvm::BasicBlock *BB = llvm::BasicBlock::Create(llvmContext, "entry", M);
-      irBuilder.SetInsertPoint(BB);
+          llvm::FunctionType::get(llvm::Type::getInt64Ty(ctx.llvmContext),
+                                  false),
+          llvm::Function::ExternalLinkage, "_tip_main",
+          ctx.CurrentModule.get());
+      llvm::BasicBlock *BB =
+          llvm::BasicBlock::Create(ctx.llvmContext, "entry", M);
+      ctx.irBuilder.SetInsertPoint(BB);
 
       auto *undef = llvm::Function::Create(
-          llvm::FunctionType::get(llvm::Type::getVoidTy(llvmContext), false),
+          llvm::FunctionType::get(llvm::Type::getVoidTy(ctx.llvmContext),
+                                  false),
           llvm::Function::ExternalLinkage, "_tip_main_undefined",
-          CurrentModule.get());
-      irBuilder.CreateCall(undef);
-      irBuilder.CreateRet(zeroV);
+          ctx.CurrentModule.get());
+      ctx.irBuilder.CreateCall(undef);
+      ctx.irBuilder.CreateRet(ctx.zeroV);
     }
 
     // create global _tip_num_inputs with init of numTIPArgs
-    tipNumInputs = new llvm::GlobalVariable(
-        *CurrentModule, llvm::Type::getInt64Ty(llvmContext), true,
+    ctx.tipNumInputs = new llvm::GlobalVariable(
+        *ctx.CurrentModule, llvm::Type::getInt64Ty(ctx.llvmContext), true,
         llvm::GlobalValue::ExternalLinkage,
-        llvm::ConstantInt::get(llvm::Type::getInt64Ty(llvmContext), numTIPArgs),
+        llvm::ConstantInt::get(llvm::Type::getInt64Ty(ctx.llvmContext),
+                               ctx.numTIPArgs),
         "_tip_num_inputs");
 
     // create global _tip_input_array with up to numTIPArgs of Int64
-    auto *inputArrayType =
-        llvm::ArrayType::get(llvm::Type::getInt64Ty(llvmContext), numTIPArgs);
-    std::vector<llvm::Constant *> zeros(numTIPArgs, zeroV);
-    tipInputArray = new llvm::GlobalVariable(
-        *CurrentModule, inputArrayType, false, llvm::GlobalValue::CommonLinkage,
+    auto *inputArrayType = llvm::ArrayType::get(
+        llvm::Type::getInt64Ty(ctx.llvmContext), ctx.numTIPArgs);
+    std::vector<llvm::Constant *> zeros(ctx.numTIPArgs, ctx.zeroV);
+    ctx.tipInputArray = new llvm::GlobalVariable(
+        *ctx.CurrentModule, inputArrayType, false,
+        llvm::GlobalValue::CommonLinkage,
         llvm::ConstantArray::get(inputArrayType, zeros), "_tip_input_array");
   }
 
-  // declare the calloc function
-  // the calloc function takes in two ints: the number of items and the size of
-  // the items
-  std::vector<llvm::Type *> twoInt(2, llvm::Type::getInt64Ty(llvmContext));
-  auto *FT = llvm::FunctionType::get(llvm::PointerType::get(llvmContext, 0),
-                                     twoInt, false);
-  callocFun = llvm::Function::Create(FT, llvm::Function::ExternalLinkage,
-                                     "calloc", CurrentModule.get());
-  callocFun->addFnAttr(llvm::Attribute::NoUnwind);
-
-  callocFun->setAttributes(callocFun->getAttributes().addAttributeAtIndex(
-      callocFun->getContext(), 0, llvm::Attribute::NoAlias));
-
-  /* We create a single unified record structure that is capable of representing
-   * all records in a TIP program.  While wasteful of memory, this approach is
-   * compatible with the limited type checking provided for records in TIP.
-   *
-   * We refer to this single unified record structure as the "global record"
-   */
-  std::vector<llvm::Type *> member_values;
   int index = 0;
   for (const auto &field : semanticAnalysis->getSymbolTable()->getFields())
   {
-    member_values.push_back(llvm::IntegerType::getInt64Ty((llvmContext)));
-    fieldVector.push_back(field);
-    fieldIndex[field] = index;
+    ctx.fieldVector.push_back(field);
+    ctx.fieldIndex[field] = index;
     index++;
   }
-  globalRecordType =
-      llvm::StructType::create(llvmContext, member_values, "globalRecord");
-  pointerToGlobalRecordType = llvm::PointerType::get(llvmContext, 0);
+  declareRuntime(ctx);
 
   // array type
-  llvm::StructType *globalArrayType = llvm::StructType::create(llvmContext, "GlobalArrayType");
+  llvm::StructType *globalArrayType = llvm::StructType::create(ctx.llvmContext, "GlobalArrayType");
   globalArrayType->setBody(
-      {llvm::Type::getInt64PtrTy(llvmContext), // Pointer to array data
-       llvm::Type::getInt64Ty(llvmContext)});  // Size of the array
+      {llvm::Type::getInt64PtrTy(ctx.llvmContext), // Pointer to array data
+       llvm::Type::getInt64Ty(ctx.llvmContext)});  // Size of the array
+
+  // Code is generated into modules of their own by the other routines
+  auto functions = getFunctions();
+  auto triple = ctx.CurrentModule->getTargetTriple();
+
+  /*
+   * With a function cache, the code of functions whose fingerprint has not
+   * changed is read from the cache.  Functions built without source have no
+   * fingerprint and are always generated.
+   */
+  std::vector<std::string> fingerprints(functions.size());
+  if (!ctx.functionCache.empty())
+  {
+    std::stringstream layout;
+    layout << triple;
+    for (auto const &fn : functions)
+    {
+      layout << " " << fn->getName() << "/"
+             << ctx.functionFormalNames[fn->getName()].size();
+    }
+    for (auto const &field : ctx.fieldVector)
+    {
+      layout << " ." << field;
+    }
+    for (std::size_t i = 0; i < functions.size(); i++)
+    {
+      if (!functions[i]->getSourceHash().empty())
+      {
+        fingerprints[i] =
+            fingerprint(semanticAnalysis, layout.str(), functions[i]);
+      }
+    }
+  }
+  CompileCache cache(ctx.functionCache);
 
-  // Code is generated into the module by the other routines
-  for (auto const &fn : getFunctions())
+  std::vector<llvm::SmallVector<char, 0>> bitcode(functions.size());
+  Parallel::forEach(
+      jobs, functions.size(),
+      [&](std::size_t i)
+      {
+        std::string cached;
+        if (!fingerprints[i].empty() && cache.load(fingerprints[i], cached))
+        {
+          LOG_S(1) << "Using cached code for function "
+                   << functions[i]->getName();
+          bitcode[i].assign(cached.begin(), cached.end());
+          return;
+        }
+        bitcode[i] = generateFunction(ctx, triple, functions[i]);
+        if (!fingerprints[i].empty())
+        {
+          cache.save(fingerprints[i],
+                     std::string_view(bitcode[i].data(), bitcode[i].size()));
+        }
+      });
+
+  llvm::Linker linker(*ctx.CurrentModule);
+  for (std::size_t i = 0; i < functions.size(); i++)
+  {
+    auto module = llvm::parseBitcodeFile(
+        llvm::MemoryBufferRef(
+            llvm::StringRef(bitcode[i].data(), bitcode[i].size()),
+            functions[i]->getName()),
+        ctx.llvmContext);
+    if (!module)
+    {
+      throw InternalError(                                 // LCOV_EXCL_LINE
+          "failed to read the bitcode for the function " + // LCOV_EXCL_LINE
+          functions[i]->getName() + ": " +                 // LCOV_EXCL_LINE
+          llvm::toString(module.takeError()));             // LCOV_EXCL_LINE
+    }
+    if (linker.linkInModule(std::move(*module)))
+    {
+      throw InternalError(                 // LCOV_EXCL_LINE
+          "failed to link the function " + // LCOV_EXCL_LINE
+          functions[i]->getName());        // LCOV_EXCL_LINE
+    }
+  }
+
+  // Only main is called from outside of the program
+  for (auto const &fn : functions)
   {
-    fn->codegen();
+    if (fn->getName() != "main")
+    {
+      ctx.CurrentModule->getFunction(fn->getName())
+          ->setLinkage(llvm::GlobalValue::InternalLinkage);
+    }
   }
+  ctx.tipFunctionTable = ctx.CurrentModule->getNamedGlobal("_tip_ftable");
+  ctx.tipFunctionTable->setLinkage(llvm::GlobalValue::InternalLinkage);
 
-  TheModule = std::move(CurrentModule);
+  TheModule = std::move(ctx.CurrentModule);
 
   verifyModule(*TheModule);
 
   return TheModule;
 }
 
-llvm::Value *ASTFunction::codegen()
+llvm::Value *ASTFunction::codegen(CodeGenContext &ctx)
 {
   LOG_S(1) << "Generating code for " << *this;
 
-  llvm::Function *TheFunction = getFunction(getName());
+  llvm::Function *TheFunction = getFunction(ctx, getName());
   if (TheFunction == nullptr)
   {
     throw InternalError("failed to declare the function" + // LCOV_EXCL_LINE
@@ -370,11 +513,11 @@ llvm::Value *ASTFunction::codegen()
 
   // create basic block to hold body of function definition
   llvm::BasicBlock *BB =
-      llvm::BasicBlock::Create(llvmContext, "entry", TheFunction);
-  irBuilder.SetInsertPoint(BB);
+      llvm::BasicBlock::Create(ctx.llvmContext, "entry", TheFunction);
+  ctx.irBuilder.SetInsertPoint(BB);
 
   // keep scope separate from prior definitions
-  namedValues.clear();
+  ctx.namedValues.clear();
 
   /*
    * Add arguments to the symbol table
@@ -386,28 +529,29 @@ llvm::Value *ASTFunction::codegen()
     int argIdx = 0;
     // Note that the args are not in the LLVM function decl, so we use the AST
     // formals
-    for (auto &argName : functionFormalNames[getName()])
+    for (auto &argName : ctx.functionFormalNames.at(getName()))
     {
       // Create an alloca for this argument and store its value
       llvm::AllocaInst *argAlloc = CreateEntryBlockAlloca(TheFunction, argName);
 
       // Emit the GEP instruction to index into input array
       std::vector<llvm::Value *> indices;
-      indices.push_back(zeroV);
-      indices.push_back(
-          llvm::ConstantInt::get(llvm::Type::getInt64Ty(llvmContext), argIdx));
-      auto *gep = irBuilder.CreateInBoundsGEP(
-          tipInputArray->getValueType(), tipInputArray, indices, "inputidx");
+      indices.push_back(ctx.zeroV);
+      indices.push_back(llvm::ConstantInt::get(
+          llvm::Type::getInt64Ty(ctx.llvmContext), argIdx));
+      auto *gep = ctx.irBuilder.CreateInBoundsGEP(
+          ctx.tipInputArray->getValueType(), ctx.tipInputArray, indices,
+          "inputidx");
 
       // Load the value and store it into the arg's alloca
       auto *inVal =
-          irBuilder.CreateLoad(llvm::Type::getInt64Ty(llvmContext), gep,
-                               "tipinput" + std::to_string(argIdx++));
+          ctx.irBuilder.CreateLoad(llvm::Type::getInt64Ty(ctx.llvmContext), gep,
+                                   "tipinput" + std::to_string(argIdx++));
 
-      irBuilder.CreateStore(inVal, argAlloc);
+      ctx.irBuilder.CreateStore(inVal, argAlloc);
 
       // Record name binding to alloca
-      namedValues[argName] = argAlloc;
+      ctx.namedValues[argName] = argAlloc;
     }
   }
   else
@@ -417,17 +561,17 @@ llvm::Value *ASTFunction::codegen()
       // Create an alloca for this argument and store its value
       llvm::AllocaInst *argAlloc =
           CreateEntryBlockAlloca(TheFunction, arg.getName().str());
-      irBuilder.CreateStore(&arg, argAlloc);
+      ctx.irBuilder.CreateStore(&arg, argAlloc);
 
       // Record name binding to alloca
-      namedValues[arg.getName().str()] = argAlloc;
+      ctx.namedValues[arg.getName().str()] = argAlloc;
     }
   }
 
   // add local declarations to the symbol table
   for (auto const &decl : getDeclarations())
   {
-    if (decl->codegen() == nullptr)
+    if (decl->codegen(ctx) == nullptr)
     {
       TheFunction->eraseFromParent();                    // LCOV_EXCL_LINE
       throw InternalError(                               // LCOV_EXCL_LINE
@@ -438,7 +582,7 @@ llvm::Value *ASTFunction::codegen()
 
   for (auto &stmt : getStmts())
   {
-    if (stmt->codegen() == nullptr)
+    if (stmt->codegen(ctx) == nullptr)
     {
       TheFunction->eraseFromParent();                    // LCOV_EXCL_LINE
       throw InternalError(                               // LCOV_EXCL_LINE
@@ -451,28 +595,28 @@ llvm::Value *ASTFunction::codegen()
   return TheFunction;
 } // LCOV_EXCL_LINE
 
-llvm::Value *ASTNumberExpr::codegen()
+llvm::Value *ASTNumberExpr::codegen(CodeGenContext &ctx)
 {
   LOG_S(1) << "Generating code for " << *this;
 
-  return llvm::ConstantInt::get(llvm::Type::getInt64Ty(llvmContext),
+  return llvm::ConstantInt::get(llvm::Type::getInt64Ty(ctx.llvmContext),
                                 getValue());
 } // LCOV_EXCL_LINE
 
-llvm::Value *ASTBooleanExpr::codegen()
+llvm::Value *ASTBooleanExpr::codegen(CodeGenContext &ctx)
 {
   LOG_S(1) << "Generating code for " << *this;
 
-  return llvm::ConstantInt::get(llvm::Type::getInt64Ty(llvmContext),
+  return llvm::ConstantInt::get(llvm::Type::getInt64Ty(ctx.llvmContext),
                                 getValue());
 } // LCOV_EXCL_LINE
 
-llvm::Value *ASTBinaryExpr::codegen()
+llvm::Value *ASTBinaryExpr::codegen(CodeGenContext &ctx)
 {
   LOG_S(1) << "Generating code for " << *this;
 
-  llvm::Value *L = getLeft()->codegen();
-  llvm::Value *R = getRight()->codegen();
+  llvm::Value *L = getLeft()->codegen(ctx);
+  llvm::Value *R = getRight()->codegen(ctx);
   if (L == nullptr || R == nullptr)
   {
     throw InternalError("null binary operand");
@@ -480,71 +624,75 @@ llvm::Value *ASTBinaryExpr::codegen()
 
   if (getOp() == "+")
   {
-    return irBuilder.CreateAdd(L, R, "addtmp");
+    return ctx.irBuilder.CreateAdd(L, R, "addtmp");
   }
   else if (getOp() == "-")
   {
-    return irBuilder.CreateSub(L, R, "subtmp");
+    return ctx.irBuilder.CreateSub(L, R, "subtmp");
   }
   else if (getOp() == "*")
   {
-    return irBuilder.CreateMul(L, R, "multmp");
+    return ctx.irBuilder.CreateMul(L, R, "multmp");
   }
   else if (getOp() == "/")
   {
-    return irBuilder.CreateSDiv(L, R, "divtmp");
+    return ctx.irBuilder.CreateSDiv(L, R, "divtmp");
   }
   else if (getOp() == "%")
   {
-    return irBuilder.CreateURem(L, R, "modmp");
+    return ctx.irBuilder.CreateURem(L, R, "modmp");
   }
   else if (getOp() == ">")
   {
-    auto *cmp = irBuilder.CreateICmpSGT(L, R, "_gttmp");
-    return irBuilder.CreateIntCast(
-        cmp, llvm::IntegerType::getInt64Ty(llvmContext), false, "gttmp");
+    auto *cmp = ctx.irBuilder.CreateICmpSGT(L, R, "_gttmp");
+    return ctx.irBuilder.CreateIntCast(
+        cmp, llvm::IntegerType::getInt64Ty(ctx.llvmContext), false, "gttmp");
   }
   else if (getOp() == ">=")
   {
-    auto *cmp = irBuilder.CreateICmpSGE(L, R, "_gettmp");
-    return irBuilder.CreateIntCast(
-        cmp, llvm::IntegerType::getInt64Ty(llvmContext), false, "gettmp");
+    auto *cmp = ctx.irBuilder.CreateICmpSGE(L, R, "_gettmp");
+    return ctx.irBuilder.CreateIntCast(
+        cmp, llvm::IntegerType::getInt64Ty(ctx.llvmContext), false, "gettmp");
   }
   else if (getOp() == "<")
   {
-    auto *cmp = irBuilder.CreateICmpSLT(L, R, "_lttmp");
-    return irBuilder.CreateIntCast(
-        cmp, llvm::IntegerType::getInt64Ty(llvmContext), false, "lttmp");
+    auto *cmp = ctx.irBuilder.CreateICmpSLT(L, R, "_lttmp");
+    return ctx.irBuilder.CreateIntCast(
+        cmp, llvm::IntegerType::getInt64Ty(ctx.llvmContext), false, "lttmp");
   }
   else if (getOp() == "<=")
   {
-    auto *cmp = irBuilder.CreateICmpSLE(L, R, "_lettmp");
-    return irBuilder.CreateIntCast(
-        cmp, llvm::IntegerType::getInt64Ty(llvmContext), false, "lettmp");
+    auto *cmp = ctx.irBuilder.CreateICmpSLE(L, R, "_lettmp");
+    return ctx.irBuilder.CreateIntCast(
+        cmp, llvm::IntegerType::getInt64Ty(ctx.llvmContext), false, "lettmp");
   }
   else if (getOp() == "==")
   {
-    auto *cmp = irBuilder.CreateICmpEQ(L, R, "_eqtmp");
-    return irBuilder.CreateIntCast(
-        cmp, llvm::IntegerType::getInt64Ty(llvmContext), false, "eqtmp");
+    auto *cmp = ctx.irBuilder.CreateICmpEQ(L, R, "_eqtmp");
+    return ctx.irBuilder.CreateIntCast(
+        cmp, llvm::IntegerType::getInt64Ty(ctx.llvmContext), false, "eqtmp");
   }
   else if (getOp() == "!=")
   {
-    auto *cmp = irBuilder.CreateICmpNE(L, R, "_neqtmp");
-    return irBuilder.CreateIntCast(
-        cmp, llvm::IntegerType::getInt64Ty(llvmContext), false, "neqtmp");
+    auto *cmp = ctx.irBuilder.CreateICmpNE(L, R, "_neqtmp");
+    return ctx.irBuilder.CreateIntCast(
+        cmp, llvm::IntegerType::getInt64Ty(ctx.llvmContext), false, "neqtmp");
   }
   else if (getOp() == "&")
   {
-    L = irBuilder.CreateICmpNE(L, zeroV, "and.lhs");
-    R = irBuilder.CreateICmpNE(R, zeroV, "and.rhs");
-    return irBuilder.CreateAnd(L, R, "andtmp");
+    L = ctx.irBuilder.CreateICmpNE(L, ctx.zeroV, "and.lhs");
+    R = ctx.irBuilder.CreateICmpNE(R, ctx.zeroV, "and.rhs");
+    auto *andV = ctx.irBuilder.CreateAnd(L, R, "_andtmp");
+    return ctx.irBuilder.CreateIntCast(
+        andV, llvm::IntegerType::getInt64Ty(ctx.llvmContext), false, "andtmp");
   }
   else if (getOp() == "|")
   {
-    L = irBuilder.CreateICmpNE(L, zeroV, "or.lhs");
-    R = irBuilder.CreateICmpNE(R, zeroV, "or.rhs");
-    return irBuilder.CreateOr(L, R, "ortmp");
+    L = ctx.irBuilder.CreateICmpNE(L, ctx.zeroV, "or.lhs");
+    R = ctx.irBuilder.CreateICmpNE(R, ctx.zeroV, "or.rhs");
+    auto *orV = ctx.irBuilder.CreateOr(L, R, "_ortmp");
+    return ctx.irBuilder.CreateIntCast(
+        orV, llvm::IntegerType::getInt64Ty(ctx.llvmContext), false, "ortmp");
   }
 
   else
@@ -553,11 +701,11 @@ llvm::Value *ASTBinaryExpr::codegen()
   }
 }
 
-llvm::Value *ASTUnaryExpr::codegen()
+llvm::Value *ASTUnaryExpr::codegen(CodeGenContext &ctx)
 {
   LOG_S(1) << "Generating code for " << *this;
 
-  llvm::Value *operand = getExpr()->codegen();
+  llvm::Value *operand = getExpr()->codegen(ctx);
   if (operand == nullptr)
   {
     throw InternalError("null unary operand");
@@ -567,37 +715,37 @@ llvm::Value *ASTUnaryExpr::codegen()
   if (getOp() == "!")
   {
     // Logical NOT: Check if the operand is non-zero and negate it
-    operand = irBuilder.CreateICmpEQ(operand, llvm::ConstantInt::get(operand->getType(), 0), "nottmp");
-    return irBuilder.CreateIntCast(operand, llvm::IntegerType::getInt64Ty(llvmContext), false, "notcasttmp");
+    operand = ctx.irBuilder.CreateICmpEQ(operand, llvm::ConstantInt::get(operand->getType(), 0), "nottmp");
+    return ctx.irBuilder.CreateIntCast(operand, llvm::IntegerType::getInt64Ty(ctx.llvmContext), false, "notcasttmp");
   }
   else if (getOp() == "-")
   {
     // Arithmetic negation
-    return irBuilder.CreateNeg(operand, "negtmp");
+    return ctx.irBuilder.CreateNeg(operand, "negtmp");
   }
   else if (getOp() == "++")
   {
     // Increment: Add 1 to the operand
     llvm::Value *one = llvm::ConstantInt::get(operand->getType(), 1);
-    return irBuilder.CreateAdd(operand, one, "incmp");
+    return ctx.irBuilder.CreateAdd(operand, one, "incmp");
   }
   else if (getOp() == "--")
   {
     // Decrement: Subtract 1 from the operand
     llvm::Value *one = llvm::ConstantInt::get(operand->getType(), 1);
-    return irBuilder.CreateSub(operand, one, "decmp");
+    return ctx.irBuilder.CreateSub(operand, one, "decmp");
   }
   else if (getOp() == "#")
   {
-    llvm::Type *elementType = llvm::Type::getInt64Ty(llvmContext);
+    llvm::Type *elementType = llvm::Type::getInt64Ty(ctx.llvmContext);
 
     llvm::StructType *arrayStructType = llvm::StructType::get(
-        llvmContext, {llvm::Type::getInt64Ty(llvmContext), elementType->getPointerTo()});
+        ctx.llvmContext, {llvm::Type::getInt64Ty(ctx.llvmContext), elementType->getPointerTo()});
 
-    auto *arrayStructPtr = irBuilder.CreateIntToPtr(operand, arrayStructType->getPointerTo(), "arrayPtrCast");
+    auto *arrayStructPtr = ctx.irBuilder.CreateIntToPtr(operand, arrayStructType->getPointerTo(), "arrayPtrCast");
 
-    llvm::Value *sizePtr = irBuilder.CreateStructGEP(arrayStructType, arrayStructPtr, 0, "sizePtr");
-    llvm::Value *arraySize = irBuilder.CreateLoad(llvm::Type::getInt64Ty(llvmContext), sizePtr, "arraySize");
+    llvm::Value *sizePtr = ctx.irBuilder.CreateStructGEP(arrayStructType, arrayStructPtr, 0, "sizePtr");
+    llvm::Value *arraySize = ctx.irBuilder.CreateLoad(llvm::Type::getInt64Ty(ctx.llvmContext), sizePtr, "arraySize");
     return arraySize;
   }
   else
@@ -613,46 +761,66 @@ llvm::Value *ASTUnaryExpr::codegen()
  * This relies on the fact that TIP programs have been checked to
  * ensure that names obey the scope rules.
  */
-llvm::Value *ASTVariableExpr::codegen()
+llvm::Value *ASTVariableExpr::codegen(CodeGenContext &ctx)
 {
   LOG_S(1) << "Generating code for " << *this;
 
-  auto nv = namedValues.find(getName());
-  if (nv != namedValues.end())
+  auto nv = ctx.namedValues.find(getName());
+  if (nv != ctx.namedValues.end())
   {
-    if (lValueGen)
+    if (ctx.lValueGen)
     {
-      return namedValues[nv->first];
+      return ctx.namedValues[nv->first];
     }
     else
     {
-      return irBuilder.CreateLoad(nv->second->getAllocatedType(), nv->second,
-                                  getName().c_str());
+      return ctx.irBuilder.CreateLoad(nv->second->getAllocatedType(),
+                                      nv->second, getName().c_str());
     }
   }
 
-  auto fidx = functionIndex.find(getName());
-  if (fidx == functionIndex.end())
+  auto fidx = ctx.functionIndex.find(getName());
+  if (fidx == ctx.functionIndex.end())
   {
     throw InternalError("Unknown variable name: " + getName());
   }
 
-  return llvm::ConstantInt::get(llvm::Type::getInt64Ty(llvmContext),
+  return llvm::ConstantInt::get(llvm::Type::getInt64Ty(ctx.llvmContext),
                                 fidx->second);
 }
 
-llvm::Value *ASTInputExpr::codegen()
+llvm::Value *ASTInputExpr::codegen(CodeGenContext &ctx)
+{
+  LOG_S(1) << "Generating code for " << *this;
+
+  if (ctx.inputIntrinsic == nullptr)
+  {
+    auto *FT =
+        llvm::FunctionType::get(llvm::Type::getInt64Ty(ctx.llvmContext), false);
+    ctx.inputIntrinsic =
+        llvm::Function::Create(FT, llvm::Function::ExternalLinkage,
+                               "_tip_input", ctx.CurrentModule.get());
+  }
+  return ctx.irBuilder.CreateCall(ctx.inputIntrinsic);
+} // LCOV_EXCL_LINE
+
+/*
+ * The clock is read by the runtime library, which returns the nanoseconds
+ * elapsed on a monotonic clock since an arbitrary point in the past.
+ */
+llvm::Value *ASTClockExpr::codegen(CodeGenContext &ctx)
 {
   LOG_S(1) << "Generating code for " << *this;
 
-  if (inputIntrinsic == nullptr)
+  if (ctx.clockIntrinsic == nullptr)
   {
     auto *FT =
-        llvm::FunctionType::get(llvm::Type::getInt64Ty(llvmContext), false);
-    inputIntrinsic = llvm::Function::Create(FT, llvm::Function::ExternalLinkage,
-                                            "_tip_input", CurrentModule.get());
+        llvm::FunctionType::get(llvm::Type::getInt64Ty(ctx.llvmContext), false);
+    ctx.clockIntrinsic =
+        llvm::Function::Create(FT, llvm::Function::ExternalLinkage,
+                               "_tip_clock", ctx.CurrentModule.get());
   }
-  return irBuilder.CreateCall(inputIntrinsic);
+  return ctx.irBuilder.CreateCall(ctx.clockIntrinsic);
 } // LCOV_EXCL_LINE
 
 /*
@@ -665,7 +833,7 @@ llvm::Value *ASTInputExpr::codegen()
  * The function name values and table are set up in a shallow-pass over
  * functions performed during codegen for the Program.
  */
-llvm::Value *ASTFunAppExpr::codegen()
+llvm::Value *ASTFunAppExpr::codegen(CodeGenContext &ctx)
 {
   LOG_S(1) << "Generating code for " << *this;
 
@@ -673,7 +841,7 @@ llvm::Value *ASTFunAppExpr::codegen()
    * Evaluate the function expression - it will resolve to an integer value
    * whether it is a function literal or an expression.
    */
-  auto *funVal = getFunction()->codegen();
+  auto *funVal = getFunction()->codegen(ctx);
   if (funVal == nullptr)
   {
     throw InternalError("failed to generate bitcode for the function");
@@ -684,30 +852,31 @@ llvm::Value *ASTFunAppExpr::codegen()
    * pointer to be called.
    */
   std::vector<llvm::Value *> indices;
-  indices.push_back(zeroV);
+  indices.push_back(ctx.zeroV);
   indices.push_back(funVal);
 
-  auto *gep = irBuilder.CreateInBoundsGEP(
-      tipFunctionTable->getValueType(), tipFunctionTable, indices, "ftableidx");
+  auto *gep = ctx.irBuilder.CreateInBoundsGEP(
+      ctx.tipFunctionTable->getValueType(), ctx.tipFunctionTable, indices,
+      "ftableidx");
 
   // Load the function pointer
-  auto *functionPointer = irBuilder.CreateLoad(
-      llvm::PointerType::get(llvmContext, 0), gep, "genfptr");
+  auto *functionPointer = ctx.irBuilder.CreateLoad(
+      llvm::PointerType::get(ctx.llvmContext, 0), gep, "genfptr");
 
   /*
    * All functions are pointer types and return INT64.
    *
    */
-  std::vector<llvm::Type *> actualTypes(getActuals().size(),
-                                        llvm::Type::getInt64Ty(llvmContext));
-  auto *funType = llvm::FunctionType::get(llvm::Type::getInt64Ty(llvmContext),
-                                          actualTypes, false);
+  std::vector<llvm::Type *> actualTypes(
+      getActuals().size(), llvm::Type::getInt64Ty(ctx.llvmContext));
+  auto *funType = llvm::FunctionType::get(
+      llvm::Type::getInt64Ty(ctx.llvmContext), actualTypes, false);
 
   // Compute the actual parameters
   std::vector<llvm::Value *> argsV;
   for (auto const &arg : getActuals())
   {
-    llvm::Value *argVal = arg->codegen();
+    llvm::Value *argVal = arg->codegen(ctx);
     if (argVal == nullptr)
     {
       throw InternalError(                                // LCOV_EXCL_LINE
@@ -716,19 +885,19 @@ llvm::Value *ASTFunAppExpr::codegen()
     argsV.push_back(argVal);
   }
 
-  return irBuilder.CreateCall(funType, functionPointer, argsV, "calltmp");
+  return ctx.irBuilder.CreateCall(funType, functionPointer, argsV, "calltmp");
 }
 
 /* 'alloc' Allocate expression
  * Generates a pointer to the allocs arguments (ints, records, ...)
  */
-llvm::Value *ASTAllocExpr::codegen()
+llvm::Value *ASTAllocExpr::codegen(CodeGenContext &ctx)
 {
   LOG_S(1) << "Generating code for " << *this;
 
-  allocFlag = true;
-  llvm::Value *argVal = getInitializer()->codegen();
-  allocFlag = false;
+  ctx.allocFlag = true;
+  llvm::Value *argVal = getInitializer()->codegen(ctx);
+  ctx.allocFlag = false;
   if (argVal == nullptr)
   {
     throw InternalError("failed to generate bitcode for the initializer of the "
@@ -738,24 +907,24 @@ llvm::Value *ASTAllocExpr::codegen()
   // Allocate an int pointer with calloc
   std::vector<llvm::Value *> twoArg;
   twoArg.push_back(
-      llvm::ConstantInt::get(llvm::Type::getInt64Ty(llvmContext), 1));
+      llvm::ConstantInt::get(llvm::Type::getInt64Ty(ctx.llvmContext), 1));
   twoArg.push_back(
-      llvm::ConstantInt::get(llvm::Type::getInt64Ty(llvmContext), 8));
-  auto *allocInst = irBuilder.CreateCall(callocFun, twoArg, "allocPtr");
+      llvm::ConstantInt::get(llvm::Type::getInt64Ty(ctx.llvmContext), 8));
+  auto *allocInst = ctx.irBuilder.CreateCall(ctx.callocFun, twoArg, "allocPtr");
 
   // Initialize with argument
-  irBuilder.CreateStore(argVal, allocInst);
+  ctx.irBuilder.CreateStore(argVal, allocInst);
 
-  return irBuilder.CreatePtrToInt(
-      allocInst, llvm::Type::getInt64Ty(llvmContext), "allocIntVal");
+  return ctx.irBuilder.CreatePtrToInt(
+      allocInst, llvm::Type::getInt64Ty(ctx.llvmContext), "allocIntVal");
 }
 
-llvm::Value *ASTNullExpr::codegen()
+llvm::Value *ASTNullExpr::codegen(CodeGenContext &ctx)
 {
-  auto *nullPtr =
-      llvm::ConstantPointerNull::get(llvm::PointerType::get(llvmContext, 0));
-  return irBuilder.CreatePtrToInt(nullPtr, llvm::Type::getInt64Ty(llvmContext),
-                                  "nullPtrIntVal");
+  auto *nullPtr = llvm::ConstantPointerNull::get(
+      llvm::PointerType::get(ctx.llvmContext, 0));
+  return ctx.irBuilder.CreatePtrToInt(
+      nullPtr, llvm::Type::getInt64Ty(ctx.llvmContext), "nullPtrIntVal");
 }
 
 /* '&' address of expression
@@ -764,21 +933,21 @@ llvm::Value *ASTNullExpr::codegen()
  * This is checked in the weeding pass.
  *
  */
-llvm::Value *ASTRefExpr::codegen()
+llvm::Value *ASTRefExpr::codegen(CodeGenContext &ctx)
 {
   LOG_S(1) << "Generating code for " << *this;
 
-  lValueGen = true;
-  llvm::Value *lValue = getVar()->codegen();
-  lValueGen = false;
+  ctx.lValueGen = true;
+  llvm::Value *lValue = getVar()->codegen(ctx);
+  ctx.lValueGen = false;
 
   if (lValue == nullptr)
   {
     throw InternalError("could not generate l-value for address of");
   }
 
-  return irBuilder.CreatePtrToInt(lValue, llvm::Type::getInt64Ty(llvmContext),
-                                  "addrOfPtr");
+  return ctx.irBuilder.CreatePtrToInt(
+      lValue, llvm::Type::getInt64Ty(ctx.llvmContext), "addrOfPtr");
 } // LCOV_EXCL_LINE
 
 /* '*' dereference expression
@@ -788,27 +957,27 @@ llvm::Value *ASTRefExpr::codegen()
  * Consequently, we convert the value with "inttoptr" before loading
  * the value at the pointed-to memory location.
  */
-llvm::Value *ASTDeRefExpr::codegen()
+llvm::Value *ASTDeRefExpr::codegen(CodeGenContext &ctx)
 {
   LOG_S(1) << "Generating code for " << *this;
 
-  bool isLValue = lValueGen;
+  bool isLValue = ctx.lValueGen;
 
   if (isLValue)
   {
     // This flag is reset here so that sub-expressions are treated as r-values
-    lValueGen = false;
+    ctx.lValueGen = false;
   }
 
-  llvm::Value *argVal = getPtr()->codegen();
+  llvm::Value *argVal = getPtr()->codegen(ctx);
   if (argVal == nullptr)
   {
     throw InternalError("failed to generate bitcode for the pointer");
   }
 
   // compute the address
-  llvm::Value *address = irBuilder.CreateIntToPtr(
-      argVal, llvm::PointerType::get(llvmContext, 0), "ptrIntVal");
+  llvm::Value *address = ctx.irBuilder.CreateIntToPtr(
+      argVal, llvm::PointerType::get(ctx.llvmContext, 0), "ptrIntVal");
 
   if (isLValue)
   {
@@ -818,8 +987,8 @@ llvm::Value *ASTDeRefExpr::codegen()
   else
   {
     // For an r-value, return the value at the address
-    return irBuilder.CreateLoad(llvm::Type::getInt64Ty(llvmContext), address,
-                                "valueAt");
+    return ctx.irBuilder.CreateLoad(llvm::Type::getInt64Ty(ctx.llvmContext),
+                                    address, "valueAt");
   }
 }
 
@@ -827,71 +996,73 @@ llvm::Value *ASTDeRefExpr::codegen()
  *
  * Builds an instance of the GlobalRecord using the declared fields
  */
-llvm::Value *ASTRecordExpr::codegen()
+llvm::Value *ASTRecordExpr::codegen(CodeGenContext &ctx)
 {
   LOG_S(1) << "Generating code for " << *this;
 
   // If this is an alloc, we calloc the record
-  if (allocFlag)
+  if (ctx.allocFlag)
   {
     // Allocate a pointer to an global record
-    auto *allocaRecord = irBuilder.CreateAlloca(pointerToGlobalRecordType);
+    auto *allocaRecord =
+        ctx.irBuilder.CreateAlloca(ctx.pointerToGlobalRecordType);
 
     // Use irBuilder to create the calloc call using pre-defined callocFun
-    auto sizeOfGlobalRecord = CurrentModule->getDataLayout()
-                                  .getStructLayout(globalRecordType)
+    auto sizeOfGlobalRecord = ctx.CurrentModule->getDataLayout()
+                                  .getStructLayout(ctx.globalRecordType)
                                   ->getSizeInBytes();
     std::vector<llvm::Value *> callocArgs;
-    callocArgs.push_back(oneV);
+    callocArgs.push_back(ctx.oneV);
     callocArgs.push_back(llvm::ConstantInt::get(
-        llvm::Type::getInt64Ty(llvmContext), sizeOfGlobalRecord));
-    auto *calloc = irBuilder.CreateCall(callocFun, callocArgs, "callocedPtr");
+        llvm::Type::getInt64Ty(ctx.llvmContext), sizeOfGlobalRecord));
+    auto *calloc =
+        ctx.irBuilder.CreateCall(ctx.callocFun, callocArgs, "callocedPtr");
 
     // Bitcast the calloc call to theStruct Type
     auto recordPtr = calloc;
 
     // Store the ptr to the record in the record alloc
-    irBuilder.CreateStore(recordPtr, allocaRecord);
+    ctx.irBuilder.CreateStore(recordPtr, allocaRecord);
 
     // Load allocaRecord
     auto loadInst =
-        irBuilder.CreateLoad(pointerToGlobalRecordType, allocaRecord);
+        ctx.irBuilder.CreateLoad(ctx.pointerToGlobalRecordType, allocaRecord);
 
     // For each field, generate GEP for location of field in the globalRecord
     // Generate the code for the field and store it in the GEP
     for (auto const &field : getFields())
     {
-      auto *gep = irBuilder.CreateStructGEP(globalRecordType, loadInst,
-                                            fieldIndex[field->getField()],
-                                            field->getField());
-      auto value = field->codegen();
-      irBuilder.CreateStore(value, gep);
+      auto *gep = ctx.irBuilder.CreateStructGEP(
+          ctx.globalRecordType, loadInst, ctx.fieldIndex.at(field->getField()),
+          field->getField());
+      auto value = field->codegen(ctx);
+      ctx.irBuilder.CreateStore(value, gep);
     }
 
     // Return int64 pointer to the pointer to the record
-    return irBuilder.CreatePtrToInt(
-        recordPtr, llvm::Type::getInt64Ty(llvmContext), "recordPtr");
+    return ctx.irBuilder.CreatePtrToInt(
+        recordPtr, llvm::Type::getInt64Ty(ctx.llvmContext), "recordPtr");
   }
   else
   {
     // Allocate the space for a global record
-    auto *allocaRecord = irBuilder.CreateAlloca(globalRecordType);
+    auto *allocaRecord = ctx.irBuilder.CreateAlloca(ctx.globalRecordType);
 
     // Codegen the fields present in this record and store them in the
     // appropriate location We do not give a value to fields that are not
     // explictly set. Thus, accessing them is undefined behavior
     for (auto const &field : getFields())
     {
-      auto *gep = irBuilder.CreateStructGEP(
+      auto *gep = ctx.irBuilder.CreateStructGEP(
           allocaRecord->getAllocatedType(), allocaRecord,
-          fieldIndex[field->getField()], field->getField());
-      auto value = field->codegen();
-      irBuilder.CreateStore(value, gep);
+          ctx.fieldIndex.at(field->getField()), field->getField());
+      auto value = field->codegen(ctx);
+      ctx.irBuilder.CreateStore(value, gep);
     }
     // Return int64 pointer to the record since all variables are pointers to
     // ints
-    return irBuilder.CreatePtrToInt(
-        allocaRecord, llvm::Type::getInt64Ty(llvmContext), "record");
+    return ctx.irBuilder.CreatePtrToInt(
+        allocaRecord, llvm::Type::getInt64Ty(ctx.llvmContext), "record");
   }
 }
 
@@ -899,11 +1070,11 @@ llvm::Value *ASTRecordExpr::codegen()
  *
  * Expression for generating the code for the value of a field
  */
-llvm::Value *ASTFieldExpr::codegen()
+llvm::Value *ASTFieldExpr::codegen(CodeGenContext &ctx)
 {
   LOG_S(1) << "Generating code for " << *this;
 
-  return this->getInitializer()->codegen();
+  return this->getInitializer()->codegen(ctx);
 } // LCOV_EXCL_LINE
 
 /* record.field Access Expression
@@ -911,36 +1082,36 @@ llvm::Value *ASTFieldExpr::codegen()
  * In an l-value context this returns the location of the field being accessed
  * In an r-value context this returns the value of the field being accessed
  */
-llvm::Value *ASTAccessExpr::codegen()
+llvm::Value *ASTAccessExpr::codegen(CodeGenContext &ctx)
 {
   LOG_S(1) << "Generating code for " << *this;
 
-  bool isLValue = lValueGen;
+  bool isLValue = ctx.lValueGen;
 
   if (isLValue)
   {
     // This flag is reset here so that sub-expressions are treated as r-values
-    lValueGen = false;
+    ctx.lValueGen = false;
   }
 
   // Get current field and check if it exists
   auto currField = this->getField();
-  if (fieldIndex.count(currField) == 0)
+  if (ctx.fieldIndex.count(currField) == 0)
   {
     throw InternalError("This field doesn't exist");
   }
 
   // Generate record instruction address
-  llvm::Value *recordVal = this->getRecord()->codegen();
+  llvm::Value *recordVal = this->getRecord()->codegen(ctx);
   llvm::Value *recordAddress =
-      irBuilder.CreateIntToPtr(recordVal, pointerToGlobalRecordType);
+      ctx.irBuilder.CreateIntToPtr(recordVal, ctx.pointerToGlobalRecordType);
 
   // Generate the field index
-  auto index = fieldIndex[currField];
+  auto index = ctx.fieldIndex.at(currField);
 
   // Generate the location of the field
-  auto *gep = irBuilder.CreateStructGEP(globalRecordType, recordAddress, index,
-                                        currField);
+  auto *gep = ctx.irBuilder.CreateStructGEP(ctx.globalRecordType,
+                                            recordAddress, index, currField);
 
   // If LHS, return location of field
   if (isLValue)
@@ -949,56 +1120,56 @@ llvm::Value *ASTAccessExpr::codegen()
   }
 
   // Load value at GEP and return it
-  auto fieldLoad =
-      irBuilder.CreateLoad(llvm::IntegerType::getInt64Ty(llvmContext), gep);
-  return irBuilder.CreatePtrToInt(
-      fieldLoad, llvm::Type::getInt64Ty(llvmContext), "fieldAccess");
+  auto fieldLoad = ctx.irBuilder.CreateLoad(
+      llvm::IntegerType::getInt64Ty(ctx.llvmContext), gep);
+  return ctx.irBuilder.CreatePtrToInt(
+      fieldLoad, llvm::Type::getInt64Ty(ctx.llvmContext), "fieldAccess");
 }
 
-llvm::Value *ASTArrayOfExpr::codegen()
+llvm::Value *ASTArrayOfExpr::codegen(CodeGenContext &ctx)
 {
   LOG_S(1) << "Generating code for " << *this;
 
-  llvm::Type *elementType = llvm::Type::getInt64Ty(llvmContext);
+  llvm::Type *elementType = llvm::Type::getInt64Ty(ctx.llvmContext);
 
   // Struct type for array: { i64, i64* }
   llvm::StructType *arrayStructType = llvm::StructType::create(
-      llvmContext, {llvm::Type::getInt64Ty(llvmContext), elementType->getPointerTo()}, "arrayStruct");
+      ctx.llvmContext, {llvm::Type::getInt64Ty(ctx.llvmContext), elementType->getPointerTo()}, "arrayStruct");
 
   // Allocate the struct
-  llvm::AllocaInst *arrayStructAlloca = irBuilder.CreateAlloca(arrayStructType, nullptr, "arrayStructTmp");
+  llvm::AllocaInst *arrayStructAlloca = ctx.irBuilder.CreateAlloca(arrayStructType, nullptr, "arrayStructTmp");
 
   // Evaluate the length expression
-  llvm::Value *arrayLength = LEN_EXPR->codegen();
+  llvm::Value *arrayLength = LEN_EXPR->codegen(ctx);
   if (!arrayLength)
   {
     LOG_S(1) << "Failed to generate code for array length";
     return nullptr;
   }
 
-  if (arrayLength->getType() != llvm::Type::getInt64Ty(llvmContext))
+  if (arrayLength->getType() != llvm::Type::getInt64Ty(ctx.llvmContext))
   {
-    arrayLength = irBuilder.CreateIntCast(arrayLength, llvm::Type::getInt64Ty(llvmContext), true, "lengthCast");
+    arrayLength = ctx.irBuilder.CreateIntCast(arrayLength, llvm::Type::getInt64Ty(ctx.llvmContext), true, "lengthCast");
   }
 
   // Set array size
-  llvm::Value *sizePtr = irBuilder.CreateStructGEP(arrayStructType, arrayStructAlloca, 0, "sizePtr");
-  irBuilder.CreateStore(arrayLength, sizePtr);
+  llvm::Value *sizePtr = ctx.irBuilder.CreateStructGEP(arrayStructType, arrayStructAlloca, 0, "sizePtr");
+  ctx.irBuilder.CreateStore(arrayLength, sizePtr);
 
   // Use calloc for array data allocation
-  llvm::DataLayout dataLayout(CurrentModule.get());
+  llvm::DataLayout dataLayout(ctx.CurrentModule.get());
   uint64_t elementSizeBytes = dataLayout.getTypeAllocSize(elementType);
-  llvm::Value *elementSize = llvm::ConstantInt::get(llvm::Type::getInt64Ty(llvmContext), elementSizeBytes);
+  llvm::Value *elementSize = llvm::ConstantInt::get(llvm::Type::getInt64Ty(ctx.llvmContext), elementSizeBytes);
 
   llvm::Value *callocArgs[] = {arrayLength, elementSize};
-  llvm::Value *callocResult = irBuilder.CreateCall(callocFun, callocArgs, "callocResult");
+  llvm::Value *callocResult = ctx.irBuilder.CreateCall(ctx.callocFun, callocArgs, "callocResult");
 
-  llvm::Value *dataPtr = irBuilder.CreateStructGEP(arrayStructType, arrayStructAlloca, 1, "dataPtr");
-  llvm::Value *dataPtrCast = irBuilder.CreateBitCast(callocResult, elementType->getPointerTo());
-  irBuilder.CreateStore(dataPtrCast, dataPtr);
+  llvm::Value *dataPtr = ctx.irBuilder.CreateStructGEP(arrayStructType, arrayStructAlloca, 1, "dataPtr");
+  llvm::Value *dataPtrCast = ctx.irBuilder.CreateBitCast(callocResult, elementType->getPointerTo());
+  ctx.irBuilder.CreateStore(dataPtrCast, dataPtr);
 
   // Generate code for the element expression
-  llvm::Value *elementValue = ELEMENT_EXPR->codegen();
+  llvm::Value *elementValue = ELEMENT_EXPR->codegen(ctx);
   if (!elementValue)
   {
     LOG_S(1) << "Failed to generate code for array element";
@@ -1006,121 +1177,121 @@ llvm::Value *ASTArrayOfExpr::codegen()
   }
 
   // Initialize array elements
-  llvm::Value *zero = llvm::ConstantInt::get(llvm::Type::getInt64Ty(llvmContext), 0);
-  llvm::Value *loopIndex = irBuilder.CreateAlloca(llvm::Type::getInt64Ty(llvmContext), nullptr, "loopIndex");
-  irBuilder.CreateStore(zero, loopIndex);
+  llvm::Value *zero = llvm::ConstantInt::get(llvm::Type::getInt64Ty(ctx.llvmContext), 0);
+  llvm::Value *loopIndex = ctx.irBuilder.CreateAlloca(llvm::Type::getInt64Ty(ctx.llvmContext), nullptr, "loopIndex");
+  ctx.irBuilder.CreateStore(zero, loopIndex);
 
-  llvm::Function *currentFunction = irBuilder.GetInsertBlock()->getParent();
-  llvm::BasicBlock *loopConditionBlock = llvm::BasicBlock::Create(llvmContext, "loopCondition", currentFunction);
-  llvm::BasicBlock *loopBodyBlock = llvm::BasicBlock::Create(llvmContext, "loopBody", currentFunction);
-  llvm::BasicBlock *loopEndBlock = llvm::BasicBlock::Create(llvmContext, "loopEnd", currentFunction);
+  llvm::Function *currentFunction = ctx.irBuilder.GetInsertBlock()->getParent();
+  llvm::BasicBlock *loopConditionBlock = llvm::BasicBlock::Create(ctx.llvmContext, "loopCondition", currentFunction);
+  llvm::BasicBlock *loopBodyBlock = llvm::BasicBlock::Create(ctx.llvmContext, "loopBody", currentFunction);
+  llvm::BasicBlock *loopEndBlock = llvm::BasicBlock::Create(ctx.llvmContext, "loopEnd", currentFunction);
 
   // Jump to loop condition
-  irBuilder.CreateBr(loopConditionBlock);
+  ctx.irBuilder.CreateBr(loopConditionBlock);
 
   // Loop condition
-  irBuilder.SetInsertPoint(loopConditionBlock);
-  llvm::Value *currentIndex = irBuilder.CreateLoad(llvm::Type::getInt64Ty(llvmContext), loopIndex, "currentIndex");
-  llvm::Value *loopCondition = irBuilder.CreateICmpSLT(currentIndex, arrayLength, "loopCondition");
-  irBuilder.CreateCondBr(loopCondition, loopBodyBlock, loopEndBlock);
+  ctx.irBuilder.SetInsertPoint(loopConditionBlock);
+  llvm::Value *currentIndex = ctx.irBuilder.CreateLoad(llvm::Type::getInt64Ty(ctx.llvmContext), loopIndex, "currentIndex");
+  llvm::Value *loopCondition = ctx.irBuilder.CreateICmpSLT(currentIndex, arrayLength, "loopCondition");
+  ctx.irBuilder.CreateCondBr(loopCondition, loopBodyBlock, loopEndBlock);
 
   // Loop body
-  irBuilder.SetInsertPoint(loopBodyBlock);
-  llvm::Value *elementPtr = irBuilder.CreateGEP(
+  ctx.irBuilder.SetInsertPoint(loopBodyBlock);
+  llvm::Value *elementPtr = ctx.irBuilder.CreateGEP(
       elementType, dataPtrCast, currentIndex, "elementPtr");
-  irBuilder.CreateStore(elementValue, elementPtr);
+  ctx.irBuilder.CreateStore(elementValue, elementPtr);
 
   // Increment loop index
-  llvm::Value *nextIndex = irBuilder.CreateAdd(currentIndex, llvm::ConstantInt::get(llvm::Type::getInt64Ty(llvmContext), 1), "nextIndex");
-  irBuilder.CreateStore(nextIndex, loopIndex);
+  llvm::Value *nextIndex = ctx.irBuilder.CreateAdd(currentIndex, llvm::ConstantInt::get(llvm::Type::getInt64Ty(ctx.llvmContext), 1), "nextIndex");
+  ctx.irBuilder.CreateStore(nextIndex, loopIndex);
 
   // Jump back to loop condition
-  irBuilder.CreateBr(loopConditionBlock);
+  ctx.irBuilder.CreateBr(loopConditionBlock);
 
   // Loop end
-  irBuilder.SetInsertPoint(loopEndBlock);
+  ctx.irBuilder.SetInsertPoint(loopEndBlock);
 
   return arrayStructAlloca; // Return pointer to struct
 }
 
-llvm::Value *ASTArrayExpr::codegen()
+llvm::Value *ASTArrayExpr::codegen(CodeGenContext &ctx)
 {
   LOG_S(1) << "Generating code for " << *this;
 
-  llvm::Type *elementType = llvm::Type::getInt64Ty(llvmContext);
+  llvm::Type *elementType = llvm::Type::getInt64Ty(ctx.llvmContext);
 
   // Struct type for array: { i64, i64* }
   llvm::StructType *arrayStructType = llvm::StructType::create(
-      llvmContext, {llvm::Type::getInt64Ty(llvmContext), elementType->getPointerTo()}, "arrayStruct");
+      ctx.llvmContext, {llvm::Type::getInt64Ty(ctx.llvmContext), elementType->getPointerTo()}, "arrayStruct");
 
   // Allocate the struct
-  llvm::AllocaInst *arrayStructAlloca = irBuilder.CreateAlloca(arrayStructType, nullptr, "arrayStructTmp");
+  llvm::AllocaInst *arrayStructAlloca = ctx.irBuilder.CreateAlloca(arrayStructType, nullptr, "arrayStructTmp");
 
   // Set array size
-  llvm::Value *arraySize = llvm::ConstantInt::get(llvm::Type::getInt64Ty(llvmContext), ITEMS.size());
-  llvm::Value *sizePtr = irBuilder.CreateStructGEP(arrayStructType, arrayStructAlloca, 0, "sizePtr");
-  irBuilder.CreateStore(arraySize, sizePtr);
+  llvm::Value *arraySize = llvm::ConstantInt::get(llvm::Type::getInt64Ty(ctx.llvmContext), ITEMS.size());
+  llvm::Value *sizePtr = ctx.irBuilder.CreateStructGEP(arrayStructType, arrayStructAlloca, 0, "sizePtr");
+  ctx.irBuilder.CreateStore(arraySize, sizePtr);
 
   // Use calloc for array data allocation
-  llvm::Value *numElements = llvm::ConstantInt::get(llvm::Type::getInt64Ty(llvmContext), ITEMS.size());
-  llvm::DataLayout dataLayout(CurrentModule.get());
+  llvm::Value *numElements = llvm::ConstantInt::get(llvm::Type::getInt64Ty(ctx.llvmContext), ITEMS.size());
+  llvm::DataLayout dataLayout(ctx.CurrentModule.get());
   uint64_t elementSizeBytes = dataLayout.getTypeAllocSize(elementType);
-  llvm::Value *elementSize = llvm::ConstantInt::get(llvm::Type::getInt64Ty(llvmContext), elementSizeBytes);
+  llvm::Value *elementSize = llvm::ConstantInt::get(llvm::Type::getInt64Ty(ctx.llvmContext), elementSizeBytes);
 
   llvm::Value *callocArgs[] = {numElements, elementSize};
 
-  llvm::Value *callocResult = irBuilder.CreateCall(callocFun, callocArgs, "callocResult");
+  llvm::Value *callocResult = ctx.irBuilder.CreateCall(ctx.callocFun, callocArgs, "callocResult");
 
-  llvm::Value *dataPtr = irBuilder.CreateStructGEP(arrayStructType, arrayStructAlloca, 1, "dataPtr");
-  llvm::Value *dataPtrCast = irBuilder.CreateBitCast(callocResult, elementType->getPointerTo());
-  irBuilder.CreateStore(dataPtrCast, dataPtr);
+  llvm::Value *dataPtr = ctx.irBuilder.CreateStructGEP(arrayStructType, arrayStructAlloca, 1, "dataPtr");
+  llvm::Value *dataPtrCast = ctx.irBuilder.CreateBitCast(callocResult, elementType->getPointerTo());
+  ctx.irBuilder.CreateStore(dataPtrCast, dataPtr);
 
   // Initialize array elements
   for (int i = 0; i < ITEMS.size(); ++i)
   {
-    llvm::Value *itemValue = ITEMS[i]->codegen();
+    llvm::Value *itemValue = ITEMS[i]->codegen(ctx);
     if (!itemValue)
     {
       LOG_S(1) << "Failed to generate code for array element";
       return nullptr;
     }
 
-    llvm::Value *elementPtr = irBuilder.CreateGEP(
-        elementType, dataPtrCast, llvm::ConstantInt::get(llvm::Type::getInt64Ty(llvmContext), i), "arrayElementPtr");
-    irBuilder.CreateStore(itemValue, elementPtr);
+    llvm::Value *elementPtr = ctx.irBuilder.CreateGEP(
+        elementType, dataPtrCast, llvm::ConstantInt::get(llvm::Type::getInt64Ty(ctx.llvmContext), i), "arrayElementPtr");
+    ctx.irBuilder.CreateStore(itemValue, elementPtr);
   }
 
   return arrayStructAlloca; // Return pointer to struct
 }
 
-llvm::Value *ASTArrayRefExpr::codegen()
+llvm::Value *ASTArrayRefExpr::codegen(CodeGenContext &ctx)
 {
   LOG_S(1) << "Generating code for array reference " << *this;
 
-  bool isLValue = lValueGen;
+  bool isLValue = ctx.lValueGen;
   if (isLValue)
   {
-    lValueGen = false;
+    ctx.lValueGen = false;
   }
 
-  llvm::Type *elementType = llvm::Type::getInt64Ty(llvmContext);
+  llvm::Type *elementType = llvm::Type::getInt64Ty(ctx.llvmContext);
 
   // Struct type for array: { i64, i64* }
   llvm::StructType *arrayStructType = llvm::StructType::get(
-      llvmContext, {llvm::Type::getInt64Ty(llvmContext), elementType->getPointerTo()});
+      ctx.llvmContext, {llvm::Type::getInt64Ty(ctx.llvmContext), elementType->getPointerTo()});
 
-  lValueGen = false;
-  llvm::Value *uncastedArrayStructPtr = ARRAY->codegen(); // Should be a pointer to the struct
-  auto *arrayStructAddress = irBuilder.CreateIntToPtr(uncastedArrayStructPtr, arrayStructType->getPointerTo(), "arrayPtrCast");
+  ctx.lValueGen = false;
+  llvm::Value *uncastedArrayStructPtr = ARRAY->codegen(ctx); // Should be a pointer to the struct
+  auto *arrayStructAddress = ctx.irBuilder.CreateIntToPtr(uncastedArrayStructPtr, arrayStructType->getPointerTo(), "arrayPtrCast");
 
   // Extract array size and data pointer
-  llvm::Value *sizePtr = irBuilder.CreateStructGEP(arrayStructType, arrayStructAddress, 0, "sizePtr");
-  llvm::Value *arraySize = irBuilder.CreateLoad(llvm::Type::getInt64Ty(llvmContext), sizePtr, "arraySize");
+  llvm::Value *sizePtr = ctx.irBuilder.CreateStructGEP(arrayStructType, arrayStructAddress, 0, "sizePtr");
+  llvm::Value *arraySize = ctx.irBuilder.CreateLoad(llvm::Type::getInt64Ty(ctx.llvmContext), sizePtr, "arraySize");
 
-  llvm::Value *arrayAddress = irBuilder.CreateStructGEP(arrayStructType, arrayStructAddress, 1, "dataPtr");
-  llvm::Value *arrayDataAddress = irBuilder.CreateLoad(elementType->getPointerTo(), arrayAddress, "arrayData");
+  llvm::Value *arrayAddress = ctx.irBuilder.CreateStructGEP(arrayStructType, arrayStructAddress, 1, "dataPtr");
+  llvm::Value *arrayDataAddress = ctx.irBuilder.CreateLoad(elementType->getPointerTo(), arrayAddress, "arrayData");
 
-  llvm::Value *indexVal = INDEX->codegen();
+  llvm::Value *indexVal = INDEX->codegen(ctx);
   if (!indexVal)
   {
     LOG_S(1) << "Failed to generate code for index expression";
@@ -1130,44 +1301,44 @@ llvm::Value *ASTArrayRefExpr::codegen()
   if (indexVal->getType()->isPointerTy())
   {
     std::cout << "Index type is pointer " << std::endl;
-    indexVal = irBuilder.CreateLoad(llvm::Type::getInt64Ty(llvmContext), indexVal, "indexLoad");
+    indexVal = ctx.irBuilder.CreateLoad(llvm::Type::getInt64Ty(ctx.llvmContext), indexVal, "indexLoad");
   }
 
-  if (indexVal->getType() != llvm::Type::getInt64Ty(llvmContext))
+  if (indexVal->getType() != llvm::Type::getInt64Ty(ctx.llvmContext))
   {
     std::cout << "Index type is not i64 " << std::endl;
-    indexVal = irBuilder.CreateIntCast(indexVal, llvm::Type::getInt64Ty(llvmContext), true, "indexCast");
+    indexVal = ctx.irBuilder.CreateIntCast(indexVal, llvm::Type::getInt64Ty(ctx.llvmContext), true, "indexCast");
   }
 
   // Bounds checking
-  llvm::Value *isInBounds = irBuilder.CreateAnd(
-      irBuilder.CreateICmpSGE(indexVal, llvm::ConstantInt::get(llvm::Type::getInt64Ty(llvmContext), 0)),
-      irBuilder.CreateICmpSLT(indexVal, arraySize),
+  llvm::Value *isInBounds = ctx.irBuilder.CreateAnd(
+      ctx.irBuilder.CreateICmpSGE(indexVal, llvm::ConstantInt::get(llvm::Type::getInt64Ty(ctx.llvmContext), 0)),
+      ctx.irBuilder.CreateICmpSLT(indexVal, arraySize),
       "isInBounds");
 
-  llvm::Function *currentFunction = irBuilder.GetInsertBlock()->getParent();
+  llvm::Function *currentFunction = ctx.irBuilder.GetInsertBlock()->getParent();
 
-  llvm::BasicBlock *inBoundsBlock = llvm::BasicBlock::Create(llvmContext, "inBounds", currentFunction);
-  llvm::BasicBlock *outOfBoundsBlock = llvm::BasicBlock::Create(llvmContext, "outOfBounds", currentFunction);
+  llvm::BasicBlock *inBoundsBlock = llvm::BasicBlock::Create(ctx.llvmContext, "inBounds", currentFunction);
+  llvm::BasicBlock *outOfBoundsBlock = llvm::BasicBlock::Create(ctx.llvmContext, "outOfBounds", currentFunction);
 
-  irBuilder.CreateCondBr(isInBounds, inBoundsBlock, outOfBoundsBlock);
+  ctx.irBuilder.CreateCondBr(isInBounds, inBoundsBlock, outOfBoundsBlock);
 
   // Out of bounds handling
-  irBuilder.SetInsertPoint(outOfBoundsBlock);
+  ctx.irBuilder.SetInsertPoint(outOfBoundsBlock);
 
-  if (errorIntrinsic == nullptr)
+  if (ctx.errorIntrinsic == nullptr)
   {
-    std::vector<llvm::Type *> oneInt(1, llvm::Type::getInt64Ty(llvmContext));
-    auto *FT = llvm::FunctionType::get(llvm::Type::getVoidTy(llvmContext), oneInt, false);
-    errorIntrinsic = llvm::Function::Create(FT, llvm::Function::ExternalLinkage, "_tip_error", CurrentModule.get());
+    std::vector<llvm::Type *> oneInt(1, llvm::Type::getInt64Ty(ctx.llvmContext));
+    auto *FT = llvm::FunctionType::get(llvm::Type::getVoidTy(ctx.llvmContext), oneInt, false);
+    ctx.errorIntrinsic = llvm::Function::Create(FT, llvm::Function::ExternalLinkage, "_tip_error", ctx.CurrentModule.get());
   }
-  llvm::Value *errorArg = llvm::ConstantInt::get(llvm::Type::getInt64Ty(llvmContext), 0);
-  irBuilder.CreateCall(errorIntrinsic, {errorArg});
-  irBuilder.CreateUnreachable();
+  llvm::Value *errorArg = llvm::ConstantInt::get(llvm::Type::getInt64Ty(ctx.llvmContext), 0);
+  ctx.irBuilder.CreateCall(ctx.errorIntrinsic, {errorArg});
+  ctx.irBuilder.CreateUnreachable();
 
   // In bounds handling
-  irBuilder.SetInsertPoint(inBoundsBlock);
-  llvm::Value *elementAddress = irBuilder.CreateGEP(
+  ctx.irBuilder.SetInsertPoint(inBoundsBlock);
+  llvm::Value *elementAddress = ctx.irBuilder.CreateGEP(
       elementType, arrayDataAddress, indexVal, "arrayElementPtr");
 
   if (isLValue)
@@ -1176,21 +1347,21 @@ llvm::Value *ASTArrayRefExpr::codegen()
   }
   else
   {
-    return irBuilder.CreateLoad(elementType, elementAddress, "arrayElement");
+    return ctx.irBuilder.CreateLoad(elementType, elementAddress, "arrayElement");
   }
 }
 
-llvm::Value *ASTDeclNode::codegen()
+llvm::Value *ASTDeclNode::codegen(CodeGenContext &ctx)
 {
   throw InternalError("Declarations do not emit code");
 }
 
-llvm::Value *ASTDeclStmt::codegen()
+llvm::Value *ASTDeclStmt::codegen(CodeGenContext &ctx)
 {
   LOG_S(1) << "Generating code for " << *this;
 
   // The LLVM builder records the function we are currently generating
-  llvm::Function *TheFunction = irBuilder.GetInsertBlock()->getParent();
+  llvm::Function *TheFunction = ctx.irBuilder.GetInsertBlock()->getParent();
 
   llvm::AllocaInst *localAlloca = nullptr;
 
@@ -1200,24 +1371,24 @@ llvm::Value *ASTDeclStmt::codegen()
     localAlloca = CreateEntryBlockAlloca(TheFunction, l->getName());
 
     // Initialize all locals to "0"
-    irBuilder.CreateStore(zeroV, localAlloca);
+    ctx.irBuilder.CreateStore(ctx.zeroV, localAlloca);
 
     // Remember this binding.
-    namedValues[l->getName()] = localAlloca;
+    ctx.namedValues[l->getName()] = localAlloca;
   }
 
   // Return the body computation.
   return localAlloca;
 } // LCOV_EXCL_LINE
 
-llvm::Value *ASTAssignStmt::codegen()
+llvm::Value *ASTAssignStmt::codegen(CodeGenContext &ctx)
 {
   LOG_S(1) << "Generating code for " << *this;
 
   // trigger code generation for l-value expressions
-  lValueGen = true;
-  llvm::Value *lValue = getLHS()->codegen();
-  lValueGen = false;
+  ctx.lValueGen = true;
+  llvm::Value *lValue = getLHS()->codegen(ctx);
+  ctx.lValueGen = false;
 
   if (lValue == nullptr)
   {
@@ -1225,17 +1396,17 @@ llvm::Value *ASTAssignStmt::codegen()
         "failed to generate bitcode for the lhs of the assignment");
   }
 
-  llvm::Value *rValue = getRHS()->codegen();
+  llvm::Value *rValue = getRHS()->codegen(ctx);
   if (rValue == nullptr)
   {
     throw InternalError(
         "failed to generate bitcode for the rhs of the assignment");
   }
 
-  return irBuilder.CreateStore(rValue, lValue);
+  return ctx.irBuilder.CreateStore(rValue, lValue);
 } // LCOV_EXCL_LINE
 
-llvm::Value *ASTBlockStmt::codegen()
+llvm::Value *ASTBlockStmt::codegen(CodeGenContext &ctx)
 {
   LOG_S(1) << "Generating code for " << *this;
 
@@ -1243,11 +1414,11 @@ llvm::Value *ASTBlockStmt::codegen()
 
   for (auto const &s : getStmts())
   {
-    lastStmt = s->codegen();
+    lastStmt = s->codegen(ctx);
   }
 
   // If the block was empty return a nop
-  return (lastStmt == nullptr) ? irBuilder.CreateCall(nop) : lastStmt;
+  return (lastStmt == nullptr) ? ctx.irBuilder.CreateCall(ctx.nop) : lastStmt;
 } // LCOV_EXCL_LINE
 
 /*
@@ -1267,11 +1438,11 @@ llvm::Value *ASTBlockStmt::codegen()
  * is generated into a basic block since it will be branched to after the
  * body executes.
  */
-llvm::Value *ASTWhileStmt::codegen()
+llvm::Value *ASTWhileStmt::codegen(CodeGenContext &ctx)
 {
   LOG_S(1) << "Generating code for " << *this;
 
-  llvm::Function *TheFunction = irBuilder.GetInsertBlock()->getParent();
+  llvm::Function *TheFunction = ctx.irBuilder.GetInsertBlock()->getParent();
 
   /*
    * Create blocks for the loop header, body, and exit; HeaderBB is first
@@ -1281,23 +1452,23 @@ llvm::Value *ASTWhileStmt::codegen()
    * any particular way because we will explicitly branch between them.
    * This can be optimized by later passes.
    */
-  labelNum++; // create shared labels for these BBs
+  ctx.labelNum++; // create shared labels for these BBs
 
   llvm::BasicBlock *HeaderBB = llvm::BasicBlock::Create(
-      llvmContext, "header" + std::to_string(labelNum), TheFunction);
-  llvm::BasicBlock *BodyBB =
-      llvm::BasicBlock::Create(llvmContext, "body" + std::to_string(labelNum));
-  llvm::BasicBlock *ExitBB =
-      llvm::BasicBlock::Create(llvmContext, "exit" + std::to_string(labelNum));
+      ctx.llvmContext, "header" + std::to_string(ctx.labelNum), TheFunction);
+  llvm::BasicBlock *BodyBB = llvm::BasicBlock::Create(
+      ctx.llvmContext, "body" + std::to_string(ctx.labelNum));
+  llvm::BasicBlock *ExitBB = llvm::BasicBlock::Create(
+      ctx.llvmContext, "exit" + std::to_string(ctx.labelNum));
 
   // Add an explicit branch from the current BB to the header
-  irBuilder.CreateBr(HeaderBB);
+  ctx.irBuilder.CreateBr(HeaderBB);
 
   // Emit loop header
   {
-    irBuilder.SetInsertPoint(HeaderBB);
+    ctx.irBuilder.SetInsertPoint(HeaderBB);
 
-    llvm::Value *CondV = getCondition()->codegen();
+    llvm::Value *CondV = getCondition()->codegen(ctx);
     if (CondV == nullptr)
     {
       throw InternalError(                                   // LCOV_EXCL_LINE
@@ -1305,239 +1476,240 @@ llvm::Value *ASTWhileStmt::codegen()
     }
 
     // Convert condition to a bool by comparing non-equal to 0.
-    CondV = irBuilder.CreateICmpNE(
+    CondV = ctx.irBuilder.CreateICmpNE(
         CondV, llvm::ConstantInt::get(CondV->getType(), 0), "loopcond");
 
-    irBuilder.CreateCondBr(CondV, BodyBB, ExitBB);
+    ctx.irBuilder.CreateCondBr(CondV, BodyBB, ExitBB);
   }
 
   // Emit loop body
   {
     TheFunction->insert(TheFunction->end(), BodyBB);
-    irBuilder.SetInsertPoint(BodyBB);
+    ctx.irBuilder.SetInsertPoint(BodyBB);
 
-    llvm::Value *BodyV = getBody()->codegen();
+    llvm::Value *BodyV = getBody()->codegen(ctx);
     if (BodyV == nullptr)
     {
       throw InternalError(                                 // LCOV_EXCL_LINE
           "failed to generate bitcode for the loop body"); // LCOV_EXCL_LINE
     }
 
-    irBuilder.CreateBr(HeaderBB);
+    ctx.irBuilder.CreateBr(HeaderBB);
   }
 
   // Emit loop exit block.
   TheFunction->insert(TheFunction->end(), ExitBB);
-  irBuilder.SetInsertPoint(ExitBB);
-  return irBuilder.CreateCall(nop);
+  ctx.irBuilder.SetInsertPoint(ExitBB);
+  return ctx.irBuilder.CreateCall(ctx.nop);
 } // LCOV_EXCL_LINE
 
-llvm::Value *ASTForLoopStmt::codegen()
+llvm::Value *ASTForLoopStmt::codegen(CodeGenContext &ctx)
 {
   LOG_S(1) << "Generating code for " << *this;
 
-  llvm::Function *TheFunction = irBuilder.GetInsertBlock()->getParent();
-  labelNum++;
+  llvm::Function *TheFunction = ctx.irBuilder.GetInsertBlock()->getParent();
+  ctx.labelNum++;
 
   llvm::BasicBlock *InitBB = llvm::BasicBlock::Create(
-      llvmContext, "init" + std::to_string(labelNum), TheFunction);
+      ctx.llvmContext, "init" + std::to_string(ctx.labelNum), TheFunction);
   llvm::BasicBlock *HeaderBB = llvm::BasicBlock::Create(
-      llvmContext, "header" + std::to_string(labelNum), TheFunction);
+      ctx.llvmContext, "header" + std::to_string(ctx.labelNum), TheFunction);
   llvm::BasicBlock *BodyBB = llvm::BasicBlock::Create(
-      llvmContext, "body" + std::to_string(labelNum), TheFunction);
+      ctx.llvmContext, "body" + std::to_string(ctx.labelNum), TheFunction);
   llvm::BasicBlock *UpdateBB = llvm::BasicBlock::Create(
-      llvmContext, "update" + std::to_string(labelNum), TheFunction);
+      ctx.llvmContext, "update" + std::to_string(ctx.labelNum), TheFunction);
   llvm::BasicBlock *ExitBB = llvm::BasicBlock::Create(
-      llvmContext, "exit" + std::to_string(labelNum), TheFunction);
+      ctx.llvmContext, "exit" + std::to_string(ctx.labelNum), TheFunction);
 
-  irBuilder.CreateBr(InitBB);
-  irBuilder.SetInsertPoint(InitBB);
+  ctx.irBuilder.CreateBr(InitBB);
+  ctx.irBuilder.SetInsertPoint(InitBB);
 
-  llvm::Value *StartVal = START->codegen();
+  llvm::Value *StartVal = START->codegen(ctx);
   if (!StartVal)
   {
     throw InternalError("failed to generate bitcode for the start value");
   }
 
   // missed this for quite a while, but this bit is stolen from assignment statement - you need it to extract the variable from getVar()
-  lValueGen = true;
-  llvm::Value *VarAlloc = getVar()->codegen();
-  lValueGen = false;
+  ctx.lValueGen = true;
+  llvm::Value *VarAlloc = getVar()->codegen(ctx);
+  ctx.lValueGen = false;
 
-  irBuilder.CreateStore(StartVal, VarAlloc);
+  ctx.irBuilder.CreateStore(StartVal, VarAlloc);
 
   // Branch to header to begin the loop
-  irBuilder.CreateBr(HeaderBB);
+  ctx.irBuilder.CreateBr(HeaderBB);
 
   // Emit loop condition check (header)
-  irBuilder.SetInsertPoint(HeaderBB);
-  llvm::Value *EndVal = END->codegen();
+  ctx.irBuilder.SetInsertPoint(HeaderBB);
+  llvm::Value *EndVal = END->codegen(ctx);
   if (!EndVal)
   {
     throw InternalError("failed to generate bitcode for the end value");
   }
-  llvm::Value *CurrentVal = irBuilder.CreateLoad(StartVal->getType(), VarAlloc, "currentval");
-  llvm::Value *CondV = irBuilder.CreateICmpSLT(CurrentVal, EndVal, "loopcond");
+  llvm::Value *CurrentVal = ctx.irBuilder.CreateLoad(StartVal->getType(), VarAlloc, "currentval");
+  llvm::Value *CondV = ctx.irBuilder.CreateICmpSLT(CurrentVal, EndVal, "loopcond");
 
-  irBuilder.CreateCondBr(CondV, BodyBB, ExitBB);
+  ctx.irBuilder.CreateCondBr(CondV, BodyBB, ExitBB);
 
   // Emit loop body
-  irBuilder.SetInsertPoint(BodyBB);
-  llvm::Value *BodyV = BODY->codegen();
+  ctx.irBuilder.SetInsertPoint(BodyBB);
+  llvm::Value *BodyV = BODY->codegen(ctx);
   if (!BodyV)
   {
     throw InternalError("failed to generate bitcode for the loop body");
   }
-  irBuilder.CreateBr(UpdateBB);
+  ctx.irBuilder.CreateBr(UpdateBB);
 
   // Emit loop variable update
-  irBuilder.SetInsertPoint(UpdateBB);
-  llvm::Value *StepVal = STEP ? STEP->codegen() : llvm::ConstantInt::get(CurrentVal->getType(), 1);
+  ctx.irBuilder.SetInsertPoint(UpdateBB);
+  llvm::Value *StepVal = STEP ? STEP->codegen(ctx) : llvm::ConstantInt::get(CurrentVal->getType(), 1);
   if (!StepVal)
   {
     throw InternalError("failed to generate bitcode for the step value");
   }
-  llvm::Value *NextVal = irBuilder.CreateAdd(CurrentVal, StepVal, "nextval");
-  irBuilder.CreateStore(NextVal, VarAlloc);
+  llvm::Value *NextVal = ctx.irBuilder.CreateAdd(CurrentVal, StepVal, "nextval");
+  ctx.irBuilder.CreateStore(NextVal, VarAlloc);
 
-  irBuilder.CreateBr(HeaderBB);
+  ctx.irBuilder.CreateBr(HeaderBB);
 
   // Emit loop exit block
-  irBuilder.SetInsertPoint(ExitBB);
-  return irBuilder.CreateCall(nop);
+  ctx.irBuilder.SetInsertPoint(ExitBB);
+  return ctx.irBuilder.CreateCall(ctx.nop);
 }
 
-llvm::Value *ASTTernaryExpr::codegen()
+llvm::Value *ASTTernaryExpr::codegen(CodeGenContext &ctx)
 {
   LOG_S(1) << "Generating code for " << *this;
 
-  llvm::Value *CondV = getCondition()->codegen();
+  llvm::Value *CondV = getCondition()->codegen(ctx);
   if (CondV == nullptr)
   {
     throw InternalError("failed to generate bitcode for the condition of the if statement");
   }
 
-  CondV = irBuilder.CreateICmpNE(
+  CondV = ctx.irBuilder.CreateICmpNE(
       CondV, llvm::ConstantInt::get(CondV->getType(), 0), "ternarycond");
 
-  llvm::Function *TheFunction = irBuilder.GetInsertBlock()->getParent();
+  llvm::Function *TheFunction = ctx.irBuilder.GetInsertBlock()->getParent();
 
-  labelNum++;
+  ctx.labelNum++;
   llvm::BasicBlock *TrueBB = llvm::BasicBlock::Create(
-      llvmContext, "true_expr" + std::to_string(labelNum), TheFunction);
+      ctx.llvmContext, "true_expr" + std::to_string(ctx.labelNum), TheFunction);
   llvm::BasicBlock *FalseBB = llvm::BasicBlock::Create(
-      llvmContext, "false_expr" + std::to_string(labelNum), TheFunction);
+      ctx.llvmContext, "false_expr" + std::to_string(ctx.labelNum), TheFunction);
   llvm::BasicBlock *MergeBB = llvm::BasicBlock::Create(
-      llvmContext, "ternarymerge" + std::to_string(labelNum), TheFunction);
+      ctx.llvmContext, "ternarymerge" + std::to_string(ctx.labelNum),
+      TheFunction);
 
-  irBuilder.CreateCondBr(CondV, TrueBB, FalseBB);
+  ctx.irBuilder.CreateCondBr(CondV, TrueBB, FalseBB);
 
   llvm::Value *TrueV, *FalseV;
   {
-    irBuilder.SetInsertPoint(TrueBB);
-    TrueV = getTrueExpr()->codegen();
+    ctx.irBuilder.SetInsertPoint(TrueBB);
+    TrueV = getTrueExpr()->codegen(ctx);
     if (!TrueV)
       throw InternalError("failed to generate bitcode for true expression");
 
-    irBuilder.CreateBr(MergeBB);
+    ctx.irBuilder.CreateBr(MergeBB);
   }
 
   {
-    irBuilder.SetInsertPoint(FalseBB);
-    FalseV = getFalseExpr()->codegen();
+    ctx.irBuilder.SetInsertPoint(FalseBB);
+    FalseV = getFalseExpr()->codegen(ctx);
     if (!FalseV)
       throw InternalError("failed to generate bitcode for false expression");
 
-    irBuilder.CreateBr(MergeBB);
+    ctx.irBuilder.CreateBr(MergeBB);
   }
 
-  irBuilder.SetInsertPoint(MergeBB);
-  llvm::PHINode *PN = irBuilder.CreatePHI(TrueV->getType(), 2, "iftmp");
+  ctx.irBuilder.SetInsertPoint(MergeBB);
+  llvm::PHINode *PN = ctx.irBuilder.CreatePHI(TrueV->getType(), 2, "iftmp");
   PN->addIncoming(TrueV, TrueBB);
   PN->addIncoming(FalseV, FalseBB);
 
   return PN; // Return the PHI node, which selects the correct value
 }
 
-llvm::Value *ASTIterStmt::codegen()
+llvm::Value *ASTIterStmt::codegen(CodeGenContext &ctx)
 {
   LOG_S(1) << "Generating code for " << *this;
 
-  llvm::Function *TheFunction = irBuilder.GetInsertBlock()->getParent();
-  labelNum++;
+  llvm::Function *TheFunction = ctx.irBuilder.GetInsertBlock()->getParent();
+  ctx.labelNum++;
 
   llvm::BasicBlock *InitBB = llvm::BasicBlock::Create(
-      llvmContext, "init" + std::to_string(labelNum), TheFunction);
+      ctx.llvmContext, "init" + std::to_string(ctx.labelNum), TheFunction);
   llvm::BasicBlock *HeaderBB = llvm::BasicBlock::Create(
-      llvmContext, "header" + std::to_string(labelNum), TheFunction);
+      ctx.llvmContext, "header" + std::to_string(ctx.labelNum), TheFunction);
   llvm::BasicBlock *BodyBB = llvm::BasicBlock::Create(
-      llvmContext, "body" + std::to_string(labelNum), TheFunction);
+      ctx.llvmContext, "body" + std::to_string(ctx.labelNum), TheFunction);
   llvm::BasicBlock *ExitBB = llvm::BasicBlock::Create(
-      llvmContext, "exit" + std::to_string(labelNum), TheFunction);
+      ctx.llvmContext, "exit" + std::to_string(ctx.labelNum), TheFunction);
 
-  irBuilder.CreateBr(InitBB);
+  ctx.irBuilder.CreateBr(InitBB);
 
-  irBuilder.SetInsertPoint(InitBB);
+  ctx.irBuilder.SetInsertPoint(InitBB);
 
-  llvm::Value *iterableValue = getIterable()->codegen();
+  llvm::Value *iterableValue = getIterable()->codegen(ctx);
   if (!iterableValue)
   {
     throw InternalError("Failed to generate code for the iterable");
   }
 
-  llvm::Type *elementType = llvm::Type::getInt64Ty(llvmContext);
+  llvm::Type *elementType = llvm::Type::getInt64Ty(ctx.llvmContext);
   llvm::StructType *arrayStructType = llvm::StructType::get(
-      llvmContext, {llvm::Type::getInt64Ty(llvmContext), elementType->getPointerTo()});
-  llvm::Value *arrayStructPtr = irBuilder.CreateIntToPtr(iterableValue, arrayStructType->getPointerTo(), "arrayPtrCast");
+      ctx.llvmContext, {llvm::Type::getInt64Ty(ctx.llvmContext), elementType->getPointerTo()});
+  llvm::Value *arrayStructPtr = ctx.irBuilder.CreateIntToPtr(iterableValue, arrayStructType->getPointerTo(), "arrayPtrCast");
 
-  llvm::Value *sizePtr = irBuilder.CreateStructGEP(arrayStructType, arrayStructPtr, 0, "sizePtr");
-  llvm::Value *arraySize = irBuilder.CreateLoad(llvm::Type::getInt64Ty(llvmContext), sizePtr, "arraySize");
+  llvm::Value *sizePtr = ctx.irBuilder.CreateStructGEP(arrayStructType, arrayStructPtr, 0, "sizePtr");
+  llvm::Value *arraySize = ctx.irBuilder.CreateLoad(llvm::Type::getInt64Ty(ctx.llvmContext), sizePtr, "arraySize");
 
-  llvm::Value *dataPtr = irBuilder.CreateStructGEP(arrayStructType, arrayStructPtr, 1, "dataPtr");
-  llvm::Value *arrayData = irBuilder.CreateLoad(elementType->getPointerTo(), dataPtr, "arrayData");
+  llvm::Value *dataPtr = ctx.irBuilder.CreateStructGEP(arrayStructType, arrayStructPtr, 1, "dataPtr");
+  llvm::Value *arrayData = ctx.irBuilder.CreateLoad(elementType->getPointerTo(), dataPtr, "arrayData");
 
-  llvm::AllocaInst *indexAlloca = irBuilder.CreateAlloca(llvm::Type::getInt64Ty(llvmContext), nullptr, "index");
-  irBuilder.CreateStore(llvm::ConstantInt::get(llvm::Type::getInt64Ty(llvmContext), 0), indexAlloca);
+  llvm::AllocaInst *indexAlloca = ctx.irBuilder.CreateAlloca(llvm::Type::getInt64Ty(ctx.llvmContext), nullptr, "index");
+  ctx.irBuilder.CreateStore(llvm::ConstantInt::get(llvm::Type::getInt64Ty(ctx.llvmContext), 0), indexAlloca);
 
-  irBuilder.CreateBr(HeaderBB);
+  ctx.irBuilder.CreateBr(HeaderBB);
 
-  irBuilder.SetInsertPoint(HeaderBB);
+  ctx.irBuilder.SetInsertPoint(HeaderBB);
 
-  llvm::Value *currentIndex = irBuilder.CreateLoad(indexAlloca->getAllocatedType(), indexAlloca, "currentIndex");
-  llvm::Value *cond = irBuilder.CreateICmpSLT(currentIndex, arraySize, "loopcond");
-  irBuilder.CreateCondBr(cond, BodyBB, ExitBB);
+  llvm::Value *currentIndex = ctx.irBuilder.CreateLoad(indexAlloca->getAllocatedType(), indexAlloca, "currentIndex");
+  llvm::Value *cond = ctx.irBuilder.CreateICmpSLT(currentIndex, arraySize, "loopcond");
+  ctx.irBuilder.CreateCondBr(cond, BodyBB, ExitBB);
 
-  irBuilder.SetInsertPoint(BodyBB);
+  ctx.irBuilder.SetInsertPoint(BodyBB);
 
-  llvm::Value *elementPtr = irBuilder.CreateGEP(
+  llvm::Value *elementPtr = ctx.irBuilder.CreateGEP(
       elementType, arrayData, currentIndex, "arrayElementPtr");
-  llvm::Value *elementValue = irBuilder.CreateLoad(elementType, elementPtr, "arrayElement");
+  llvm::Value *elementValue = ctx.irBuilder.CreateLoad(elementType, elementPtr, "arrayElement");
 
-  lValueGen = true;
-  llvm::Value *elementVarAlloc = getElement()->codegen();
-  lValueGen = false;
+  ctx.lValueGen = true;
+  llvm::Value *elementVarAlloc = getElement()->codegen(ctx);
+  ctx.lValueGen = false;
 
   if (!elementVarAlloc)
   {
     throw InternalError("Failed to generate code for element variable");
   }
-  irBuilder.CreateStore(elementValue, elementVarAlloc);
+  ctx.irBuilder.CreateStore(elementValue, elementVarAlloc);
 
-  llvm::Value *bodyCode = getBody()->codegen();
+  llvm::Value *bodyCode = getBody()->codegen(ctx);
   if (!bodyCode)
   {
     throw InternalError("Failed to generate code for the loop body");
   }
 
-  llvm::Value *nextIndex = irBuilder.CreateAdd(
-      currentIndex, llvm::ConstantInt::get(llvm::Type::getInt64Ty(llvmContext), 1), "nextIndex");
-  irBuilder.CreateStore(nextIndex, indexAlloca);
+  llvm::Value *nextIndex = ctx.irBuilder.CreateAdd(
+      currentIndex, llvm::ConstantInt::get(llvm::Type::getInt64Ty(ctx.llvmContext), 1), "nextIndex");
+  ctx.irBuilder.CreateStore(nextIndex, indexAlloca);
 
-  irBuilder.CreateBr(HeaderBB);
+  ctx.irBuilder.CreateBr(HeaderBB);
 
-  irBuilder.SetInsertPoint(ExitBB);
+  ctx.irBuilder.SetInsertPoint(ExitBB);
 
-  return irBuilder.CreateCall(nop);
+  return ctx.irBuilder.CreateCall(ctx.nop);
 }
 
 /*
@@ -1555,11 +1727,11 @@ llvm::Value *ASTIterStmt::codegen()
  * the insertion point, and then letting other codegen functions write
  * code at that insertion point.
  */
-llvm::Value *ASTIfStmt::codegen()
+llvm::Value *ASTIfStmt::codegen(CodeGenContext &ctx)
 {
   LOG_S(1) << "Generating code for " << *this;
 
-  llvm::Value *CondV = getCondition()->codegen();
+  llvm::Value *CondV = getCondition()->codegen(ctx);
   if (CondV == nullptr)
   {
     throw InternalError(
@@ -1567,10 +1739,10 @@ llvm::Value *ASTIfStmt::codegen()
   }
 
   // Convert condition to a bool by comparing non-equal to 0.
-  CondV = irBuilder.CreateICmpNE(
+  CondV = ctx.irBuilder.CreateICmpNE(
       CondV, llvm::ConstantInt::get(CondV->getType(), 0), "ifcond");
 
-  llvm::Function *TheFunction = irBuilder.GetInsertBlock()->getParent();
+  llvm::Function *TheFunction = ctx.irBuilder.GetInsertBlock()->getParent();
 
   /*
    * Create blocks for the then and else cases.  The then block is first, so
@@ -1582,41 +1754,41 @@ llvm::Value *ASTIfStmt::codegen()
    * any particular way because we will explicitly branch between them.
    * This can be optimized to fall through behavior by later passes.
    */
-  labelNum++; // create shared labels for these BBs
+  ctx.labelNum++; // create shared labels for these BBs
   llvm::BasicBlock *ThenBB = llvm::BasicBlock::Create(
-      llvmContext, "then" + std::to_string(labelNum), TheFunction);
-  llvm::BasicBlock *ElseBB =
-      llvm::BasicBlock::Create(llvmContext, "else" + std::to_string(labelNum));
+      ctx.llvmContext, "then" + std::to_string(ctx.labelNum), TheFunction);
+  llvm::BasicBlock *ElseBB = llvm::BasicBlock::Create(
+      ctx.llvmContext, "else" + std::to_string(ctx.labelNum));
   llvm::BasicBlock *MergeBB = llvm::BasicBlock::Create(
-      llvmContext, "ifmerge" + std::to_string(labelNum));
+      ctx.llvmContext, "ifmerge" + std::to_string(ctx.labelNum));
 
-  irBuilder.CreateCondBr(CondV, ThenBB, ElseBB);
+  ctx.irBuilder.CreateCondBr(CondV, ThenBB, ElseBB);
 
   // Emit then block.
   {
-    irBuilder.SetInsertPoint(ThenBB);
+    ctx.irBuilder.SetInsertPoint(ThenBB);
 
-    llvm::Value *ThenV = getThen()->codegen();
+    llvm::Value *ThenV = getThen()->codegen(ctx);
     if (ThenV == nullptr)
     {
       throw InternalError(                                  // LCOV_EXCL_LINE
           "failed to generate bitcode for the then block"); // LCOV_EXCL_LINE
     }
 
-    irBuilder.CreateBr(MergeBB);
+    ctx.irBuilder.CreateBr(MergeBB);
   }
 
   // Emit else block.
   {
     TheFunction->insert(TheFunction->end(), ElseBB);
 
-    irBuilder.SetInsertPoint(ElseBB);
+    ctx.irBuilder.SetInsertPoint(ElseBB);
 
     // if there is no ELSE then exist emit a "nop"
     llvm::Value *ElseV;
     if (getElse() != nullptr)
     {
-      ElseV = getElse()->codegen();
+      ElseV = getElse()->codegen(ctx);
       if (ElseV == nullptr)
       {
         throw InternalError(                                  // LCOV_EXCL_LINE
@@ -1625,33 +1797,34 @@ llvm::Value *ASTIfStmt::codegen()
     }
     else
     {
-      irBuilder.CreateCall(nop);
+      ctx.irBuilder.CreateCall(ctx.nop);
     }
 
-    irBuilder.CreateBr(MergeBB);
+    ctx.irBuilder.CreateBr(MergeBB);
   }
 
   // Emit merge block.
   TheFunction->insert(TheFunction->end(), MergeBB);
-  irBuilder.SetInsertPoint(MergeBB);
-  return irBuilder.CreateCall(nop);
+  ctx.irBuilder.SetInsertPoint(MergeBB);
+  return ctx.irBuilder.CreateCall(ctx.nop);
 } // LCOV_EXCL_LINE
 
-llvm::Value *ASTOutputStmt::codegen()
+llvm::Value *ASTOutputStmt::codegen(CodeGenContext &ctx)
 {
   LOG_S(1) << "Generating code for " << *this;
 
-  if (outputIntrinsic == nullptr)
+  if (ctx.outputIntrinsic == nullptr)
   {
-    std::vector<llvm::Type *> oneInt(1, llvm::Type::getInt64Ty(llvmContext));
-    auto *FT = llvm::FunctionType::get(llvm::Type::getInt64Ty(llvmContext),
+    std::vector<llvm::Type *> oneInt(1,
+                                     llvm::Type::getInt64Ty(ctx.llvmContext));
+    auto *FT = llvm::FunctionType::get(llvm::Type::getVoidTy(ctx.llvmContext),
                                        oneInt, false);
-    outputIntrinsic =
+    ctx.outputIntrinsic =
         llvm::Function::Create(FT, llvm::Function::ExternalLinkage,
-                               "_tip_output", CurrentModule.get());
+                               "_tip_output", ctx.CurrentModule.get());
   }
 
-  llvm::Value *argVal = getArg()->codegen();
+  llvm::Value *argVal = getArg()->codegen(ctx);
   if (argVal == nullptr)
   {
     throw InternalError(
@@ -1660,23 +1833,25 @@ llvm::Value *ASTOutputStmt::codegen()
 
   std::vector<llvm::Value *> ArgsV(1, argVal);
 
-  return irBuilder.CreateCall(outputIntrinsic, ArgsV);
+  return ctx.irBuilder.CreateCall(ctx.outputIntrinsic, ArgsV);
 }
 
-llvm::Value *ASTErrorStmt::codegen()
+llvm::Value *ASTErrorStmt::codegen(CodeGenContext &ctx)
 {
   LOG_S(1) << "Generating code for " << *this;
 
-  if (errorIntrinsic == nullptr)
+  if (ctx.errorIntrinsic == nullptr)
   {
-    std::vector<llvm::Type *> oneInt(1, llvm::Type::getInt64Ty(llvmContext));
-    auto *FT = llvm::FunctionType::get(llvm::Type::getInt64Ty(llvmContext),
+    std::vector<llvm::Type *> oneInt(1,
+                                     llvm::Type::getInt64Ty(ctx.llvmContext));
+    auto *FT = llvm::FunctionType::get(llvm::Type::getVoidTy(ctx.llvmContext),
                                        oneInt, false);
-    errorIntrinsic = llvm::Function::Create(FT, llvm::Function::ExternalLinkage,
-                                            "_tip_error", CurrentModule.get());
+    ctx.errorIntrinsic =
+        llvm::Function::Create(FT, llvm::Function::ExternalLinkage,
+                               "_tip_error", ctx.CurrentModule.get());
   }
 
-  llvm::Value *argVal = getArg()->codegen();
+  llvm::Value *argVal = getArg()->codegen(ctx);
   if (argVal == nullptr)
   {
     throw InternalError(
@@ -1685,13 +1860,13 @@ llvm::Value *ASTErrorStmt::codegen()
 
   std::vector<llvm::Value *> ArgsV(1, argVal);
 
-  return irBuilder.CreateCall(errorIntrinsic, ArgsV);
+  return ctx.irBuilder.CreateCall(ctx.errorIntrinsic, ArgsV);
 }
 
-llvm::Value *ASTReturnStmt::codegen()
+llvm::Value *ASTReturnStmt::codegen(CodeGenContext &ctx)
 {
   LOG_S(1) << "Generating code for " << *this;
 
-  llvm::Value *argVal = getArg()->codegen();
-  return irBuilder.CreateRet(argVal);
+  llvm::Value *argVal = getArg()->codegen(ctx);
+  return ctx.irBuilder.CreateRet(argVal);
 }
\ No newline at end of file
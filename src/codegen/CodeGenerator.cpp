@@ -1,25 +1,181 @@
 #include "CodeGenerator.h"
+#include "CodeGenContext.h"
+#include "DiskObjectCache.h"
+#include "InternalError.h"
+#include "Parallel.h"
 #include <llvm/IR/Verifier.h>
 
+#include "llvm/Bitcode/BitcodeReader.h"
 #include "llvm/Bitcode/BitcodeWriter.h"
+#include "llvm/CodeGen/ParallelCG.h"
+#include "llvm/ExecutionEngine/Orc/CompileUtils.h"
+#include "llvm/ExecutionEngine/Orc/ExecutionUtils.h"
+#include "llvm/ExecutionEngine/Orc/LLJIT.h"
+#include "llvm/IR/LegacyPassManager.h"
+#include "llvm/Linker/Linker.h"
+#include "llvm/MC/TargetRegistry.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Program.h"
+#include "llvm/Support/SHA1.h"
+#include "llvm/Support/TargetSelect.h"
 #include "llvm/Support/ToolOutputFile.h"
+#include "llvm/Target/TargetMachine.h"
+#include "llvm/Target/TargetOptions.h"
+#include "llvm/Transforms/IPO/Internalize.h"
+
+#include "loguru.hpp"
+
+#include <functional>
+#include <mutex>
 
 using namespace llvm;
 
+namespace {
+// Bitcode of rtlib/tip_rtlib.c, which is generated by the build
+const unsigned char runtimeBitcode[] = {
+#include "tip_rtlib.inc"
+};
+
+/*
+ * Register the native target once.  Registration is not thread safe, so the
+ * driver also does this before it compiles programs concurrently.
+ */
+void initializeNativeTarget() {
+  static const bool initialized = [] {
+    InitializeNativeTarget();
+    InitializeNativeTargetAsmPrinter();
+    return true;
+  }();
+  (void)initialized;
+}
+
+/*
+ * Open an output file, reporting a file that cannot be written as an internal
+ * error rather than writing nothing.
+ */
+std::unique_ptr<ToolOutputFile> openOutput(const std::string &filename) {
+  std::error_code ec;
+  auto result =
+      std::make_unique<ToolOutputFile>(filename, ec, sys::fs::OF_None);
+  if (ec) {
+    throw InternalError("cannot open '" + filename + "': " + ec.message());
+  }
+  return result;
+}
+
+/*
+ * Keep an output file once it has been written.  Errors writing it are
+ * reported here, since the stream would otherwise report them as fatal when
+ * it is destroyed, and the file is then removed.
+ */
+void keepOutput(ToolOutputFile &result, const std::string &filename) {
+  result.os().close();
+  if (auto ec = result.os().error()) {
+    result.os().clear_error();
+    throw InternalError("cannot write '" + filename + "': " + ec.message());
+  }
+  result.keep();
+}
+
+/*
+ * Emit the object of a module as partitions that are compiled concurrently,
+ * then combine their objects into one by a relocatable link.  Local symbols
+ * referred to from another partition become hidden globals of the module.
+ */
+void emitPartitions(
+    Module *m, const std::string &filename, unsigned jobs,
+    const std::string &linker,
+    const std::function<std::unique_ptr<TargetMachine>()> &createMachine) {
+  std::vector<std::string> paths;
+  std::vector<std::unique_ptr<raw_fd_ostream>> objects;
+  for (unsigned i = 0; i < jobs; i++) {
+    int fd;
+    SmallString<128> path;
+    if (auto ec = sys::fs::createTemporaryFile("tipc-partition", "o", fd,
+                                               path)) {
+      for (auto &partition : paths) {
+        sys::fs::remove(partition);
+      }
+      throw InternalError("cannot create a partition object: " +
+                          ec.message());
+    }
+    paths.push_back(path.str().str());
+    objects.push_back(std::make_unique<raw_fd_ostream>(fd, true));
+  }
+
+  std::vector<raw_pwrite_stream *> streams;
+  for (auto &object : objects) {
+    streams.push_back(object.get());
+  }
+  LOG_S(1) << "Emitting " << jobs << " partitions of the object concurrently";
+  splitCodeGen(*m, streams, {}, createMachine, CGFT_ObjectFile);
+  std::error_code written;
+  for (auto &object : objects) {
+    object->close();
+    if (auto ec = object->error()) {
+      object->clear_error();
+      written = ec;
+    }
+  }
+  objects.clear();
+  if (written) {
+    for (auto &partition : paths) {
+      sys::fs::remove(partition);
+    }
+    throw InternalError("cannot write a partition object: " +
+                        written.message());
+  }
+
+  std::vector<StringRef> args{linker, "-r", "-o", filename};
+  args.insert(args.end(), paths.begin(), paths.end());
+  std::string message;
+  int status = sys::ExecuteAndWait(linker, args, {}, {}, 0, 0, &message);
+  for (auto &partition : paths) {
+    sys::fs::remove(partition);
+  }
+  if (status != 0) {
+    throw InternalError("cannot link the partitions of " + filename + ": " +
+                        (message.empty() ? "ld failed" : message));
+  }
+}
+} // namespace
+
 std::shared_ptr<Module>
 CodeGenerator::generate(ASTProgram *program, SemanticAnalysis *analysisResults,
-                        std::string fileName) {
-  return std::move(program->codegen(analysisResults, fileName));
+                        std::string fileName, unsigned jobs,
+                        const std::string &cacheDirectory) {
+  CodeGenContext ctx;
+  ctx.functionCache = cacheDirectory;
+  return std::move(program->codegen(ctx, analysisResults, fileName, jobs));
 } // LCOV_EXCL_LINE
 
+void CodeGenerator::linkRuntime(llvm::Module *m) {
+  auto runtime = parseBitcodeFile(
+      MemoryBufferRef(StringRef(reinterpret_cast<const char *>(runtimeBitcode),
+                                sizeof(runtimeBitcode)),
+                      "tip_rtlib.bc"),
+      m->getContext());
+  if (!runtime) {
+    throw InternalError("cannot read the runtime library: " +
+                        toString(runtime.takeError()));
+  }
+
+  // Both are compiled for the host, possibly under different vendor names
+  (*runtime)->setTargetTriple(m->getTargetTriple());
+  if (Linker::linkModules(*m, std::move(*runtime))) {
+    throw InternalError("cannot link the runtime library");
+  }
+
+  internalizeModule(
+      *m, [](const GlobalValue &value) { return value.getName() == "main"; });
+}
+
 void CodeGenerator::emit(llvm::Module *m, std::string filename) {
   if (filename.empty()) {
     filename = m->getModuleIdentifier() + LLVM_BC_EXT;
   }
 
-  std::error_code ec;
-  ToolOutputFile result(filename, ec, sys::fs::OF_None);
+  auto result = openOutput(filename);
 
   // Only enable this routine if the build type is Debug, TIPC_DEBUG definition is declared in src/codegen/CMakeLists.txt
 #ifdef TIPC_DEBUG
@@ -45,8 +201,8 @@ void CodeGenerator::emit(llvm::Module *m, std::string filename) {
 
 #endif
 
-  WriteBitcodeToFile(*m, result.os());
-  result.keep();
+  WriteBitcodeToFile(*m, result->os());
+  keepOutput(*result, filename);
 }
 
 void CodeGenerator::emitHumanReadableAssembly(llvm::Module *m,
@@ -55,8 +211,141 @@ void CodeGenerator::emitHumanReadableAssembly(llvm::Module *m,
     filename = m->getModuleIdentifier() + LLVM_ASM_EXT;
   }
 
-  std::error_code ec;
-  ToolOutputFile result(filename, ec, sys::fs::OF_None);
-  m->print(result.os(), nullptr);
-  result.keep();
+  auto result = openOutput(filename);
+  m->print(result->os(), nullptr);
+  keepOutput(*result, filename);
+}
+
+unsigned CodeGenerator::emitObject(llvm::Module *m, std::string filename,
+                                   unsigned jobs) {
+  if (filename.empty()) {
+    filename = m->getModuleIdentifier() + NATIVE_OBJ_EXT;
+  }
+
+  initializeNativeTarget();
+
+  std::string error;
+  auto triple = m->getTargetTriple();
+  auto *target = TargetRegistry::lookupTarget(triple, error);
+  if (target == nullptr) {
+    throw InternalError("no target for " + triple + ": " + error);
+  }
+
+  /*
+   * Code is position independent so that it links into PIE executables.  The
+   * CPU is generic unless the functions have been tuned for another one.
+   */
+  auto createMachine = [&]() {
+    return std::unique_ptr<TargetMachine>(target->createTargetMachine(
+        triple, "", "", TargetOptions(), Reloc::PIC_));
+  };
+  m->setDataLayout(createMachine()->createDataLayout());
+
+  if (jobs == 0) {
+    jobs = Parallel::hardwareJobs();
+  }
+  if (jobs > 1) {
+    // The linker is looked up, and its absence reported, once per process
+    static const auto linker = sys::findProgramByName("ld");
+    if (linker) {
+      emitPartitions(m, filename, jobs, *linker, createMachine);
+      return jobs;
+    }
+    static std::once_flag reported;
+    std::call_once(reported, [] {
+      LOG_S(WARNING) << "No ld found on PATH to combine the objects of "
+                        "partitions, so objects are emitted by one thread";
+    });
+  }
+
+  auto result = openOutput(filename);
+  legacy::PassManager passManager;
+  auto machine = createMachine();
+  if (machine->addPassesToEmitFile(passManager, result->os(), nullptr,
+                                   CGFT_ObjectFile)) {
+    throw InternalError("cannot emit object files for " + triple);
+  }
+  passManager.run(*m);
+  keepOutput(*result, filename);
+  return 1;
+}
+
+int CodeGenerator::run(llvm::Module *m, const std::vector<std::string> &args,
+                       const std::string &cacheDirectory) {
+  initializeNativeTarget();
+
+  auto machineBuilder = orc::JITTargetMachineBuilder::detectHost();
+  if (!machineBuilder) {
+    throw InternalError("cannot compile for the host: " +
+                        toString(machineBuilder.takeError()));
+  }
+
+  // The JIT owns the context of its modules, so it gets a copy of the module
+  SmallVector<char, 0> bitcode;
+  raw_svector_ostream stream(bitcode);
+  WriteBitcodeToFile(*m, stream);
+  auto context = std::make_unique<LLVMContext>();
+  auto module = parseBitcodeFile(
+      MemoryBufferRef(StringRef(bitcode.data(), bitcode.size()), ""),
+      *context);
+  if (!module) {
+    throw InternalError("cannot copy module: " +
+                        toString(module.takeError()));
+  }
+
+  // The cache finds objects by module identifier, which covers the object
+  SHA1 hash;
+  hash.update(StringRef(bitcode.data(), bitcode.size()));
+  hash.update(machineBuilder->getTargetTriple().str());
+  hash.update(machineBuilder->getCPU());
+  hash.update(machineBuilder->getFeatures().getString());
+  (*module)->setModuleIdentifier(toHex(hash.final(), true));
+
+  orc::LLJITBuilder builder;
+  builder.setJITTargetMachineBuilder(*machineBuilder);
+  std::unique_ptr<DiskObjectCache> cache;
+  if (!cacheDirectory.empty()) {
+    cache = std::make_unique<DiskObjectCache>(cacheDirectory);
+    builder.setCompileFunctionCreator(
+        [&cache](orc::JITTargetMachineBuilder machineBuilder)
+            -> Expected<std::unique_ptr<orc::IRCompileLayer::IRCompiler>> {
+          auto machine = machineBuilder.createTargetMachine();
+          if (!machine) {
+            return machine.takeError();
+          }
+          return std::make_unique<orc::TMOwningSimpleCompiler>(
+              std::move(*machine), cache.get());
+        });
+  }
+  auto jit = builder.create();
+  if (!jit) {
+    throw InternalError("cannot create JIT: " + toString(jit.takeError()));
+  }
+
+  // The C library is resolved in the process
+  auto &library = (*jit)->getMainJITDylib();
+  library.addGenerator(
+      cantFail(orc::DynamicLibrarySearchGenerator::GetForCurrentProcess(
+          (*jit)->getDataLayout().getGlobalPrefix())));
+
+  (*module)->setDataLayout((*jit)->getDataLayout());
+  if (auto error = (*jit)->addIRModule(
+          orc::ThreadSafeModule(std::move(*module), std::move(context)))) {
+    throw InternalError("cannot add module to JIT: " +
+                        toString(std::move(error)));
+  }
+
+  auto symbol = (*jit)->lookup("main");
+  if (!symbol) {
+    throw InternalError("cannot compile program: " +
+                        toString(symbol.takeError()));
+  }
+
+  std::vector<char *> argv;
+  for (auto &arg : args) {
+    argv.push_back(const_cast<char *>(arg.c_str()));
+  }
+  argv.push_back(nullptr);
+  auto *entry = symbol->toPtr<int (*)(int, char **)>();
+  return entry(static_cast<int>(args.size()), argv.data());
 }
@@ -4,8 +4,12 @@
 #include "SemanticAnalysis.h"
 #include "llvm/IR/Module.h"
 
+#include <string>
+#include <vector>
+
 static const char *const LLVM_ASM_EXT = ".ll";
 static const char *const LLVM_BC_EXT = ".bc";
+static const char *const NATIVE_OBJ_EXT = ".o";
 
 /*! \class CodeGenerator
  *  \brief Routines to optimize generated code.
@@ -22,11 +26,29 @@ public:
    * \param program the root of an AST encoding the program
    * \param analysisResults the results from semantic analysis of the program
    * \param fileName the name of the source file holding the program
+   * \param jobs the number of threads generating functions, 0 uses all
+   * hardware threads; the generated module does not depend on it
+   * \param cacheDirectory the directory caching the code of functions, none
+   * if empty; only functions whose source, types or callees changed are
+   * generated again
    * \return the LLVM module holding the generated program
    */
   static std::shared_ptr<llvm::Module>
   generate(ASTProgram *program, SemanticAnalysis *analysisResults,
-           std::string fileName);
+           std::string fileName, unsigned jobs = 1,
+           const std::string &cacheDirectory = "");
+
+  /*! \fn linkRuntime
+   *  \brief Link the runtime library into the program.
+   *
+   * The runtime library is embedded in tipc as bitcode.  Once it is linked,
+   * every symbol but main is internal, so that the optimizer sees the whole
+   * program; it can inline the runtime routines and remove unused ones.  The
+   * module no longer needs to be linked with tip_rtlib.bc.
+   * \param m the LLVM module holding the generated program
+   * \throws InternalError if the runtime library cannot be linked
+   */
+  static void linkRuntime(llvm::Module *m);
 
   /*! \fn emit
    *  \brief Emit LLVM IR to a file.
@@ -42,4 +64,40 @@ public:
    */
   static void emitHumanReadableAssembly(llvm::Module *m,
                                         std::string filename = "");
+
+  /*! \fn emitObject
+   *  \brief Emit a native object file for the host to a file.
+   *
+   * With several jobs the module is split into partitions whose machine code
+   * is generated concurrently, and the system linker combines their objects
+   * into one relocatable object.  Local symbols referred to across partitions
+   * are then hidden globals of the object.  Without ld on the PATH, machine
+   * code is generated by a single thread and a warning is logged the first
+   * time this happens.
+   * \param m the LLVM module holding the generated program
+   * \param jobs the number of threads generating machine code, 0 uses all
+   * hardware threads
+   * \return the number of partitions emitted, 1 if the object was emitted by
+   * a single thread
+   * \throws InternalError if the host target is not supported or the
+   * partitions cannot be linked
+   */
+  static unsigned emitObject(llvm::Module *m, std::string filename = "",
+                             unsigned jobs = 1);
+
+  /*! \fn run
+   *  \brief Compile the program in memory and run it.
+   *
+   * The module is compiled for the host by the ORC JIT and its main function,
+   * that of the runtime library, is called with the arguments.  It reads the
+   * arguments of the TIP main function into _tip_input_array.  With a cache
+   * directory, native code is cached under a hash of the module and the host.
+   * \param m the LLVM module holding the program, linked with the runtime
+   * \param args the arguments of the program, starting with its name
+   * \param cacheDirectory the directory of the object cache, none if empty
+   * \return the exit status of the program
+   * \throws InternalError if the program cannot be compiled
+   */
+  static int run(llvm::Module *m, const std::vector<std::string> &args,
+                 const std::string &cacheDirectory = "");
 };
@@ -0,0 +1,61 @@
+#include "DiskObjectCache.h"
+#include "CodeGenerator.h"
+
+#include "llvm/IR/Module.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include "loguru.hpp"
+
+DiskObjectCache::DiskObjectCache(std::string directory)
+    : directory(std::move(directory)) {}
+
+std::string DiskObjectCache::path(const llvm::Module *M) const {
+  llvm::SmallString<128> path(directory);
+  llvm::sys::path::append(path, M->getModuleIdentifier() + NATIVE_OBJ_EXT);
+  return path.str().str();
+}
+
+void DiskObjectCache::notifyObjectCompiled(const llvm::Module *M,
+                                           llvm::MemoryBufferRef object) {
+  if (auto error = llvm::sys::fs::create_directories(directory)) {
+    LOG_S(1) << "Cannot create object cache " << directory << ": "
+             << error.message();
+    return;
+  }
+
+  int fd;
+  llvm::SmallString<128> temporary;
+  if (auto error = llvm::sys::fs::createUniqueFile(
+          path(M) + ".%%%%%%.tmp", fd, temporary)) {
+    LOG_S(1) << "Cannot cache object of " << M->getModuleIdentifier() << ": "
+             << error.message();
+    return;
+  }
+  llvm::raw_fd_ostream stream(fd, true);
+  stream << object.getBuffer();
+  stream.close();
+
+  auto error = stream.error();
+  if (!error) {
+    error = llvm::sys::fs::rename(temporary, path(M));
+  }
+  if (error) {
+    LOG_S(1) << "Cannot cache object of " << M->getModuleIdentifier() << ": "
+             << error.message();
+    stream.clear_error();
+    llvm::sys::fs::remove(temporary);
+  }
+}
+
+std::unique_ptr<llvm::MemoryBuffer>
+DiskObjectCache::getObject(const llvm::Module *M) {
+  auto object = llvm::MemoryBuffer::getFile(path(M));
+  if (!object) {
+    return nullptr;
+  }
+  LOG_S(1) << "Using cached object of " << M->getModuleIdentifier();
+  return std::move(*object);
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "llvm/ExecutionEngine/ObjectCache.h"
+
+#include <string>
+
+/*! \class DiskObjectCache
+ *  \brief Object cache of the JIT that keeps objects in a directory.
+ *
+ * An object is stored in a file named after the identifier of the module it
+ * was compiled from, so the identifier must determine the object.  The cache
+ * is a best effort: objects that cannot be read or written are compiled
+ * again.  Objects are written under a temporary name and then renamed, so
+ * that several instances of tipc can share the directory.
+ */
+class DiskObjectCache : public llvm::ObjectCache {
+public:
+  /*! \brief Construct a cache in the directory, which is created on demand.
+   */
+  explicit DiskObjectCache(std::string directory);
+
+  /*! \brief Store the object compiled from the module.
+   */
+  void notifyObjectCompiled(const llvm::Module *M,
+                            llvm::MemoryBufferRef object) override;
+
+  /*! \brief Return the object compiled from the module, if it is cached.
+   * \return the object, or nullptr if it is not in the cache
+   */
+  std::unique_ptr<llvm::MemoryBuffer> getObject(const llvm::Module *M) override;
+
+private:
+  std::string path(const llvm::Module *M) const;
+
+  std::string directory;
+};
@@ -2,6 +2,7 @@
 
 #include "ASTBuilder.h"
 #include "ASTVisualizer.h"
+#include "AsciiCharStream.h"
 #include "ParseError.h"
 #include "PrettyPrinter.h"
 #include "TIPLexer.h"
@@ -30,8 +31,8 @@ void ParserErrorListener::syntaxError(Recognizer *recognizer,
                    std::to_string(charPositionInLine));
 }
 
-std::shared_ptr<ASTProgram> FrontEnd::parse(std::istream &stream) {
-  ANTLRInputStream input(stream);
+namespace {
+std::shared_ptr<ASTProgram> parseCharStream(CharStream &input) {
   TIPLexer lexer(&input);
   CommonTokenStream tokens(&lexer);
   TIPParser parser(&tokens);
@@ -44,17 +45,56 @@ std::shared_ptr<ASTProgram> FrontEnd::parse(std::istream &stream) {
 
   parser.removeParseListeners();
   parser.removeErrorListeners();
-  parser.addErrorListener(&parserErrorListener);
 
   LOG_S(1) << "Parsing program";
 
-  TIPParser::ProgramContext *tree = parser.program();
+  /*
+   * SLL prediction is much faster than full LL and suffices for almost all
+   * programs, so they are parsed with it first, bailing out at the first
+   * error.  Only then are they parsed again with full LL, which tells the
+   * programs SLL cannot predict from those that are wrong, and reports the
+   * errors of the latter through the error listener.  The generated rules
+   * report an error before the error strategy can bail out, so the listener
+   * is only attached for the second parse.
+   */
+  auto interpreter = parser.getInterpreter<atn::ParserATNSimulator>();
+  interpreter->setPredictionMode(atn::PredictionMode::SLL);
+  parser.setErrorHandler(std::make_shared<BailErrorStrategy>());
+
+  TIPParser::ProgramContext *tree;
+  try {
+    tree = parser.program();
+  } catch (ParseCancellationException &) {
+    LOG_S(1) << "Parsing program again with full LL prediction";
+    tokens.seek(0);
+    parser.reset();
+    parser.addErrorListener(&parserErrorListener);
+    interpreter->setPredictionMode(atn::PredictionMode::LL);
+    parser.setErrorHandler(std::make_shared<DefaultErrorStrategy>());
+    tree = parser.program();
+  }
 
   LOG_S(1) << "Building AST";
 
   ASTBuilder ab(&parser);
   return ab.build(tree);
 }
+} // namespace
+
+std::shared_ptr<ASTProgram> FrontEnd::parse(std::istream &stream) {
+  ANTLRInputStream input(stream);
+  return parseCharStream(input);
+}
+
+std::shared_ptr<ASTProgram> FrontEnd::parse(std::string_view source) {
+  // Only text with other characters needs decoding into code points
+  if (AsciiCharStream::isAscii(source)) {
+    AsciiCharStream input(source);
+    return parseCharStream(input);
+  }
+  ANTLRInputStream input(source);
+  return parseCharStream(input);
+}
 
 void FrontEnd::prettyprint(ASTProgram *program, std::ostream &os) {
   PrettyPrinter::print(program, os, ' ', 2);
@@ -6,6 +6,7 @@
 
 #include <fstream>
 #include <iostream>
+#include <string_view>
 
 //! \brief Lexer error listener for redirecting ANTLR4 errors to ParseError.
 class LexerErrorListener : public antlr4::BaseErrorListener {
@@ -45,6 +46,17 @@ public:
    */
   static std::shared_ptr<ASTProgram> parse(std::istream &stream);
 
+  /*! \fn parse
+   *  \brief Parse program text held in memory and return an AST.
+   *
+   * ASCII text, the common case, is lexed where it is rather than being
+   * copied and decoded, so the text can be that of a memory-mapped file.
+   * Errors are reported as for streams.
+   * \param source the program text in UTF-8.
+   * \return the generated AST.
+   */
+  static std::shared_ptr<ASTProgram> parse(std::string_view source);
+
   /*! \fn print
    *  \brief Print program in a standard form to cout.
    *
@@ -1,8 +1,11 @@
 #include "ASTBuilder.h"
+#include "AsciiCharStream.h"
+#include "ParseError.h"
 
 #include "picosha2.h"
 
 #include "loguru.hpp"
+#include <climits>
 #include <functional>
 #include <vector>
 
@@ -75,16 +78,30 @@ std::string ASTBuilder::opString(int op)
 }
 
 /*
- * Globals for communicating information up from visited subtrees
- * These are overwritten by every visit call.
- * We use multiple variables here to avoid downcasting of shared smart pointers.
+ * The value of a number literal, which is reported as a parse error when it
+ * does not fit the int of an ASTNumberExpr.
  */
-static std::shared_ptr<ASTStmt> visitedStmt = nullptr;
-static std::shared_ptr<ASTDeclNode> visitedDeclNode = nullptr;
-static std::shared_ptr<ASTDeclStmt> visitedDeclStmt = nullptr;
-static std::shared_ptr<ASTExpr> visitedExpr = nullptr;
-static std::shared_ptr<ASTFieldExpr> visitedFieldExpr = nullptr;
-static std::shared_ptr<ASTFunction> visitedFunction = nullptr;
+int ASTBuilder::numberValue(antlr4::tree::TerminalNode *number, bool negative)
+{
+  auto text = number->getText();
+  try
+  {
+    long long val = std::stoll(text);
+    val = negative ? -val : val;
+    if (val >= INT_MIN && val <= INT_MAX)
+    {
+      return static_cast<int>(val);
+    }
+  }
+  catch (std::out_of_range &)
+  {
+  }
+
+  auto token = number->getSymbol();
+  throw ParseError("number out of range: " + std::string(negative ? "-" : "") +
+                   text + "@" + std::to_string(token->getLine()) + ":" +
+                   std::to_string(token->getCharPositionInLine()));
+}
 
 /**********************************************************************
  * These methods override selected methods in the TIPBaseVisitor.
@@ -104,7 +121,7 @@ static std::shared_ptr<ASTFunction> visitedFunction = nullptr;
  * be lost by the methods you don't override).  Instead you must create
  * your own structure that is local to the visitor to communicate between
  * the calls during the visit.  In the case of this visitor it is the
- * visitedX variables above.
+ * visitedX members of the class.
  *
  * Note that the visit methods are required to return a value, but
  * we make no use of that value, so we simply return the empty string ("")
@@ -125,7 +142,7 @@ std::shared_ptr<ASTProgram> ASTBuilder::build(TIPParser::ProgramContext *ctx)
   }
 
   auto prog = std::make_shared<ASTProgram>(pFunctions);
-  prog->setName(generateSHA256(ctx->getText()));
+  prog->setName(hashSource(ctx));
   return prog;
 }
 
@@ -177,13 +194,15 @@ Any ASTBuilder::visitFunction(TIPParser::FunctionContext *ctx)
   // Set source location
   visitedFunction->setLocation(ctx->getStart()->getLine(),
                                ctx->getStart()->getCharPositionInLine());
+
+  // Hash the source text, which identifies the code of the function
+  visitedFunction->setSourceHash(hashSource(ctx));
   return "";
 }
 
 Any ASTBuilder::visitNegNumber(TIPParser::NegNumberContext *ctx)
 {
-  int val = std::stoi(ctx->NUMBER()->getText());
-  val = -val;
+  int val = numberValue(ctx->NUMBER(), true);
   visitedExpr = std::make_shared<ASTNumberExpr>(val);
 
   LOG_S(1) << "Built AST node " << *visitedExpr;
@@ -302,7 +321,7 @@ Any ASTBuilder::visitParenExpr(TIPParser::ParenExprContext *ctx)
 
 Any ASTBuilder::visitNumExpr(TIPParser::NumExprContext *ctx)
 {
-  int val = std::stoi(ctx->NUMBER()->getText());
+  int val = numberValue(ctx->NUMBER(), false);
   visitedExpr = std::make_shared<ASTNumberExpr>(val);
 
   LOG_S(1) << "Built AST node " << *visitedExpr;
@@ -356,6 +375,18 @@ Any ASTBuilder::visitInputExpr(TIPParser::InputExprContext *ctx)
   return "";
 } // LCOV_EXCL_LINE
 
+Any ASTBuilder::visitClockExpr(TIPParser::ClockExprContext *ctx)
+{
+  visitedExpr = std::make_shared<ASTClockExpr>();
+
+  LOG_S(1) << "Built AST node " << *visitedExpr;
+
+  // Set source location
+  visitedExpr->setLocation(ctx->getStart()->getLine(),
+                           ctx->getStart()->getCharPositionInLine());
+  return "";
+} // LCOV_EXCL_LINE
+
 Any ASTBuilder::visitFunAppExpr(TIPParser::FunAppExprContext *ctx)
 {
   std::shared_ptr<ASTExpr> fExpr = nullptr;
@@ -796,7 +827,23 @@ Any ASTBuilder::visitUnaryStmt(TIPParser::UnaryStmtContext *ctx)
   return "";
 } // LCOV_EXCL_LINE
 
-std::string ASTBuilder::generateSHA256(std::string tohash)
+/*
+ * Hash the source text of a parse tree, from its first to its last token.
+ * Text read in place is hashed where it is rather than copied.
+ */
+std::string ASTBuilder::hashSource(antlr4::ParserRuleContext *ctx)
+{
+  auto *input = ctx->getStart()->getInputStream();
+  antlr4::misc::Interval interval(ctx->getStart()->getStartIndex(),
+                                  ctx->getStop()->getStopIndex());
+  if (auto *ascii = dynamic_cast<AsciiCharStream *>(input))
+  {
+    return generateSHA256(ascii->getView(interval));
+  }
+  return generateSHA256(input->getText(interval));
+}
+
+std::string ASTBuilder::generateSHA256(std::string_view tohash)
 {
   std::vector<unsigned char> hash(picosha2::k_digest_size);
   picosha2::hash256(tohash.begin(), tohash.end(), hash.begin(), hash.end());
@@ -7,6 +7,7 @@
 #include "antlr4-runtime.h"
 
 #include <string>
+#include <string_view>
 
 using namespace antlrcpp;
 
@@ -22,8 +23,25 @@ class ASTBuilder : public TIPBaseVisitor
 {
 private:
   TIPParser *parser;
+
+  /*
+   * Members for communicating information up from visited subtrees.
+   * These are overwritten by every visit call.  They are per builder, not
+   * static, so that programs can be parsed concurrently.
+   * We use multiple variables here to avoid downcasting of shared smart
+   * pointers.
+   */
+  std::shared_ptr<ASTStmt> visitedStmt = nullptr;
+  std::shared_ptr<ASTDeclNode> visitedDeclNode = nullptr;
+  std::shared_ptr<ASTDeclStmt> visitedDeclStmt = nullptr;
+  std::shared_ptr<ASTExpr> visitedExpr = nullptr;
+  std::shared_ptr<ASTFieldExpr> visitedFieldExpr = nullptr;
+  std::shared_ptr<ASTFunction> visitedFunction = nullptr;
+
   std::string opString(int op);
-  std::string generateSHA256(std::string tohash);
+  std::string generateSHA256(std::string_view tohash);
+  std::string hashSource(antlr4::ParserRuleContext *ctx);
+  int numberValue(antlr4::tree::TerminalNode *number, bool negative);
 
 public:
   ASTBuilder(TIPParser *parser);
@@ -63,6 +81,7 @@ public:
   Any visitBooleanExpr(TIPParser::BooleanExprContext *ctx) override;
   Any visitVarExpr(TIPParser::VarExprContext *ctx) override;
   Any visitInputExpr(TIPParser::InputExprContext *ctx) override;
+  Any visitClockExpr(TIPParser::ClockExprContext *ctx) override;
   Any visitFunAppExpr(TIPParser::FunAppExprContext *ctx) override;
   Any visitAllocExpr(TIPParser::AllocExprContext *ctx) override;
   Any visitRefExpr(TIPParser::RefExprContext *ctx) override;
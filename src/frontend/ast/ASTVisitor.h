@@ -41,6 +41,8 @@ public:
   virtual void endVisit(ASTIncDecStmt *element) {}
   virtual bool visit(ASTInputExpr *element) { return true; }
   virtual void endVisit(ASTInputExpr *element) {}
+  virtual bool visit(ASTClockExpr *element) { return true; }
+  virtual void endVisit(ASTClockExpr *element) {}
   virtual bool visit(ASTFunAppExpr *element) { return true; }
   virtual void endVisit(ASTFunAppExpr *element) {}
   virtual bool visit(ASTAllocExpr *element) { return true; }
@@ -0,0 +1,66 @@
+#include "AsciiCharStream.h"
+
+#include <algorithm>
+
+using namespace antlr4;
+
+AsciiCharStream::AsciiCharStream(std::string_view text) : text(text) {}
+
+bool AsciiCharStream::isAscii(std::string_view text) {
+  // The bits are accumulated without branching, which vectorizes
+  unsigned char bits = 0;
+  for (unsigned char c : text) {
+    bits |= c;
+  }
+  return bits < 0x80;
+}
+
+std::string_view
+AsciiCharStream::getView(const misc::Interval &interval) const {
+  if (interval.a < 0 || interval.b < interval.a ||
+      static_cast<size_t>(interval.a) >= text.size()) {
+    return {};
+  }
+  return text.substr(interval.a, interval.b - interval.a + 1);
+}
+
+void AsciiCharStream::consume() {
+  if (p >= text.size()) {
+    throw IllegalStateException("cannot consume EOF");
+  }
+  p++;
+}
+
+size_t AsciiCharStream::LA(ssize_t i) {
+  if (i == 0) {
+    return 0; // undefined
+  }
+
+  ssize_t position = static_cast<ssize_t>(p) + (i < 0 ? i : i - 1);
+  if (position < 0 || position >= static_cast<ssize_t>(text.size())) {
+    return IntStream::EOF;
+  }
+  return static_cast<unsigned char>(text[position]);
+}
+
+ssize_t AsciiCharStream::mark() { return -1; }
+
+void AsciiCharStream::release(ssize_t marker) {}
+
+size_t AsciiCharStream::index() { return p; }
+
+void AsciiCharStream::seek(size_t index) {
+  p = std::min(index, text.size());
+}
+
+size_t AsciiCharStream::size() { return text.size(); }
+
+std::string AsciiCharStream::getSourceName() const {
+  return IntStream::UNKNOWN_SOURCE_NAME;
+}
+
+std::string AsciiCharStream::getText(const misc::Interval &interval) {
+  return std::string(getView(interval));
+}
+
+std::string AsciiCharStream::toString() const { return std::string(text); }
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "antlr4-runtime.h"
+
+#include <string>
+#include <string_view>
+
+/*! \class AsciiCharStream
+ *  \brief An ANTLR4 character stream reading ASCII text in place.
+ *
+ * ANTLRInputStream decodes its input into a buffer of UTF-32 code points.
+ * The bytes of ASCII text are its code points, so this stream reads them
+ * where they are, e.g., in a memory-mapped file, and its indices are byte
+ * offsets into the text.  The text must outlive the stream and the tokens
+ * lexed from it.
+ */
+class AsciiCharStream : public antlr4::CharStream {
+public:
+  /*! \brief Create a stream over text.
+   * \param text The text, which must only hold ASCII characters.
+   */
+  explicit AsciiCharStream(std::string_view text);
+
+  /*! \brief Whether text only holds ASCII characters.
+   */
+  static bool isAscii(std::string_view text);
+
+  /*! \brief The text in an interval of the stream, without copying it.
+   * \param interval The indices of the first and last characters.
+   */
+  std::string_view getView(const antlr4::misc::Interval &interval) const;
+
+  void consume() override;
+  size_t LA(ssize_t i) override;
+  ssize_t mark() override;
+  void release(ssize_t marker) override;
+  size_t index() override;
+  void seek(size_t index) override;
+  size_t size() override;
+  std::string getSourceName() const override;
+  std::string getText(const antlr4::misc::Interval &interval) override;
+  std::string toString() const override;
+
+private:
+  std::string_view text;
+  size_t p = 0;
+};
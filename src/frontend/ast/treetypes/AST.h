@@ -27,6 +27,7 @@
 #include "ASTFunction.h"
 #include "ASTIfStmt.h"
 #include "ASTInputExpr.h"
+#include "ASTClockExpr.h"
 #include "ASTNode.h"
 #include "ASTNullExpr.h"
 #include "ASTNumberExpr.h"
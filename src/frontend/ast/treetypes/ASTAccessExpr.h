@@ -15,7 +15,7 @@ public:
   std::string getField() const { return FIELD; }
   ASTExpr *getRecord() const { return RECORD.get(); }
   void accept(ASTVisitor *visitor) override;
-  llvm::Value *codegen() override;
+  llvm::Value *codegen(CodeGenContext &ctx) override;
 
 protected:
   std::ostream &print(std::ostream &out) const override;
@@ -15,7 +15,7 @@ public:
     std::vector<ASTExpr *> getItems() const;
     int getLen() const { return LEN; };
     void accept(ASTVisitor *visitor) override;
-    llvm::Value *codegen() override;
+    llvm::Value *codegen(CodeGenContext &ctx) override;
 
 protected:
     std::ostream &print(std::ostream &out) const override;
@@ -17,7 +17,7 @@ public:
     ASTExpr *getLength() const { return LEN_EXPR.get(); }
     ASTExpr *getElement() const { return ELEMENT_EXPR.get(); }
     void accept(ASTVisitor *visitor) override;
-    llvm::Value *codegen() override;
+    llvm::Value *codegen(CodeGenContext &ctx) override;
 
 protected:
     std::ostream &print(std::ostream &out) const override;
@@ -17,7 +17,7 @@ public:
     ASTExpr *getArray() const { return ARRAY.get(); }
     ASTExpr *getIndex() const { return INDEX.get(); }
     void accept(ASTVisitor *visitor) override;
-    llvm::Value *codegen() override;
+    llvm::Value *codegen(CodeGenContext &ctx) override;
 
 protected:
     std::ostream &print(std::ostream &out) const override;
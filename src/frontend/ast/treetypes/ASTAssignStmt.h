@@ -16,7 +16,7 @@ public:
   ASTExpr *getLHS() const { return LHS.get(); }
   ASTExpr *getRHS() const { return RHS.get(); }
   void accept(ASTVisitor *visitor) override;
-  llvm::Value *codegen() override;
+  llvm::Value *codegen(CodeGenContext &ctx) override;
 
 protected:
   std::ostream &print(std::ostream &out) const override;
@@ -17,7 +17,7 @@ public:
   ASTExpr *getLeft() const { return LEFT.get(); }
   ASTExpr *getRight() const { return RIGHT.get(); }
   void accept(ASTVisitor *visitor) override;
-  llvm::Value *codegen() override;
+  llvm::Value *codegen(CodeGenContext &ctx) override;
 
 protected:
   std::ostream &print(std::ostream &out) const override;
@@ -14,7 +14,7 @@ public:
     int getValue() const { return VAL; }
     bool getBoolValue() const { return VAL; }
     void accept(ASTVisitor *visitor) override;
-    llvm::Value *codegen() override;
+    llvm::Value *codegen(CodeGenContext &ctx) override;
 
 protected:
     std::ostream &print(std::ostream &out) const override;
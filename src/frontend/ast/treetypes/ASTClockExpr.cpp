@@ -0,0 +1,12 @@
+#include "ASTClockExpr.h"
+#include "ASTVisitor.h"
+
+void ASTClockExpr::accept(ASTVisitor *visitor) {
+  visitor->visit(this);
+  visitor->endVisit(this);
+}
+
+std::ostream &ASTClockExpr::print(std::ostream &out) const {
+  out << "clock";
+  return out;
+}
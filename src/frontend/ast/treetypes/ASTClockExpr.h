@@ -0,0 +1,15 @@
+#pragma once
+
+#include "ASTExpr.h"
+
+/*! \brief Class for clock expression.
+ */
+class ASTClockExpr : public ASTExpr {
+public:
+  ASTClockExpr() {}
+  void accept(ASTVisitor *visitor) override;
+  llvm::Value *codegen(CodeGenContext &ctx) override;
+
+protected:
+  std::ostream &print(std::ostream &out) const override;
+};
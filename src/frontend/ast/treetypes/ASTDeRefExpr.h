@@ -12,7 +12,7 @@ public:
   ASTDeRefExpr(std::shared_ptr<ASTExpr> PTR) : PTR(PTR) {}
   ASTExpr *getPtr() const { return PTR.get(); }
   void accept(ASTVisitor *visitor) override;
-  llvm::Value *codegen() override;
+  llvm::Value *codegen(CodeGenContext &ctx) override;
 
 protected:
   std::ostream &print(std::ostream &out) const override;
@@ -13,7 +13,7 @@ public:
   ASTDeclStmt(std::vector<std::shared_ptr<ASTDeclNode>> VARS);
   std::vector<ASTDeclNode *> getVars() const;
   void accept(ASTVisitor *visitor) override;
-  llvm::Value *codegen() override;
+  llvm::Value *codegen(CodeGenContext &ctx) override;
 
 protected:
   std::ostream &print(std::ostream &out) const override;
@@ -22,7 +22,7 @@ public:
     ASTExpr *getStart() const { return START.get(); }
     ASTExpr *getEnd() const { return END.get(); }
     ASTExpr *getStep() const { return STEP.get(); }
-    llvm::Value *codegen() override;
+    llvm::Value *codegen(CodeGenContext &ctx) override;
 
 protected:
     std::ostream &print(std::ostream &out) const override;
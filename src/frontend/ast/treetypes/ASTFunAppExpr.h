@@ -15,7 +15,7 @@ public:
   ASTExpr *getFunction() const { return FUN.get(); }
   std::vector<ASTExpr *> getActuals() const;
   void accept(ASTVisitor *visitor) override;
-  llvm::Value *codegen() override;
+  llvm::Value *codegen(CodeGenContext &ctx) override;
 
 protected:
   std::ostream &print(std::ostream &out) const override;
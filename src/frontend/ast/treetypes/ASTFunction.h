@@ -14,6 +14,7 @@ class ASTFunction : public ASTNode {
   std::vector<std::shared_ptr<ASTDeclStmt>> DECLS;
   std::vector<std::shared_ptr<ASTStmt>> BODY;
   bool ISPOLY;
+  std::string HASH;
 
 public:
   std::vector<std::shared_ptr<ASTNode>> getChildren() override;
@@ -27,11 +28,18 @@ public:
   ASTDeclNode *getDecl() const { return DECL.get(); };
   std::string getName() const { return DECL->getName(); };
   bool isPoly() const { return ISPOLY; };
+
+  /*! \brief The hash of the source text of the function.
+   *
+   * It is set when the AST is built from source and is empty otherwise.
+   */
+  std::string getSourceHash() const { return HASH; };
+  void setSourceHash(std::string h) { HASH = h; };
   std::vector<ASTDeclNode *> getFormals() const;
   std::vector<ASTDeclStmt *> getDeclarations() const;
   std::vector<ASTStmt *> getStmts() const;
   void accept(ASTVisitor *visitor) override;
-  llvm::Value *codegen() override;
+  llvm::Value *codegen(CodeGenContext &ctx) override;
 
 protected:
   std::ostream &print(std::ostream &out) const override;
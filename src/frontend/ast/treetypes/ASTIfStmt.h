@@ -22,7 +22,7 @@ public:
    */
   ASTStmt *getElse() const { return ELSE.get(); }
   void accept(ASTVisitor *visitor) override;
-  llvm::Value *codegen() override;
+  llvm::Value *codegen(CodeGenContext &ctx) override;
 
 protected:
   std::ostream &print(std::ostream &out) const override;
@@ -17,7 +17,7 @@ public:
   ASTExpr *getExpr() const { return EXPR.get(); }
   std::string getOp() const { return OP; }
   void accept(ASTVisitor *visitor) override;
-  llvm::Value *codegen() override;
+  llvm::Value *codegen(CodeGenContext &ctx) override;
 
 protected:
   std::ostream &print(std::ostream &out) const override;
@@ -8,7 +8,7 @@ class ASTInputExpr : public ASTExpr {
 public:
   ASTInputExpr() {}
   void accept(ASTVisitor *visitor) override;
-  llvm::Value *codegen() override;
+  llvm::Value *codegen(CodeGenContext &ctx) override;
 
 protected:
   std::ostream &print(std::ostream &out) const override;
@@ -18,7 +18,7 @@ public:
     ASTStmt *getBody() const { return BODY.get(); }
     ASTExpr *getElement() const { return ELEMENT.get(); }
     ASTExpr *getIterable() const { return ITERABLE.get(); }
-    llvm::Value *codegen() override;
+    llvm::Value *codegen(CodeGenContext &ctx) override;
 
 protected:
     std::ostream &print(std::ostream &out) const override;
@@ -10,6 +10,7 @@
 
 // Forward declare the visitor to resolve circular dependency
 class ASTVisitor;
+class CodeGenContext;
 
 /*! \brief Abstract base class for all AST nodes.
  *
@@ -59,9 +60,10 @@ public:
    * due to the fact that a high-degree of control on the ordering of the
    * nodes is required.
    *
+   * \param ctx The state of the code generation for the enclosing program.
    * \return LLVM value holding an representation of the generated code.
    */
-  virtual llvm::Value *codegen() = 0;
+  virtual llvm::Value *codegen(CodeGenContext &ctx) = 0;
 
   /*! \fn getChildren
    *  \brief Return all of the children for the node.
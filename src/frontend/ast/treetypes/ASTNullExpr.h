@@ -8,7 +8,7 @@ class ASTNullExpr : public ASTExpr {
 public:
   ASTNullExpr() {}
   void accept(ASTVisitor *visitor) override;
-  llvm::Value *codegen() override;
+  llvm::Value *codegen(CodeGenContext &ctx) override;
 
 protected:
   std::ostream &print(std::ostream &out) const override;
@@ -13,7 +13,7 @@ public:
   ASTOutputStmt(std::shared_ptr<ASTExpr> ARG) : ARG(ARG) {}
   ASTExpr *getArg() const { return ARG.get(); }
   void accept(ASTVisitor *visitor) override;
-  llvm::Value *codegen() override;
+  llvm::Value *codegen(CodeGenContext &ctx) override;
 
 protected:
   std::ostream &print(std::ostream &out) const override;
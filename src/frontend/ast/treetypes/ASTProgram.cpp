@@ -47,6 +47,6 @@ std::vector<std::shared_ptr<ASTNode>> ASTProgram::getChildren() {
 /* This function is never called because a custom code generation
  * routine, which accepts additional arguments, is defined for programs.
  */
-llvm::Value *ASTProgram::codegen() { // LCOV_EXCL_LINE
+llvm::Value *ASTProgram::codegen(CodeGenContext &ctx) { // LCOV_EXCL_LINE
   assert(0);                         // LCOV_EXCL_LINE
 } // LCOV_EXCL_LINE
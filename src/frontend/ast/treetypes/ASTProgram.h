@@ -20,10 +20,13 @@ public:
   std::vector<ASTFunction *> getFunctions() const;
   ASTFunction *findFunctionByName(std::string);
   void accept(ASTVisitor *visitor) override;
-  std::shared_ptr<llvm::Module> codegen(SemanticAnalysis *st, const std::string& name);
+  std::shared_ptr<llvm::Module> codegen(SemanticAnalysis *st, const std::string& name,
+                                        unsigned jobs = 1);
+  std::shared_ptr<llvm::Module> codegen(CodeGenContext &ctx, SemanticAnalysis *st,
+                                        const std::string &name, unsigned jobs = 1);
 
 private:
-  llvm::Value *codegen() override;
+  llvm::Value *codegen(CodeGenContext &ctx) override;
 
 public:
   friend std::ostream &operator<<(std::ostream &os, const ASTProgram &obj) {
@@ -13,7 +13,7 @@ public:
   ASTRecordExpr(std::vector<std::shared_ptr<ASTFieldExpr>> FIELDS);
   std::vector<ASTFieldExpr *> getFields() const;
   void accept(ASTVisitor *visitor) override;
-  llvm::Value *codegen() override;
+  llvm::Value *codegen(CodeGenContext &ctx) override;
 
 protected:
   std::ostream &print(std::ostream &out) const override;
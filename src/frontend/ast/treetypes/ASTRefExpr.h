@@ -12,7 +12,7 @@ public:
   ASTRefExpr(std::shared_ptr<ASTExpr> VAR) : VAR(VAR) {}
   ASTExpr *getVar() const { return VAR.get(); }
   void accept(ASTVisitor *visitor) override;
-  llvm::Value *codegen() override;
+  llvm::Value *codegen(CodeGenContext &ctx) override;
 
 protected:
   std::ostream &print(std::ostream &out) const override;
@@ -17,7 +17,7 @@ public:
     ASTExpr *getTrueExpr() const { return TRUEEXPR.get(); }
     ASTExpr *getFalseExpr() const { return FALSEEXPR.get(); }
     void accept(ASTVisitor *visitor) override;
-    llvm::Value *codegen() override;
+    llvm::Value *codegen(CodeGenContext &ctx) override;
 
 protected:
     std::ostream &print(std::ostream &out) const override;
@@ -16,7 +16,7 @@ public:
   std::string getOp() const { return OP; }
   ASTExpr *getExpr() const { return EXPR.get(); }
   void accept(ASTVisitor *visitor) override;
-  llvm::Value *codegen() override;
+  llvm::Value *codegen(CodeGenContext &ctx) override;
 
 protected:
   std::ostream &print(std::ostream &out) const override;
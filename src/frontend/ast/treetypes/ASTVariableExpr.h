@@ -11,7 +11,7 @@ public:
   ASTVariableExpr(std::string NAME) : NAME(NAME) {}
   std::string getName() const { return NAME; }
   void accept(ASTVisitor *visitor) override;
-  llvm::Value *codegen() override;
+  llvm::Value *codegen(CodeGenContext &ctx) override;
 
 protected:
   std::ostream &print(std::ostream &out) const override;
@@ -16,7 +16,7 @@ public:
   ASTExpr *getCondition() const { return COND.get(); }
   ASTStmt *getBody() const { return BODY.get(); }
   void accept(ASTVisitor *visitor) override;
-  llvm::Value *codegen() override;
+  llvm::Value *codegen(CodeGenContext &ctx) override;
 
 protected:
   std::ostream &print(std::ostream &out) const override;
@@ -130,6 +130,11 @@ void PrettyPrinter::endVisit(ASTInputExpr *element)
   visitResults.push_back("input");
 }
 
+void PrettyPrinter::endVisit(ASTClockExpr *element)
+{
+  visitResults.push_back("clock");
+}
+
 void PrettyPrinter::endVisit(ASTFunAppExpr *element)
 {
   auto actualsString =
@@ -37,6 +37,7 @@ public:
   virtual void endVisit(ASTBinaryExpr *element) override;
   virtual void endVisit(ASTUnaryExpr *element) override;
   virtual void endVisit(ASTInputExpr *element) override;
+  virtual void endVisit(ASTClockExpr *element) override;
   virtual void endVisit(ASTFunAppExpr *element) override;
   virtual void endVisit(ASTAllocExpr *element) override;
   virtual void endVisit(ASTRefExpr *element) override;
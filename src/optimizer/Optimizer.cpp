@@ -1,6 +1,29 @@
 #include "Optimizer.h"
+#include "CompileCache.h"
+#include "InternalError.h"
+#include "Parallel.h"
 
+#include "llvm/ADT/EquivalenceClasses.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SetVector.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/Analysis/ConstantFolding.h"
+#include "llvm/Bitcode/BitcodeReader.h"
+#include "llvm/Bitcode/BitcodeWriter.h"
+#include "llvm/IR/InstIterator.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/MC/MCSubtargetInfo.h"
+#include "llvm/MC/TargetRegistry.h"
 #include "llvm/Passes/PassBuilder.h"
+#include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Support/xxhash.h"
+#include "llvm/Target/TargetMachine.h"
+#include "llvm/Target/TargetOptions.h"
+#include "llvm/TargetParser/Host.h"
+#include "llvm/Transforms/IPO/GlobalDCE.h"
+#include "llvm/Transforms/Utils/Cloning.h"
+#include "llvm/Transforms/Utils/ValueMapper.h"
 
 #include "llvm/Transforms/InstCombine/InstCombine.h"
 #include "llvm/Transforms/Scalar/GVN.h"
@@ -10,12 +33,55 @@
 
 #include "loguru.hpp"
 
-//  Minimal optimization pass using LLVM pass managers
-void Optimizer::optimize(llvm::Module *theModule) {
-  LOG_S(1) << "Optimizing program " << theModule->getName().str();
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <set>
+
+namespace {
+
+/*
+ * Create a target machine for the triple of the module, which provides the
+ * optimizer with the cost model of the target.  The CPU of each function is
+ * taken from its attributes.
+ */
+const llvm::Target *lookupTarget(const std::string &triple) {
+  // Registration is not thread safe, so the target is registered only once
+  static const bool initialized = llvm::InitializeNativeTarget();
+  (void)initialized;
+
+  std::string error;
+  auto *target = llvm::TargetRegistry::lookupTarget(triple, error);
+  if (target == nullptr) {
+    throw InternalError("no target for " + triple + ": " + error);
+  }
+  return target;
+}
+
+std::unique_ptr<llvm::TargetMachine>
+createTargetMachine(const llvm::Module &theModule) {
+  auto triple = theModule.getTargetTriple();
+  auto *target = lookupTarget(triple);
+  return std::unique_ptr<llvm::TargetMachine>(target->createTargetMachine(
+      triple, "", "", llvm::TargetOptions(), llvm::Reloc::PIC_));
+}
+
+//  Optimization pass using LLVM pass managers
+void runPipeline(llvm::Module &theModule, int level,
+                 const std::string &passes) {
+  // The basic passes do not depend on the target
+  std::unique_ptr<llvm::TargetMachine> machine;
+  if (level != Optimizer::BASIC || !passes.empty()) {
+    machine = createTargetMachine(theModule);
+  }
+
+  // Loops are vectorized from level 2 on, as by clang and opt
+  llvm::PipelineTuningOptions tuning;
+  tuning.LoopVectorization = level >= 2;
+  tuning.SLPVectorization = level >= 2;
 
   // New pass builder
-  llvm::PassBuilder passBuilder;
+  llvm::PassBuilder passBuilder(machine.get(), tuning);
 
   // Setting-up Analysis Managers for different granularities of optimizations
   llvm::FunctionAnalysisManager functionAnalysisManager;
@@ -37,27 +103,566 @@ void Optimizer::optimize(llvm::Module *theModule) {
   llvm::ModulePassManager modulePassManager;
   llvm::FunctionPassManager functionPassManager;
 
-  // Adding passes to the pipeline
+  if (!passes.empty()) {
+    // The pipeline has been checked by the driver
+    llvm::cantFail(passBuilder.parsePassPipeline(modulePassManager, passes));
+  } else if (level == 0) {
+    modulePassManager =
+        passBuilder.buildO0DefaultPipeline(llvm::OptimizationLevel::O0);
+  } else if (level != Optimizer::BASIC) {
+    const llvm::OptimizationLevel levels[] = {
+        llvm::OptimizationLevel::O1, llvm::OptimizationLevel::O2,
+        llvm::OptimizationLevel::O3};
+    modulePassManager =
+        passBuilder.buildPerModuleDefaultPipeline(levels[level - 1]);
+  } else {
+    // Adding passes to the pipeline
 
-  // Constructs SSA and is a pre-requisite for many other passes
-  functionPassManager.addPass(llvm::PromotePass());
+    // Constructs SSA and is a pre-requisite for many other passes
+    functionPassManager.addPass(llvm::PromotePass());
 
-  // Instruction combine pass scans for a variety of patterns and replaces bitcodes matched with improvements.
-  functionPassManager.addPass(llvm::InstCombinePass());
+    // Instruction combine pass scans for a variety of patterns and replaces bitcodes matched with improvements.
+    functionPassManager.addPass(llvm::InstCombinePass());
 
-  // Reassociate expressions.
-  functionPassManager.addPass(llvm::ReassociatePass());
+    // Reassociate expressions.
+    functionPassManager.addPass(llvm::ReassociatePass());
 
-  // Eliminate Common SubExpressions using the Global Value Numbering (GVN) algorithm.
-  functionPassManager.addPass(llvm::GVNPass());
+    // Eliminate Common SubExpressions using the Global Value Numbering (GVN) algorithm.
+    functionPassManager.addPass(llvm::GVNPass());
 
-  // Simplify the control flow graph (deleting unreachable blocks, etc).
-  functionPassManager.addPass(llvm::SimplifyCFGPass());
+    // Simplify the control flow graph (deleting unreachable blocks, etc).
+    functionPassManager.addPass(llvm::SimplifyCFGPass());
 
-  // Passing the function pass manager to the modulePassManager using a function
-  // adaptor, then passing theModule to the ModulePassManager along with
+    // Passing the function pass manager to the modulePassManager using a
+    // function adaptor.
+    modulePassManager.addPass(
+        createModuleToFunctionPassAdaptor(std::move(functionPassManager)));
+  }
+
+  // Passing theModule to the ModulePassManager along with
   // ModuleAnalysisManager.
-  modulePassManager.addPass(
-      createModuleToFunctionPassAdaptor(std::move(functionPassManager)));
-  modulePassManager.run(*theModule, moduleAnalysisManager);
+  modulePassManager.run(theModule, moduleAnalysisManager);
+}
+
+/*
+ * Add the defined functions that the value refers to, looking through
+ * constant expressions but not through global variables.
+ */
+void addReferences(llvm::Value *value,
+                   llvm::SetVector<llvm::Function *> &references) {
+  if (auto *callee = llvm::dyn_cast<llvm::Function>(value)) {
+    if (!callee->isDeclaration()) {
+      references.insert(callee);
+    }
+  } else if (auto *constant = llvm::dyn_cast<llvm::Constant>(value)) {
+    if (!llvm::isa<llvm::GlobalValue>(constant)) {
+      for (auto &operand : constant->operands()) {
+        addReferences(operand, references);
+      }
+    }
+  }
+}
+
+/*
+ * The defined functions that fn refers to directly.  A function loaded from
+ * a constant address, e.g., the callee of a call through the function
+ * dispatch table, counts as a direct reference.
+ */
+llvm::SetVector<llvm::Function *> directReferences(llvm::Function &fn) {
+  llvm::SetVector<llvm::Function *> references;
+  for (auto &inst : llvm::instructions(fn)) {
+    if (auto *load = llvm::dyn_cast<llvm::LoadInst>(&inst)) {
+      if (auto *address =
+              llvm::dyn_cast<llvm::Constant>(load->getPointerOperand())) {
+        if (auto *loaded = llvm::ConstantFoldLoadFromConstPtr(
+                address, load->getType(), fn.getParent()->getDataLayout())) {
+          addReferences(loaded, references);
+        }
+      }
+    }
+    for (auto &operand : inst.operands()) {
+      addReferences(operand, references);
+    }
+  }
+  return references;
+}
+
+/*
+ * Join the functions of each strongly connected component of the reference
+ * graph, i.e., the functions that call one another recursively, in
+ * Tarjan's algorithm.  The walk keeps its own stack, as call chains may be
+ * deeper than the stack of the thread.
+ */
+void clusterCycles(
+    const std::vector<llvm::Function *> &functions,
+    std::map<llvm::Function *, llvm::SetVector<llvm::Function *>> &references,
+    llvm::EquivalenceClasses<llvm::Function *> &clusters) {
+  unsigned counter = 0;
+  std::map<llvm::Function *, unsigned> index;
+  std::map<llvm::Function *, unsigned> lowlink;
+  std::vector<llvm::Function *> stack;
+  std::set<llvm::Function *> onStack;
+  auto visit = [&](llvm::Function *fn) {
+    index[fn] = lowlink[fn] = counter++;
+    stack.push_back(fn);
+    onStack.insert(fn);
+  };
+
+  for (auto *root : functions) {
+    if (index.count(root) != 0) {
+      continue;
+    }
+    // Each frame holds a function and the position of its next reference
+    std::vector<std::pair<llvm::Function *, std::size_t>> frames{{root, 0}};
+    visit(root);
+    while (!frames.empty()) {
+      auto *fn = frames.back().first;
+      auto &callees = references[fn];
+      if (frames.back().second < callees.size()) {
+        auto *callee = callees[frames.back().second++];
+        if (index.count(callee) == 0) {
+          visit(callee);
+          frames.emplace_back(callee, 0);
+        } else if (onStack.count(callee) != 0) {
+          lowlink[fn] = std::min(lowlink[fn], index[callee]);
+        }
+        continue;
+      }
+
+      if (lowlink[fn] == index[fn]) {
+        llvm::Function *member;
+        do {
+          member = stack.back();
+          stack.pop_back();
+          onStack.erase(member);
+          clusters.unionSets(fn, member);
+        } while (member != fn);
+      }
+      frames.pop_back();
+      if (!frames.empty()) {
+        auto *caller = frames.back().first;
+        lowlink[caller] = std::min(lowlink[caller], lowlink[fn]);
+      }
+    }
+  }
+}
+
+/*
+ * Copy the given functions of the module into a module of their own, which is
+ * returned as bitcode.  The other functions are only declared.  Constant
+ * global variables are copied as available_externally definitions, so that
+ * the optimizer can still fold loads from them, e.g., from the function
+ * dispatch table; the others are declared.  The functions are external in
+ * the partition, so that interprocedural passes neither remove them nor
+ * change their signatures.  The order of use lists is kept so that the
+ * optimized code does not depend on the partitioning.
+ */
+llvm::SmallVector<char, 0>
+extractPartition(llvm::Module &theModule,
+                 const std::vector<llvm::Function *> &functions) {
+  std::set<const llvm::GlobalValue *> members(functions.begin(),
+                                              functions.end());
+  llvm::ValueToValueMapTy map;
+  auto partition = llvm::CloneModule(
+      theModule, map, [&](const llvm::GlobalValue *value) {
+        if (auto *variable = llvm::dyn_cast<llvm::GlobalVariable>(value)) {
+          return variable->isConstant();
+        }
+        return members.count(value) != 0;
+      });
+  for (auto &variable : partition->globals()) {
+    if (variable.hasInitializer()) {
+      variable.setLinkage(llvm::GlobalValue::AvailableExternallyLinkage);
+    }
+  }
+  for (auto &fn : *partition) {
+    if (!fn.isDeclaration()) {
+      fn.setLinkage(llvm::GlobalValue::ExternalLinkage);
+    }
+  }
+
+  llvm::SmallVector<char, 0> bitcode;
+  llvm::raw_svector_ostream stream(bitcode);
+  llvm::WriteBitcodeToFile(*partition, stream, true);
+  return bitcode;
+}
+
+/*
+ * Maps the struct types of a partition that has been read back into the
+ * context of the module to the struct types of the module, which they
+ * duplicate under a name with a numeric suffix.
+ */
+class PartitionTypeRemapper : public llvm::ValueMapTypeRemapper {
+  const std::map<std::string, llvm::StructType *> &types;
+
+public:
+  explicit PartitionTypeRemapper(
+      const std::map<std::string, llvm::StructType *> &types)
+      : types(types) {}
+
+  llvm::Type *remapType(llvm::Type *type) override {
+    auto *structType = llvm::dyn_cast<llvm::StructType>(type);
+    if (structType == nullptr || !structType->hasName()) {
+      return type;
+    }
+    auto name = structType->getName().rsplit('.');
+    if (name.second.empty() || !llvm::all_of(name.second, llvm::isDigit)) {
+      return type;
+    }
+    auto original = types.find(name.first.str());
+    if (original != types.end() &&
+        original->second->isLayoutIdentical(structType)) {
+      return original->second;
+    }
+    return type;
+  }
+};
+
+/*
+ * Move the bodies of the functions defined in the optimized partition into
+ * the corresponding functions of the module, remapping the references to
+ * globals and types of the partition to those of the module.  Globals that
+ * the optimizer added to the partition are added to the module; local ones
+ * are renamed if another partition added a global of the same name.
+ */
+void replaceBodies(llvm::Module &theModule, llvm::Module &optimized,
+                   const std::set<std::string> &names,
+                   const std::map<std::string, llvm::StructType *> &types) {
+  PartitionTypeRemapper remapper(types);
+  llvm::ValueToValueMapTy map;
+  std::vector<llvm::GlobalVariable *> added;
+  for (auto &value : optimized.global_values()) {
+    auto name = value.getName().str();
+    llvm::GlobalValue *original = nullptr;
+    if (!value.hasLocalLinkage() || names.count(name) != 0) {
+      original = theModule.getNamedValue(name);
+    }
+    if (original != nullptr) {
+      map[&value] = original;
+      continue;
+    }
+
+    // Globals added by the optimizer, e.g., declarations of intrinsics
+    if (auto *fn = llvm::dyn_cast<llvm::Function>(&value)) {
+      auto *copy = llvm::Function::Create(fn->getFunctionType(),
+                                          fn->getLinkage(), name, theModule);
+      copy->copyAttributesFrom(fn);
+      original = copy;
+    } else if (auto *variable = llvm::dyn_cast<llvm::GlobalVariable>(&value)) {
+      auto *copy = new llvm::GlobalVariable(
+          theModule, remapper.remapType(variable->getValueType()),
+          variable->isConstant(), variable->getLinkage(), nullptr, name,
+          nullptr, variable->getThreadLocalMode(),
+          variable->getAddressSpace());
+      copy->copyAttributesFrom(variable);
+      added.push_back(variable);
+      original = copy;
+    } else {
+      throw InternalError("unexpected global " + name + " in partition");
+    }
+    map[&value] = original;
+  }
+
+  for (auto *variable : added) {
+    if (variable->hasInitializer()) {
+      llvm::cast<llvm::GlobalVariable>(map[variable])
+          ->setInitializer(llvm::MapValue(variable->getInitializer(), map,
+                                          llvm::RF_None, &remapper));
+    }
+  }
+
+  for (auto &fn : optimized) {
+    if (fn.isDeclaration()) {
+      continue;
+    }
+    auto *original = llvm::cast<llvm::Function>(map[&fn]);
+    auto linkage = original->getLinkage();
+    original->deleteBody();
+    original->setLinkage(linkage);
+    original->setAttributes(fn.getAttributes());
+    auto arg = original->arg_begin();
+    for (auto &param : fn.args()) {
+      map[&param] = &*arg++;
+    }
+    original->splice(original->end(), &fn);
+    llvm::RemapFunction(*original, map, llvm::RF_IgnoreMissingLocals,
+                        &remapper);
+  }
+}
+
+// Remove the globals that are not referred to, as GlobalDCE does in -O1 on
+void removeUnusedGlobals(llvm::Module &theModule) {
+  llvm::PassBuilder passBuilder;
+  llvm::FunctionAnalysisManager functionAnalysisManager;
+  llvm::ModuleAnalysisManager moduleAnalysisManager;
+  llvm::LoopAnalysisManager loopAnalysisManager;
+  llvm::CGSCCAnalysisManager cgsccAnalysisManager;
+  passBuilder.registerModuleAnalyses(moduleAnalysisManager);
+  passBuilder.registerCGSCCAnalyses(cgsccAnalysisManager);
+  passBuilder.registerFunctionAnalyses(functionAnalysisManager);
+  passBuilder.registerLoopAnalyses(loopAnalysisManager);
+  passBuilder.crossRegisterProxies(loopAnalysisManager, functionAnalysisManager,
+                                   cgsccAnalysisManager, moduleAnalysisManager);
+
+  llvm::ModulePassManager modulePassManager;
+  modulePassManager.addPass(llvm::GlobalDCEPass());
+  modulePassManager.run(theModule, moduleAnalysisManager);
+}
+
+} // namespace
+
+/*
+ * As in LLVM's SplitModule, functions are clustered along the call graph and
+ * the clusters are assigned, largest first, to the partition with the fewest
+ * instructions.  Functions that call one another recursively are always
+ * clustered.  A caller and its callee are only clustered while their cluster
+ * stays within an even share of the instructions, as otherwise every
+ * function reachable from main would end up in a single partition.
+ *
+ * Stable partitions only cluster recursive functions, as the share changes
+ * with every function, and assign clusters by the hash of the name of their
+ * first function, so that a change to a function only changes the contents
+ * of its own partition.
+ */
+std::vector<std::vector<llvm::Function *>>
+Optimizer::partition(llvm::Module *theModule, std::size_t count,
+                     bool stable) {
+  std::vector<llvm::Function *> functions;
+  std::map<llvm::Function *, llvm::SetVector<llvm::Function *>> references;
+  llvm::EquivalenceClasses<llvm::Function *> clusters;
+  std::size_t total = 0;
+  for (auto &fn : *theModule) {
+    if (!fn.isDeclaration()) {
+      functions.push_back(&fn);
+      references[&fn] = directReferences(fn);
+      clusters.insert(&fn);
+      total += fn.getInstructionCount();
+    }
+  }
+  clusterCycles(functions, references, clusters);
+
+  // The sizes of the clusters, by their leaders
+  std::map<llvm::Function *, std::size_t> clusterSizes;
+  for (auto *fn : functions) {
+    clusterSizes[clusters.getLeaderValue(fn)] += fn->getInstructionCount();
+  }
+  if (!stable && count > 1) {
+    auto share = (total + count - 1) / count;
+    for (auto *fn : functions) {
+      for (auto *callee : references[fn]) {
+        auto *caller = clusters.getLeaderValue(fn);
+        auto *other = clusters.getLeaderValue(callee);
+        auto size = clusterSizes[caller] + clusterSizes[other];
+        if (caller != other && size <= share) {
+          clusters.unionSets(caller, other);
+          clusterSizes[clusters.getLeaderValue(fn)] = size;
+        }
+      }
+    }
+  }
+
+  // Clusters in the order of their first function, with their sizes
+  std::map<llvm::Function *, std::size_t> clusterIndex;
+  std::vector<std::pair<std::size_t, std::vector<llvm::Function *>>> ordered;
+  for (auto *fn : functions) {
+    auto leader = clusters.getLeaderValue(fn);
+    auto found = clusterIndex.emplace(leader, ordered.size());
+    if (found.second) {
+      ordered.emplace_back();
+    }
+    auto &cluster = ordered[found.first->second];
+    cluster.first += fn->getInstructionCount();
+    cluster.second.push_back(fn);
+  }
+  std::stable_sort(
+      ordered.begin(), ordered.end(),
+      [](const auto &a, const auto &b) { return a.first > b.first; });
+
+  std::vector<std::vector<llvm::Function *>> partitions(
+      std::min<std::size_t>(count, ordered.size()));
+  if (stable) {
+    for (auto &cluster : ordered) {
+      auto &members = partitions[llvm::xxHash64(cluster.second[0]->getName()) %
+                                 partitions.size()];
+      members.insert(members.end(), cluster.second.begin(),
+                     cluster.second.end());
+    }
+    partitions.erase(std::remove_if(partitions.begin(), partitions.end(),
+                                    [](const auto &members) {
+                                      return members.empty();
+                                    }),
+                     partitions.end());
+    return partitions;
+  }
+
+  std::vector<std::size_t> sizes(partitions.size(), 0);
+  for (auto &cluster : ordered) {
+    auto smallest =
+        std::min_element(sizes.begin(), sizes.end()) - sizes.begin();
+    sizes[smallest] += cluster.first;
+    auto &members = partitions[smallest];
+    members.insert(members.end(), cluster.second.begin(),
+                   cluster.second.end());
+  }
+  return partitions;
+}
+
+void Optimizer::optimize(llvm::Module *theModule, unsigned jobs, int level,
+                         const std::string &passes,
+                         const std::string &cacheDirectory) {
+  LOG_S(1) << "Optimizing program " << theModule->getName().str();
+
+  // Partitions inherit the data layout of the target
+  if (level != BASIC || !passes.empty()) {
+    auto machine = createTargetMachine(*theModule);
+    theModule->setDataLayout(machine->createDataLayout());
+  }
+
+  if (jobs == 0) {
+    jobs = Parallel::hardwareJobs();
+  }
+
+  /*
+   * Only the basic passes transform each function on its own, so that the
+   * code does not depend on the partitions; the partitions of the other
+   * pipelines are not cached, as a cache must not change the code.  With a
+   * cache, partitions of about the square root of the number of functions
+   * balance the cost of extracting them against the work saved when a
+   * function changes.
+   */
+  bool cached = !cacheDirectory.empty() && level == BASIC && passes.empty();
+  std::size_t count = jobs;
+  if (cached) {
+    auto functions = std::count_if(
+        theModule->begin(), theModule->end(),
+        [](const llvm::Function &fn) { return !fn.isDeclaration(); });
+    count = std::max<std::size_t>(
+        jobs, std::ceil(std::sqrt(static_cast<double>(functions))));
+  }
+  auto partitions = partition(theModule, count, cached);
+  if (partitions.size() <= 1 && !cached) {
+    runPipeline(*theModule, level, passes);
+    return;
+  }
+
+  LOG_S(1) << "Optimizing " << partitions.size()
+           << " partitions of the program concurrently";
+
+  std::set<std::string> names;
+  for (auto &value : theModule->global_values()) {
+    names.insert(value.getName().str());
+  }
+  std::map<std::string, llvm::StructType *> types;
+  for (auto *type : theModule->getIdentifiedStructTypes()) {
+    types[type->getName().str()] = type;
+  }
+
+  std::vector<llvm::SmallVector<char, 0>> bitcode;
+  for (auto &functions : partitions) {
+    bitcode.push_back(extractPartition(*theModule, functions));
+  }
+
+  // Each partition is optimized in an LLVM context of its own
+  CompileCache cache(cacheDirectory);
+  std::vector<std::string> settings{std::to_string(level), passes};
+  Parallel::forEach(jobs, partitions.size(), [&](std::size_t i) {
+    std::string key;
+    if (cached) {
+      key = CompileCache::key(
+          std::string_view(bitcode[i].data(), bitcode[i].size()), settings);
+      std::string optimized;
+      if (cache.load(key, optimized)) {
+        LOG_S(1) << "Using cached code for partition " << i;
+        bitcode[i].assign(optimized.begin(), optimized.end());
+        return;
+      }
+    }
+
+    llvm::LLVMContext context;
+    auto partition = llvm::cantFail(llvm::parseBitcodeFile(
+        llvm::MemoryBufferRef(
+            llvm::StringRef(bitcode[i].data(), bitcode[i].size()), ""),
+        context));
+    runPipeline(*partition, level, passes);
+    bitcode[i].clear();
+    llvm::raw_svector_ostream stream(bitcode[i]);
+    llvm::WriteBitcodeToFile(*partition, stream, true);
+
+    if (cached) {
+      cache.save(key, std::string_view(bitcode[i].data(), bitcode[i].size()));
+    }
+  });
+
+  // The optimized bodies replace the original ones
+  for (std::size_t i = 0; i < partitions.size(); i++) {
+    auto optimized = llvm::cantFail(llvm::parseBitcodeFile(
+        llvm::MemoryBufferRef(
+            llvm::StringRef(bitcode[i].data(), bitcode[i].size()), ""),
+        theModule->getContext()));
+    replaceBodies(*theModule, *optimized, names, types);
+  }
+
+  /*
+   * The partitions keep their functions for the other partitions, so those
+   * the levels from 1 on would remove from the whole module are removed now.
+   */
+  if (level >= 1 && passes.empty()) {
+    removeUnusedGlobals(*theModule);
+  }
+}
+
+std::string Optimizer::checkPasses(const std::string &passes) {
+  llvm::PassBuilder passBuilder;
+  llvm::ModulePassManager modulePassManager;
+  if (auto error = passBuilder.parsePassPipeline(modulePassManager, passes)) {
+    return llvm::toString(std::move(error));
+  }
+  return "";
+}
+
+// Programs are compiled for the host, so the CPU must be one of its target
+std::string Optimizer::checkCPU(const std::string &cpu) {
+  if (cpu.empty() || cpu == "native") {
+    return "";
+  }
+  auto triple = llvm::sys::getProcessTriple();
+  std::unique_ptr<llvm::MCSubtargetInfo> subtarget(
+      lookupTarget(triple)->createMCSubtargetInfo(triple, "", ""));
+  if (!subtarget->isCPUStringValid(cpu)) {
+    return "unknown CPU '" + cpu + "' for " + triple;
+  }
+  return "";
+}
+
+/*
+ * The host CPU may lack some features of its model, e.g., in a virtual
+ * machine, so they are passed along with its name.
+ */
+void Optimizer::tune(llvm::Module *theModule, const std::string &cpu) {
+  LOG_S(1) << "Tuning program " << theModule->getName().str() << " for "
+           << cpu;
+
+  auto name = cpu;
+  std::vector<std::string> features;
+  if (cpu == "native") {
+    name = llvm::sys::getHostCPUName().str();
+    llvm::StringMap<bool> hostFeatures;
+    if (llvm::sys::getHostCPUFeatures(hostFeatures)) {
+      for (auto &feature : hostFeatures) {
+        features.push_back((feature.second ? "+" : "-") +
+                           feature.first().str());
+      }
+      std::sort(features.begin(), features.end());
+    }
+  }
+
+  for (auto &fn : *theModule) {
+    if (fn.isDeclaration()) {
+      continue;
+    }
+    fn.addFnAttr("target-cpu", name);
+    if (!features.empty()) {
+      fn.addFnAttr("target-features", llvm::join(features, ","));
+    }
+  }
 }
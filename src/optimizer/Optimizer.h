@@ -2,15 +2,83 @@
 
 #include "llvm/IR/Module.h"
 
+#include <string>
+#include <vector>
+
 /*! \class Optimizer
  *  \brief routines to optimize generated code.
  */
 class Optimizer {
 public:
+  //! Optimization level that selects the basic tipc passes
+  static constexpr int BASIC = -1;
+
   /*! \brief optimize LLVM module.
    *
-   * Apply a series of basic optimization passes to the given LLVM module.
+   * By default a series of basic optimization passes is applied to the given
+   * LLVM module.  Levels 0 to 3 select the standard LLVM pipeline of that
+   * level, which includes inlining, loop optimizations and, from level 2,
+   * vectorization.  A custom pipeline replaces either.
+   *
+   * With several jobs the module is split into partitions, see partition(),
+   * which are optimized concurrently and then put back together.  With
+   * the basic passes the result does not depend on the number of jobs; the
+   * interprocedural passes of the other pipelines only see the functions of a
+   * partition, and functions left unused by them are removed from the whole
+   * module at levels 1 to 3.
+   *
+   * With a cache directory and the basic passes, the module is always
+   * partitioned and partitions whose code did not change since they were
+   * last optimized are read from the cache.  Functions are assigned to
+   * partitions by name then, so that a change to a function only causes its
+   * own partition to be optimized.  The other pipelines are not cached, as
+   * their code depends on the partitions.
    * \param theModule an LLVM module to be optimized
+   * \param jobs the number of threads to use, 0 uses all hardware threads
+   * \param level the optimization level, 0-3 or BASIC
+   * \param passes a pass pipeline in the syntax of opt's --passes, if not empty
+   * \param cacheDirectory the directory caching optimized partitions, none if
+   * empty
+   */
+  static void optimize(llvm::Module *theModule, unsigned jobs = 1,
+                       int level = BASIC, const std::string &passes = "",
+                       const std::string &cacheDirectory = "");
+
+  /*! \brief partition the functions of an LLVM module.
+   *
+   * Functions that call one another recursively are kept together, and a
+   * caller is kept with its callees as long as their partition does not
+   * exceed an even share of the instructions of the module.
+   * \param theModule an LLVM module to be partitioned
+   * \param count the largest number of partitions
+   * \param stable whether functions are assigned to partitions by name, so
+   * that a change to a function does not move the others
+   * \return the defined functions of each partition
+   */
+  static std::vector<std::vector<llvm::Function *>>
+  partition(llvm::Module *theModule, std::size_t count, bool stable = false);
+
+  /*! \brief check a custom pass pipeline.
+   *
+   * \param passes a pass pipeline in the syntax of opt's --passes
+   * \return a description of the error, empty if the pipeline is valid
+   */
+  static std::string checkPasses(const std::string &passes);
+
+  /*! \brief check the name of a CPU to tune for.
+   *
+   * \param cpu the name of a CPU of the host's target, or "native"
+   * \return a description of the error, empty if the CPU is known
+   */
+  static std::string checkCPU(const std::string &cpu);
+
+  /*! \brief tune LLVM module for a CPU.
+   *
+   * Sets the target CPU of the functions defined in the module, which the
+   * optimizer and the code generator take into account.  For the host CPU
+   * all of its features are enabled.
+   * \param theModule an LLVM module to be tuned
+   * \param cpu the name of the CPU, "native" for the host CPU
    */
-  static void optimize(llvm::Module *theModule);
+  static void tune(llvm::Module *theModule, const std::string &cpu);
 };
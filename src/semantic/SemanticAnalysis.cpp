@@ -1,13 +1,26 @@
 #include "SemanticAnalysis.h"
 #include "CheckAssignable.h"
+#include "PhaseTimer.h"
 
-std::shared_ptr<SemanticAnalysis> SemanticAnalysis::analyze(ASTProgram *ast,
-                                                            bool polyInf) {
-  auto symTable = SymbolTable::build(ast);
-  CheckAssignable::check(ast);
-  auto callGraph = CallGraph::build(ast, symTable.get());
-  auto typeResults =
-      TypeInference::run(ast, polyInf, callGraph.get(), symTable.get());
+std::shared_ptr<SemanticAnalysis>
+SemanticAnalysis::analyze(ASTProgram *ast, bool polyInf, unsigned jobs) {
+  std::shared_ptr<SymbolTable> symTable;
+  {
+    PhaseTimer::Phase phase("symbolTable");
+    symTable = SymbolTable::build(ast);
+  }
+  {
+    PhaseTimer::Phase phase("checkAssignable");
+    CheckAssignable::check(ast);
+  }
+  std::shared_ptr<CallGraph> callGraph;
+  {
+    PhaseTimer::Phase phase("callGraph");
+    callGraph = CallGraph::build(ast, symTable.get());
+  }
+  PhaseTimer::Phase phase("typeInference");
+  auto typeResults = TypeInference::run(ast, polyInf, callGraph.get(),
+                                        symTable.get(), jobs);
   return std::make_shared<SemanticAnalysis>(symTable, typeResults, callGraph);
 }
 
@@ -13,7 +13,18 @@ CFAnalyzer::getPossibleFunctionsForExpr(ASTNode *n, ASTFunction *f) {
 }
 
 CFAnalyzer::CFAnalyzer(ASTProgram *p, SymbolTable *st)
-    : s(p->getFunctions()), symbolTable(st), pgr(p) {}
+    : s(p->getFunctions()), symbolTable(st), pgr(p) {
+  for (ASTFunction *fun : pgr->getFunctions()) {
+    functionsByArity[fun->getFormals().size()].push_back(fun);
+
+    auto stmts = fun->getStmts();
+    ASTReturnStmt *ret;
+    if (!(ret = dynamic_cast<ASTReturnStmt *>(stmts[stmts.size() - 1]))) {
+      assert(false); // LCOV_EXCL_LINE
+    }
+    returnNodes[fun] = getCanonicalForFunction(ret->getArg(), fun);
+  }
+}
 
 ASTNode *CFAnalyzer::getCanonical(ASTNode *n) {
   if (auto ve = dynamic_cast<ASTVariableExpr *>(n)) {
@@ -45,24 +56,35 @@ bool CFAnalyzer::visit(ASTFunction *element) {
   return true;
 }
 void CFAnalyzer::endVisit(ASTFunction *element) { scope.pop(); }
+/*! \brief Add a conditional constraint unless it has been added before.
+ */
+void CFAnalyzer::addConditionalConstraint(ASTFunction *condition, ASTNode *in,
+                                          ASTNode *from, ASTNode *to) {
+  if (conditionalConstraints.emplace(condition, in, from, to).second) {
+    s.addConditionalConstraint(condition, in, from, to);
+  }
+}
+
+/*! \brief Generate constraints for a call.
+ *
+ * Only functions whose arity matches the number of actuals can be called, so
+ * candidates are taken from the arity index.  For each candidate the actuals
+ * flow to the formals and the returned value flows to the call expression.
+ */
 bool CFAnalyzer::visit(ASTFunAppExpr *element) {
-  for (ASTFunction *fun : pgr->getFunctions()) {
-    if (fun->getFormals().size() == element->getActuals().size()) {
-      for (int i = 0; i < fun->getFormals().size(); i++) {
-        s.addConditionalConstraint(
-            fun, getCanonical(element->getFunction()),
-            getCanonical(element->getActuals()[i]),
-            getCanonicalForFunction(fun->getFormals()[i], fun));
-        auto stmts = fun->getStmts();
-        ASTReturnStmt *ret;
-        if (!(ret = dynamic_cast<ASTReturnStmt *>(stmts[stmts.size() - 1]))) {
-          assert(false); // LCOV_EXCL_LINE
-        }
-        s.addConditionalConstraint(fun, getCanonical(element->getFunction()),
-                                   getCanonicalForFunction(ret->getArg(), fun),
-                                   getCanonical(element));
-      }
+  auto candidates = functionsByArity.find(element->getActuals().size());
+  if (candidates == functionsByArity.end()) {
+    return true;
+  }
+  auto callee = getCanonical(element->getFunction());
+  for (ASTFunction *fun : candidates->second) {
+    for (int i = 0; i < fun->getFormals().size(); i++) {
+      addConditionalConstraint(
+          fun, callee, getCanonical(element->getActuals()[i]),
+          getCanonicalForFunction(fun->getFormals()[i], fun));
     }
+    addConditionalConstraint(fun, callee, returnNodes[fun],
+                             getCanonical(element));
   }
   return true;
 } // LCOV_EXCL_LINE
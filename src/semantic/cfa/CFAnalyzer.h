@@ -2,7 +2,11 @@
 #include "CubicSolver.h"
 #include "SymbolTable.h"
 #include "treetypes/AST.h"
+#include <map>
+#include <set>
 #include <stack>
+#include <tuple>
+#include <vector>
 
 /*! \class CFAnalyzer
  * \brief Performs control flow analyses with the help of AST and Symbol table
@@ -32,7 +36,20 @@ private:
   CFAnalyzer(ASTProgram *p, SymbolTable *st);
   ASTNode *getCanonical(ASTNode *n);
   ASTNode *getCanonicalForFunction(ASTNode *n, ASTFunction *);
+  void addConditionalConstraint(ASTFunction *condition, ASTNode *in,
+                                ASTNode *from, ASTNode *to);
   CubicSolver s;
+
+  // Candidate callees of a call site, indexed by number of formals
+  std::map<int, std::vector<ASTFunction *>> functionsByArity;
+
+  // Canonical node of the returned expression of each function
+  std::map<ASTFunction *, ASTNode *> returnNodes;
+
+  // Conditional constraints already handed to the solver
+  std::set<std::tuple<ASTFunction *, ASTNode *, ASTNode *, ASTNode *>>
+      conditionalConstraints;
+
   std::stack<ASTDeclNode *> scope;
   SymbolTable *symbolTable;
   ASTProgram *pgr;
@@ -1,5 +1,6 @@
 #include "CallGraph.h"
 #include "loguru.hpp"
+#include <algorithm>
 
 std::shared_ptr<CallGraph> CallGraph::build(ASTProgram *ast, SymbolTable *st) {
   LOG_S(1) << "Generating Control Flow Constraints";
@@ -33,7 +34,12 @@ std::vector<std::pair<ASTFunction *, ASTFunction *>> CallGraph::getEdges() {
 } // LCOV_EXCL_LINE
 
 std::set<ASTFunction *> CallGraph::getCalledFuns(ASTFunAppExpr *e) {
-  return mayCall[e];
+  // Lookup without inserting, the call graph is read concurrently
+  auto called = mayCall.find(e);
+  if (called == mayCall.end()) {
+    return std::set<ASTFunction *>();
+  }
+  return called->second;
 }
 
 std::set<ASTFunction *> CallGraph::getCallees(ASTFunction *f) {
@@ -104,3 +110,96 @@ bool CallGraph::existEdge(std::string caller, std::string callee) {
 ASTFunction *CallGraph::getASTFun(std::string f_name) {
   return fromFunNameToASTFuns[f_name];
 }
+
+/*
+ * Tarjan's algorithm, with an explicit stack so that deep call chains cannot
+ * exhaust the native stack.  Vertices and callees are visited in program
+ * order so that the resulting order of the components is deterministic.
+ */
+void CallGraph::computeSCCs() {
+  int n = vertices.size();
+  std::map<ASTFunction *, int> position;
+  for (int v = 0; v < n; v++) {
+    position[vertices[v]] = v;
+  }
+
+  std::vector<std::vector<int>> successors(n);
+  for (int v = 0; v < n; v++) {
+    for (auto callee : getCallees(vertices[v])) {
+      successors[v].push_back(position[callee]);
+    }
+    std::sort(successors[v].begin(), successors[v].end());
+  }
+
+  std::vector<int> index(n, -1);
+  std::vector<int> lowlink(n, 0);
+  std::vector<bool> onStack(n, false);
+  std::vector<int> stack;
+  int counter = 0;
+
+  for (int root = 0; root < n; root++) {
+    if (index[root] != -1) {
+      continue;
+    }
+
+    // Each frame is a vertex and the position of its next successor
+    std::vector<std::pair<int, int>> frames{{root, 0}};
+    index[root] = lowlink[root] = counter++;
+    stack.push_back(root);
+    onStack[root] = true;
+
+    while (!frames.empty()) {
+      auto &[v, next] = frames.back();
+      if (next < successors[v].size()) {
+        int w = successors[v][next++];
+        if (index[w] == -1) {
+          index[w] = lowlink[w] = counter++;
+          stack.push_back(w);
+          onStack[w] = true;
+          frames.push_back({w, 0});
+        } else if (onStack[w]) {
+          lowlink[v] = std::min(lowlink[v], index[w]);
+        }
+        continue;
+      }
+
+      if (lowlink[v] == index[v]) {
+        std::vector<ASTFunction *> component;
+        int w;
+        do {
+          w = stack.back();
+          stack.pop_back();
+          onStack[w] = false;
+          component.push_back(vertices[w]);
+          sccIndex[vertices[w]] = sccs.size();
+        } while (w != v);
+        std::sort(component.begin(), component.end(),
+                  [&](ASTFunction *f, ASTFunction *g) {
+                    return position[f] < position[g];
+                  });
+        if (component.size() > 1 ||
+            getCallees(component.front()).count(component.front()) != 0) {
+          recursive.insert(component.begin(), component.end());
+        }
+        sccs.push_back(component);
+      }
+
+      int finished = v;
+      frames.pop_back();
+      if (!frames.empty()) {
+        int parent = frames.back().first;
+        lowlink[parent] = std::min(lowlink[parent], lowlink[finished]);
+      }
+    }
+  }
+}
+
+const std::vector<std::vector<ASTFunction *>> &CallGraph::getSCCs() {
+  return sccs;
+}
+
+int CallGraph::getSCCIndex(ASTFunction *f) { return sccIndex.at(f); }
+
+bool CallGraph::isRecursive(ASTFunction *f) {
+  return recursive.find(f) != recursive.end();
+}
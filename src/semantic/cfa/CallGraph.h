@@ -28,6 +28,12 @@ class CallGraph {
   std::map<ASTFunction *, std::set<ASTFunction *>> callGraph;
   std::map<std::string, ASTFunction *> fromFunNameToASTFuns;
   std::map<ASTFunAppExpr *, std::set<ASTFunction *>> mayCall;
+  std::vector<std::vector<ASTFunction *>> sccs;
+  std::map<ASTFunction *, int> sccIndex;
+  std::set<ASTFunction *> recursive;
+
+  // Compute the strongly connected components with Tarjan's algorithm
+  void computeSCCs();
 
 public:
   CallGraph(std::map<ASTFunction *, std::set<ASTFunction *>> cGraph,
@@ -35,7 +41,9 @@ public:
             std::vector<ASTFunction *> funs,
             std::map<std::string, ASTFunction *> fmap)
       : callGraph(cGraph), mayCall(mc), vertices(funs),
-        total_vertices(vertices.size()), fromFunNameToASTFuns(fmap) {}
+        total_vertices(vertices.size()), fromFunNameToASTFuns(fmap) {
+    computeSCCs();
+  }
 
   /*! \brief Return the shared pointer of the call graph for a given program.
    * \param The AST of the program and symbol table
@@ -78,6 +86,23 @@ public:
   std::set<ASTFunction *> getCallers(ASTFunction *f);
   std::set<std::string> getCallers(std::string callee);
 
+  /*! \brief Returns the strongly connected components of the call graph.
+   *
+   * The components form the condensation of the call graph, a DAG, and are
+   * listed in reverse topological order: every component comes after the
+   * components of all of the functions it calls.  Functions within a
+   * component are listed in program order.
+   */
+  const std::vector<std::vector<ASTFunction *>> &getSCCs();
+
+  /*! \brief Returns the position in getSCCs() of the component containing f.
+   */
+  int getSCCIndex(ASTFunction *f);
+
+  /*! \brief Returns whether f may call itself, directly or indirectly.
+   */
+  bool isRecursive(ASTFunction *f);
+
   //! Print call graph contents to output stream
   void print(std::ostream &os);
 
@@ -1,16 +1,17 @@
 #include "CubicSolver.h"
 #include "loguru.hpp"
-#include <map>
-#include <queue>
+#include <algorithm>
+#include <cassert>
 
-CubicSolverNode::CubicSolverNode(int count) {
-  bitvector.resize(count);
-  conditionalConstraints.resize(count);
-  for (int i = 0; i < count; i++) {
-    bitvector[i] = false;
-  }
-  size = count;
-}
+namespace {
+constexpr int WORD_BITS = 64;
+
+int wordCount(int count) { return (count + WORD_BITS - 1) / WORD_BITS; }
+} // namespace
+
+CubicSolverNode::CubicSolverNode(int index, int count)
+    : parent(index), rank(0), bitvector(wordCount(count), 0),
+      delta(wordCount(count), 0), queued(false) {}
 
 CubicSolver::CubicSolver(std::vector<ASTFunction *> functions) {
   for (int i = 0; i < functions.size(); i++) {
@@ -18,19 +19,28 @@ CubicSolver::CubicSolver(std::vector<ASTFunction *> functions) {
   }
 }
 
-void CubicSolver::addEmptyVariableIfNecessary(ASTNode *node) {
-  if (dagmapping.find(node) != dagmapping.end()) {
-    return;
+int CubicSolver::addEmptyVariableIfNecessary(ASTNode *node) {
+  auto iter = dagmapping.find(node);
+  if (iter != dagmapping.end()) {
+    return iter->second;
   }
-  dagmapping[node] = std::make_shared<CubicSolverNode>(fmapping.size());
+  int index = nodes.size();
+  nodes.emplace_back(index, fmapping.size());
+  dagmapping[node] = index;
+  return index;
 }
 
 void CubicSolver::addElementofConstraint(ASTFunction *fn, ASTNode *node) {
   LOG_S(1) << "Generating control flow constraint: " << fn->getName()
            << " \u2208 \u27e6" << *node << "\u27e7";
-  addEmptyVariableIfNecessary(node);
-  dagmapping[node]->bitvector[fmapping[fn]] = true;
-  propagateNodeChanges(dagmapping[node]);
+  int n = addEmptyVariableIfNecessary(node);
+  int token = fmapping[fn];
+  std::vector<CubicSolverNode::Word> tokens(wordCount(fmapping.size()), 0);
+  tokens[token / WORD_BITS] |= CubicSolverNode::Word(1) << (token % WORD_BITS);
+  if (addTokens(find(n), tokens)) {
+    enqueue(find(n));
+  }
+  propagate();
 }
 
 void CubicSolver::addConditionalConstraint(ASTFunction *condition, ASTNode *in,
@@ -38,179 +48,215 @@ void CubicSolver::addConditionalConstraint(ASTFunction *condition, ASTNode *in,
   LOG_S(1) << "Generating control flow constraint: " << condition->getName()
            << " \u2208 \u27e6" << *in << "\u27e7 \u21d2 \u27e6" << *from
            << "\u27e7 \u2286 \u27e6" << *to << "\u27e7";
-  addEmptyVariableIfNecessary(in);
-  addEmptyVariableIfNecessary(from);
-  addEmptyVariableIfNecessary(to);
-  dagmapping[in]->conditionalConstraints[fmapping[condition]].push_back(
-      std::pair(from, to));
-  propagateNodeChanges(dagmapping[in]);
+  int n = find(addEmptyVariableIfNecessary(in));
+  int f = addEmptyVariableIfNecessary(from);
+  int t = addEmptyVariableIfNecessary(to);
+  int token = fmapping[condition];
+  if (hasToken(n, token)) {
+    addEdge(f, t);
+  } else {
+    nodes[n].conditionalConstraints[token].push_back(std::pair(f, t));
+  }
+  propagate();
 }
 
 void CubicSolver::addSubseteqConstraint(ASTNode *from, ASTNode *to) {
   LOG_S(1) << "Generating control flow constraint: "
            << "\u27e6" << *from << "\u27e7 \u2286 \u27e6" << *to << "\u27e7";
-  addEmptyVariableIfNecessary(from);
-  addEmptyVariableIfNecessary(to);
-  if (dagmapping[from] == dagmapping[to]) {
-    return;
-  }
-  dagmapping[from]->supsets.insert(dagmapping[to]);
-  dagmapping[to]->subsets.insert(dagmapping[from]);
-  killCyclesAt(dagmapping[from]);
-  propagateNodeChanges(dagmapping[from]);
+  int f = addEmptyVariableIfNecessary(from);
+  int t = addEmptyVariableIfNecessary(to);
+  addEdge(f, t);
+  propagate();
 }
 
-void CubicSolver::propagateNodeChanges(std::shared_ptr<CubicSolverNode> node) {
-  for (int i = 0; i < node->size; i++) {
-    if (node->bitvector[i]) {
-      auto constraints = node->conditionalConstraints[i];
-      node->conditionalConstraints[i].clear();
-      for (auto pair : constraints) {
-        activateConditionalConstraint(pair.first, pair.second);
-      }
-    }
-  }
-  for (std::shared_ptr<CubicSolverNode> sups : node->supsets) {
-    for (int i = 0; i < node->size; i++) {
-      sups->bitvector[i] = sups->bitvector[i] || node->bitvector[i];
-    }
-    assert(sups != node);
-    propagateNodeChanges(sups);
+/*! \brief Return the representative of the node, compressing the path to it.
+ */
+int CubicSolver::find(int n) {
+  while (nodes[n].parent != n) {
+    nodes[n].parent = nodes[nodes[n].parent].parent;
+    n = nodes[n].parent;
   }
+  return n;
 }
 
-void CubicSolver::activateConditionalConstraint(ASTNode *from, ASTNode *to) {
-  if (dagmapping[from] == dagmapping[to]) {
-    return;
+bool CubicSolver::hasToken(int n, int token) {
+  return (nodes[n].bitvector[token / WORD_BITS] >> (token % WORD_BITS)) & 1;
+}
+
+void CubicSolver::enqueue(int n) {
+  if (!nodes[n].queued) {
+    nodes[n].queued = true;
+    worklist.push_back(n);
   }
-  dagmapping[from]->supsets.insert(dagmapping[to]);
-  dagmapping[to]->subsets.insert(dagmapping[from]);
-  killCyclesAt(dagmapping[from]);
-  propagateNodeChanges(dagmapping[from]);
 }
 
-std::shared_ptr<CubicSolverNode>
-CubicSolver::killCyclesAt(std::shared_ptr<CubicSolverNode> n) {
-  bool collapsed;
-  do {
-    collapsed = false;
-    for (std::shared_ptr<CubicSolverNode> t : n->supsets) {
-      auto path = findPath(t, n);
-      if (path.size() == 0) {
-        continue;
-      }
-      n = mergePath(path);
-      collapsed = true;
-      break;
+/*! \brief Add the tokens to the solution of representative node n.
+ * \return true if the solution changed
+ */
+bool CubicSolver::addTokens(int n,
+                            const std::vector<CubicSolverNode::Word> &tokens) {
+  auto &node = nodes[n];
+  bool changed = false;
+  for (int w = 0; w < tokens.size(); w++) {
+    auto added = tokens[w] & ~node.bitvector[w];
+    if (added) {
+      node.bitvector[w] |= added;
+      node.delta[w] |= added;
+      changed = true;
     }
-  } while (collapsed);
-  return n;
-} // LCOV_EXCL_LINE
-
-std::shared_ptr<CubicSolverNode>
-CubicSolver::mergePath(std::vector<std::shared_ptr<CubicSolverNode>> &path) {
-  assert(path.size() != 0);
-  while (true) {
-    if (path.size() == 1) {
-      return path[0];
-    }
-    std::shared_ptr<CubicSolverNode> a = path.back();
-    path.pop_back();
-    std::shared_ptr<CubicSolverNode> b = path.back();
-    path.pop_back();
-    path.push_back(mergeNodes(a, b));
   }
+  return changed;
 }
 
-std::shared_ptr<CubicSolverNode>
-CubicSolver::mergeNodes(std::shared_ptr<CubicSolverNode> n1,
-                        std::shared_ptr<CubicSolverNode> n2) {
-  for (auto &pair : dagmapping) {
-    if (pair.second == n2) {
-      pair.second = n1;
-    }
+void CubicSolver::addEdge(int from, int to) {
+  from = find(from);
+  to = find(to);
+  if (from == to || !nodes[from].supsets.insert(to).second) {
+    return;
   }
-  for (int i = 0; i < n1->size; i++) {
-    n1->bitvector[i] = n1->bitvector[i] || n2->bitvector[i];
-    for (auto a : n2->conditionalConstraints[i]) {
-      n1->conditionalConstraints[i].push_back(a);
-    }
+  if (addTokens(to, nodes[from].bitvector)) {
+    enqueue(to);
   }
-  for (auto a : n2->supsets) {
-    if (n1 == a) {
+}
+
+/*! \brief Process the worklist until all changes have been propagated.
+ *
+ * Each node is processed with the tokens it gained since it was last
+ * processed; conditional constraints for those tokens are activated and the
+ * tokens are passed on to the supersets.
+ */
+void CubicSolver::propagate() {
+  while (!worklist.empty()) {
+    int n = worklist.front();
+    worklist.pop_front();
+    nodes[n].queued = false;
+    if (find(n) != n) {
+      // Merged into another node which has been queued in its place
       continue;
     }
-    a->subsets.erase(a->subsets.find(n2));
-    a->subsets.insert(n1);
-    n1->supsets.insert(a);
-  }
-  for (auto a : n2->subsets) {
-    if (n1 == a) {
+
+    std::vector<CubicSolverNode::Word> delta(nodes[n].delta.size(), 0);
+    std::swap(delta, nodes[n].delta);
+    if (std::all_of(delta.begin(), delta.end(),
+                    [](CubicSolverNode::Word w) { return w == 0; })) {
       continue;
     }
-    a->supsets.erase(a->supsets.find(n2));
-    a->supsets.insert(n1);
-    n1->subsets.insert(a);
-  }
-  if (n1->supsets.find(n2) != n1->supsets.end()) {
-    n1->supsets.erase(n1->supsets.find(n2));
-  }
-  if (n1->subsets.find(n2) != n1->subsets.end()) {
-    n1->subsets.erase(n1->subsets.find(n2));
-  }
-  return n1;
-}
 
-std::vector<std::shared_ptr<CubicSolverNode>>
-CubicSolver::findPath(std::shared_ptr<CubicSolverNode> source,
-                      std::shared_ptr<CubicSolverNode> target) {
-  std::map<std::shared_ptr<CubicSolverNode>, int> distances;
-  distances[source] = 0;
-  std::queue<std::shared_ptr<CubicSolverNode>> q;
-
-  auto populateDistances = [&](std::shared_ptr<CubicSolverNode> node) {
-    assert(node != NULL);
-    for (std::shared_ptr<CubicSolverNode> n : node->supsets) {
-      if (distances.find(n) != distances.end()) {
-        continue;
+    for (int w = 0; w < delta.size(); w++) {
+      for (auto bits = delta[w]; bits != 0; bits &= bits - 1) {
+        int token = w * WORD_BITS + __builtin_ctzll(bits);
+        auto iter = nodes[n].conditionalConstraints.find(token);
+        if (iter == nodes[n].conditionalConstraints.end()) {
+          continue;
+        }
+        auto constraints = std::move(iter->second);
+        nodes[n].conditionalConstraints.erase(iter);
+        for (auto &pair : constraints) {
+          addEdge(pair.first, pair.second);
+        }
       }
-      distances[n] = distances[node] + 1;
-      q.push(n);
     }
-  };
 
-  populateDistances(source);
-
-  while (!q.empty()) {
-    std::shared_ptr<CubicSolverNode> curr = q.front();
-    populateDistances(curr);
-    q.pop();
-    if (distances.find(target) != distances.end()) {
-      break;
+    std::vector<int> supsets(nodes[n].supsets.begin(), nodes[n].supsets.end());
+    for (int sup : supsets) {
+      if (find(n) != n) {
+        // A collapsed cycle absorbed n, its representative has been queued
+        break;
+      }
+      sup = find(sup);
+      if (sup == n) {
+        continue;
+      }
+      if (addTokens(sup, delta)) {
+        enqueue(sup);
+      }
+      if (nodes[sup].bitvector == nodes[n].bitvector) {
+        killCycleAt(n, sup);
+      }
     }
   }
+}
 
-  std::vector<std::shared_ptr<CubicSolverNode>> out;
+/*! \brief Collapse the cycle closed by the edge from -> to, if there is one.
+ *
+ * Only called when both ends of the edge have equal solutions, which is the
+ * case for all nodes on a cycle.  Each edge is checked at most once.
+ */
+void CubicSolver::killCycleAt(int from, int to) {
+  if (!checkedEdges.insert((std::uint64_t(from) << 32) | unsigned(to)).second) {
+    return;
+  }
 
-  if (distances.find(target) == distances.end()) {
-    return out;
-  } else {
-    std::shared_ptr<CubicSolverNode> curr = target;
-    out.push_back(target);
-    while (curr != source) {
-      for (std::shared_ptr<CubicSolverNode> n : curr->subsets) {
-        if (distances.find(n) == distances.end()) {
-          continue;
-        }
-        if (distances[n] == distances[curr] - 1) {
-          curr = n;
-        }
+  // Depth-first search for a path from "to" back to "from"
+  std::unordered_map<int, int> predecessors{{to, to}};
+  std::vector<int> stack{to};
+  bool found = false;
+  while (!stack.empty() && !found) {
+    int n = stack.back();
+    stack.pop_back();
+    for (int sup : nodes[n].supsets) {
+      sup = find(sup);
+      if (predecessors.count(sup) != 0) {
+        continue;
+      }
+      predecessors[sup] = n;
+      if (sup == from) {
+        found = true;
         break;
       }
-      out.push_back(curr);
+      stack.push_back(sup);
     }
-    return out;
   }
+  if (!found) {
+    return;
+  }
+
+  int merged = from;
+  for (int n = predecessors[from]; n != to; n = predecessors[n]) {
+    merged = mergeNodes(merged, n);
+  }
+  mergeNodes(merged, to);
+}
+
+/*! \brief Merge two representative nodes, returning the new representative.
+ *
+ * The merged node is reprocessed with its complete solution so that pending
+ * conditional constraints and edges of both nodes see all of its tokens.
+ */
+int CubicSolver::mergeNodes(int n1, int n2) {
+  n1 = find(n1);
+  n2 = find(n2);
+  if (n1 == n2) {
+    return n1;
+  }
+  if (nodes[n1].rank < nodes[n2].rank) {
+    std::swap(n1, n2);
+  } else if (nodes[n1].rank == nodes[n2].rank) {
+    nodes[n1].rank++;
+  }
+  nodes[n2].parent = n1;
+
+  auto &rep = nodes[n1];
+  auto &other = nodes[n2];
+  for (int w = 0; w < rep.bitvector.size(); w++) {
+    rep.bitvector[w] |= other.bitvector[w];
+  }
+  rep.delta = rep.bitvector;
+  for (int sup : other.supsets) {
+    rep.supsets.insert(sup);
+  }
+  for (auto &pair : other.conditionalConstraints) {
+    auto &constraints = rep.conditionalConstraints[pair.first];
+    constraints.insert(constraints.end(), pair.second.begin(),
+                       pair.second.end());
+  }
+  other.supsets.clear();
+  other.conditionalConstraints.clear();
+  other.bitvector.clear();
+  other.delta.clear();
+
+  enqueue(n1);
+  return n1;
 }
 
 std::vector<ASTFunction *>
@@ -219,8 +265,9 @@ CubicSolver::getPossibleFunctionsForExpr(ASTNode *n) {
   if (dagmapping.find(n) == dagmapping.end()) {
     return out;
   }
+  int node = find(dagmapping[n]);
   for (auto pair : fmapping) {
-    if (dagmapping[n]->bitvector[pair.second]) {
+    if (hasToken(node, pair.second)) {
       out.push_back(pair.first);
     }
   }
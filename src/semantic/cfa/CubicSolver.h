@@ -1,26 +1,61 @@
+#pragma once
+
 #include "ASTFunction.h"
 #include "ASTNode.h"
+#include <cstdint>
+#include <deque>
 #include <map>
-#include <set>
+#include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
 class CubicSolver;
 
+/*! \class CubicSolverNode
+ * \brief A set variable of the cubic solver.
+ *
+ * Nodes on a cycle of subset constraints have equal solutions and are
+ * collapsed into a single node.  Collapsed nodes are tracked with a
+ * union-find and only the data of the representative node is meaningful.
+ */
 class CubicSolverNode {
 public:
-  CubicSolverNode(int count);
+  CubicSolverNode(int index, int count);
 
 private:
   friend CubicSolver;
-  std::set<std::shared_ptr<CubicSolverNode>> supsets;
-  std::set<std::shared_ptr<CubicSolverNode>> subsets;
-  std::vector<bool> bitvector;
-  int size;
-  std::vector<std::vector<std::pair<ASTNode *, ASTNode *>>>
+  using Word = std::uint64_t;
+
+  // Union-find parent, representatives are their own parent
+  int parent;
+  int rank;
+
+  // Tokens in the solution, one bit per function packed into words
+  std::vector<Word> bitvector;
+
+  // Tokens added since the node was last processed from the worklist
+  std::vector<Word> delta;
+  bool queued;
+
+  // Nodes whose solutions include the solution of this node
+  std::unordered_set<int> supsets;
+
+  // Subset constraints that are added once a token is in the solution
+  std::unordered_map<int, std::vector<std::pair<int, int>>>
       conditionalConstraints;
 };
 
+/*! \class CubicSolver
+ * \brief Solver for the control flow constraints of the cubic algorithm.
+ *
+ * Constraints are solved incrementally as they are added.  Changes are
+ * propagated from an explicit worklist of nodes, each of which carries the
+ * tokens it has gained since it was last processed, and solutions are
+ * combined a word at a time.  Cycles are detected lazily, when propagation
+ * along an edge leaves both of its ends with the same solution, and are
+ * then collapsed into a single node.
+ */
 class CubicSolver {
 public:
   CubicSolver(std::vector<ASTFunction *> functions);
@@ -31,19 +66,21 @@ public:
   std::vector<ASTFunction *> getPossibleFunctionsForExpr(ASTNode *);
 
 private:
-  void activateConditionalConstraint(ASTNode *from, ASTNode *to);
-  void addEmptyVariableIfNecessary(ASTNode *node);
-  std::shared_ptr<CubicSolverNode>
-  killCyclesAt(std::shared_ptr<CubicSolverNode> n);
-  std::vector<std::shared_ptr<CubicSolverNode>>
-  findPath(std::shared_ptr<CubicSolverNode> source,
-           std::shared_ptr<CubicSolverNode> target);
-  std::shared_ptr<CubicSolverNode>
-  mergePath(std::vector<std::shared_ptr<CubicSolverNode>> &path);
-  std::shared_ptr<CubicSolverNode>
-  mergeNodes(std::shared_ptr<CubicSolverNode> n1,
-             std::shared_ptr<CubicSolverNode> n2);
-  void propagateNodeChanges(std::shared_ptr<CubicSolverNode> node);
+  int addEmptyVariableIfNecessary(ASTNode *node);
+  int find(int n);
+  int mergeNodes(int n1, int n2);
+  void addEdge(int from, int to);
+  bool addTokens(int n, const std::vector<CubicSolverNode::Word> &tokens);
+  void enqueue(int n);
+  void propagate();
+  void killCycleAt(int from, int to);
+  bool hasToken(int n, int token);
+
   std::map<ASTFunction *, int> fmapping;
-  std::map<ASTNode *, std::shared_ptr<CubicSolverNode>> dagmapping;
+  std::unordered_map<ASTNode *, int> dagmapping;
+  std::vector<CubicSolverNode> nodes;
+  std::deque<int> worklist;
+
+  // Edges that have already been checked for cycles
+  std::unordered_set<std::uint64_t> checkedEdges;
 };
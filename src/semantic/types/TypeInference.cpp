@@ -4,159 +4,118 @@
 #include "TypeConstraint.h"
 #include "TypeConstraintCollectVisitor.h"
 #include "Unifier.h"
+#include "Parallel.h"
+#include "PhaseTimer.h"
 #include "loguru.hpp"
+#include <algorithm>
 #include <memory>
 
-/* Local name space for DFS visit variables */
 namespace {
-std::deque<ASTFunction *> sorted;
-std::vector<ASTFunction *> unmarked;
-} // namespace
-
-/* DFS to compute call dependence assuming that the graph
- * does not have cycles.  The DFS updates the unmarked vector
- * which records the functions whose dependences have been computed.
- */
-void topoVisit(CallGraph *cg, ASTFunction *f) {
-  // If f is marked, i.e., not in unmarked, then backtrack DFS
-  if (std::find(unmarked.begin(), unmarked.end(), f) == unmarked.end()) {
-    return;
-  }
-
-  // remove it from unmarked
-  auto fPosition = std::find(unmarked.begin(), unmarked.end(), f);
-  assert(fPosition != unmarked.end()); // f must be in the unmarked list
-  unmarked.erase(fPosition);
-
-  // visit called functions
-  for (auto c : cg->getCallees(f)) {
-    topoVisit(cg, c);
-  }
-
-  // add it to sorted
-  sorted.push_back(f);
-}
-
-/* Determine whether there is a call chain from function f to g.
- * To determine if a function is recursive call with f==g.
- */
-bool mayIndirectlyCall(CallGraph *cg, ASTFunction *f, ASTFunction *g) {
-  bool result = false;
-  auto callees = cg->getCallees(f);
-  for (auto c : callees) {
-    if (c == g) {
-      return true;
-    } else {
-      result = result || mayIndirectlyCall(cg, c, g);
-    }
-  }
-  return result;
-}
-
-// Topologically sort the set of functions based on the call graph.
-std::deque<ASTFunction *> topoSort(CallGraph *cg,
-                                   std::vector<ASTFunction *> funcs) {
-  /* Initialize globals for sort DFS */
-  sorted = std::deque<ASTFunction *>();
-  unmarked = funcs;
-
-  while (!unmarked.empty()) {
-    auto f = unmarked.back();
-    topoVisit(cg, f);
-  }
-  return sorted;
-}
-
-std::vector<ASTFunction *> recursiveFuncs(CallGraph *cg) {
-  auto funcs = cg->getVertices();
-  auto recursiveFuncs = std::vector<ASTFunction *>();
-  for (auto f : funcs) {
-    if (mayIndirectlyCall(cg, f, f)) {
-      recursiveFuncs.push_back(f);
-    }
-  }
-  return recursiveFuncs;
-}
 
-/* Filters the call graph to eliminate any functions that call, either
- * directly or indirectly, a recursive function.
- * Returns a topological ordering of functions in the filtered graph.
+/* Group the components of the call graph into levels.  A component is placed
+ * one level above the highest of the components it calls, so the components
+ * of a level are independent of one another and only depend on lower levels.
+ * Components are listed in the order of CallGraph::getSCCs within a level.
  */
-std::deque<ASTFunction *> topoSortNonRecursive(CallGraph *cg) {
-  auto recFuncs = recursiveFuncs(cg);
-
-  // Filter functions that directly or indirectly call a recursive function
-  auto nonRecursiveFuncs = std::vector<ASTFunction *>();
-  for (auto f : cg->getVertices()) {
-    bool filter = false;
-    for (auto r : recFuncs) {
-      if (f == r) {
-        filter = true;
-      } else {
-        filter = mayIndirectlyCall(cg, f, r);
+std::vector<std::vector<int>> componentLevels(CallGraph *cg) {
+  auto &components = cg->getSCCs();
+  std::vector<int> level(components.size(), 0);
+  std::vector<std::vector<int>> levels;
+  for (int c = 0; c < components.size(); c++) {
+    for (auto f : components[c]) {
+      for (auto callee : cg->getCallees(f)) {
+        auto d = cg->getSCCIndex(callee);
+        if (d != c) {
+          level[c] = std::max(level[c], level[d] + 1);
+        }
       }
-      if (filter)
-        break;
     }
-
-    if (!filter) {
-      nonRecursiveFuncs.push_back(f);
+    if (level[c] == levels.size()) {
+      levels.emplace_back();
     }
+    levels[level[c]].push_back(c);
   }
-
-  // Topologically sort the graph comprised of the non-recursive functions.
-  return topoSort(cg, nonRecursiveFuncs);
+  return levels;
 }
 
+} // namespace
+
 /*
- * The returned unifier accounts for all of the program that is NOT
- * handled within the elements of the unifier map, i.e., is not
- * subjected to polymorphic type inference.
+ * Polymorphic inference processes the strongly connected components of the
+ * call graph in reverse topological order, so the generic types of all called
+ * functions outside of a component are known when it is processed.  The
+ * functions of a component are solved together; calls among them are typed
+ * monomorphically.
+ *
+ * The components in a level of the condensation do not call one another,
+ * so their constraints are collected concurrently from the generic types of
+ * lower levels.  Each component is then solved concurrently in a unifier of
+ * its own, and the solutions are merged into the shared unifier in a fixed
+ * order.  Merging unifies every term with the representative it was solved
+ * to, which joins the types of a component with those of the functions it
+ * refers to in other components.  Components are solved the same way for
+ * any number of jobs, so the results do not depend on it.
  */
 std::shared_ptr<TypeInference> runPoly(ASTProgram *ast, SymbolTable *symbols,
-                                       CallGraph *cg) {
+                                       CallGraph *cg, unsigned jobs) {
   LOG_S(1) << "Generating Polymorphic Type Constraints";
 
-  /* A single unifier is used for the staged polymorphic inference
-   * and then the final monomorphic inference process.  The unifier
-   * is solved after each stage, which corresponds to processing the
-   * constraints of a non-recursive function.
+  /* The shared unifier holds the solution of the levels processed so far,
+   * from which the generic types of called functions are taken.  It is
+   * solved after each level is merged into it.
    */
   auto unifier = std::make_shared<Unifier>();
+  auto instantiations = std::make_shared<InstantiationCache>();
+  std::size_t unifications = 0;
+
+  auto &components = cg->getSCCs();
+  for (auto &level : componentLevels(cg)) {
+    std::vector<ASTFunction *> funcs;
+    for (auto c : level) {
+      funcs.insert(funcs.end(), components[c].begin(), components[c].end());
+    }
 
-  /* Generate and solve constraints for the non-recursive functions
-   * in topological order for the call graph.
-   */
-  auto nonRecursiveFuncs = topoSortNonRecursive(cg);
-  for (auto f : nonRecursiveFuncs) {
-    LOG_S(1) << "Generating Polymorphic Type Constraints for " << *f;
+    std::vector<std::vector<TypeConstraint>> collected(funcs.size());
+    Parallel::forEach(jobs, funcs.size(), [&](std::size_t i) {
+      LOG_S(1) << "Generating Polymorphic Type Constraints for " << *funcs[i];
 
-    PolyTypeConstraintCollectVisitor polyVisitor(symbols, cg, unifier);
-    f->accept(&polyVisitor);
+      PolyTypeConstraintCollectVisitor polyVisitor(symbols, cg, unifier,
+                                                   instantiations);
+      funcs[i]->accept(&polyVisitor);
+      collected[i] = std::move(polyVisitor.getCollectedConstraints());
+    });
 
-    unifier->add(polyVisitor.getCollectedConstraints());
-    unifier->solve();
-  }
+    for (auto &c : collected) {
+      PhaseTimer::count("constraints", c.size());
+    }
 
-  LOG_S(1) << "Generating Residual Monomorphic Type Constraints";
+    // The constraints of component level[k] start at collected[first[k]]
+    std::vector<std::size_t> first{0};
+    for (auto c : level) {
+      first.push_back(first.back() + components[c].size());
+    }
 
-  /* Iterate over functions those that are recursive, or that may directly
-   * or indirectly call a recursive function, generate their constraints.
-   */
-  for (auto f : cg->getVertices()) {
-    // Skip the functions for which polymorphic inference was applied
-    if (std::find(nonRecursiveFuncs.begin(), nonRecursiveFuncs.end(), f) ==
-        nonRecursiveFuncs.end()) {
-      TypeConstraintCollectVisitor monoVisitor(symbols);
-      f->accept(&monoVisitor);
-      unifier->add(monoVisitor.getCollectedConstraints());
+    std::vector<std::unique_ptr<Unifier>> solved(level.size());
+    Parallel::forEach(jobs, level.size(), [&](std::size_t k) {
+      solved[k] = std::make_unique<Unifier>();
+      for (auto i = first[k]; i < first[k + 1]; i++) {
+        solved[k]->add(std::move(collected[i]));
+      }
+      solved[k]->solve();
+    });
+
+    for (auto &component : solved) {
+      unifications += component->getUnificationCount();
+      unifier->add(component->solution());
+      unifier->solve();
     }
   }
 
-  /* Solve monomorphic constraints in combination with the
-   * previously collected polymorphic constraints.
-   */
-  unifier->solve();
+  LOG_S(1) << "Performed " << unifications + unifier->getUnificationCount()
+           << " unifications";
+  LOG_S(1) << "Reused " << instantiations->getHits() << " of "
+           << instantiations->getLookups()
+           << " polymorphic type instantiations";
 
   AbsentFieldChecker::check(ast, unifier.get());
 
@@ -164,19 +123,35 @@ std::shared_ptr<TypeInference> runPoly(ASTProgram *ast, SymbolTable *symbols,
 }
 
 /*
- * Performs monomorphic type inference on the entire program.
+ * Performs monomorphic type inference on the entire program.  Constraints are
+ * collected for each function concurrently and combined in program order.
  */
-std::shared_ptr<TypeInference> runMono(ASTProgram *ast, SymbolTable *symbols) {
+std::shared_ptr<TypeInference> runMono(ASTProgram *ast, SymbolTable *symbols,
+                                       unsigned jobs) {
   LOG_S(1) << "Generating Monomorphic Type Constraints";
 
-  TypeConstraintCollectVisitor visitor(symbols);
-  ast->accept(&visitor);
+  auto funcs = ast->getFunctions();
+  std::vector<std::vector<TypeConstraint>> collected(funcs.size());
+  Parallel::forEach(jobs, funcs.size(), [&](std::size_t i) {
+    TypeConstraintCollectVisitor visitor(symbols);
+    funcs[i]->accept(&visitor);
+    collected[i] = std::move(visitor.getCollectedConstraints());
+  });
+
+  std::vector<TypeConstraint> constraints;
+  for (auto &c : collected) {
+    constraints.insert(constraints.end(), c.begin(), c.end());
+  }
+  PhaseTimer::count("constraints", constraints.size());
 
   LOG_S(1) << "Solving type constraints";
 
-  auto unifier = std::make_shared<Unifier>(visitor.getCollectedConstraints());
+  auto unifier = std::make_shared<Unifier>(constraints);
   unifier->solve();
 
+  LOG_S(1) << "Performed " << unifier->getUnificationCount()
+           << " unifications";
+
   AbsentFieldChecker::check(ast, unifier.get());
 
   return std::make_shared<TypeInference>(symbols, unifier);
@@ -189,8 +164,10 @@ std::shared_ptr<TypeInference> runMono(ASTProgram *ast, SymbolTable *symbols) {
  */
 std::shared_ptr<TypeInference> TypeInference::run(ASTProgram *ast, bool doPoly,
                                                   CallGraph *cg,
-                                                  SymbolTable *symbols) {
-  return (doPoly) ? runPoly(ast, symbols, cg) : runMono(ast, symbols);
+                                                  SymbolTable *symbols,
+                                                  unsigned jobs) {
+  return (doPoly) ? runPoly(ast, symbols, cg, jobs)
+                  : runMono(ast, symbols, jobs);
 }
 
 std::shared_ptr<TipType> TypeInference::getInferredType(ASTDeclNode *node) {
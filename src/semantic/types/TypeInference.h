@@ -40,10 +40,13 @@ public:
    * \param ast The program AST
    * \param polyInf Flag indicating whether to perform polymorphic or
    * monomorphic inference \param cg The program call graph \param symbols The
-   * symbol table
+   * symbol table \param jobs The number of threads used to collect
+   * and solve constraints, 0 uses all hardware threads; results do not
+   * depend on it
    */
-  static std::shared_ptr<TypeInference>
-  run(ASTProgram *ast, bool polyInf, CallGraph *cg, SymbolTable *symbols);
+  static std::shared_ptr<TypeInference> run(ASTProgram *ast, bool polyInf,
+                                            CallGraph *cg, SymbolTable *symbols,
+                                            unsigned jobs = 1);
 
   /*! \fn getInferredType
    *  \brief Returns the type expression inferred for the given ASTDeclNode.
@@ -0,0 +1,84 @@
+#include "InstantiationCache.h"
+#include "FreshAlphaCopier.h"
+#include "TipFunction.h"
+#include "TypeVars.h"
+#include <algorithm>
+
+namespace {
+/*
+ * Whether every alpha of a generic function type occurs in its parameter
+ * types, so that the types of the arguments of a call determine the whole
+ * of its instance.  Otherwise calls with the same arguments may still need
+ * distinct types, e.g., the pointers returned by a poly function allocating
+ * a null pointer.
+ */
+bool determinedByParameters(TipType *generic) {
+  auto function = dynamic_cast<TipFunction *>(generic);
+  if (function == nullptr) {
+    return false;
+  }
+
+  std::vector<std::shared_ptr<TipVar>> parameterVars;
+  for (auto &param : function->getParamTypes()) {
+    auto vars = TypeVars::collect(param.get());
+    parameterVars.insert(parameterVars.end(), vars.begin(), vars.end());
+  }
+  auto returnVars = TypeVars::collect(function->getReturnType().get());
+  return std::all_of(returnVars.begin(), returnVars.end(), [&](auto &v) {
+    return std::any_of(parameterVars.begin(), parameterVars.end(),
+                       [&](auto &p) { return *p == *v; });
+  });
+}
+} // namespace
+
+std::shared_ptr<TipType>
+InstantiationCache::instantiate(ASTNode *caller, ASTNode *fn,
+                                std::shared_ptr<TipType> generic,
+                                ASTNode *context,
+                                const std::optional<Shape> &shape) {
+  std::optional<Key> key;
+  if (TypeVars::collect(generic.get()).empty()) {
+    // The instance is equal to the generic type for every call site
+    key = Key{nullptr, fn, Shape{}};
+  } else if (shape && determinedByParameters(generic.get())) {
+    /*
+     * The shape alone determines the types the alphas are bound to, but the
+     * instance is copied with alphas named after the first call to reach it.
+     * The calls of one caller are reached in program order, while callers
+     * are visited concurrently, so sharing an instance across callers would
+     * make the alphas of the inferred types depend on thread timing.  Most
+     * variables passed are declared by the caller anyway, so keying by the
+     * caller mostly loses sharing between calls that pass only literals.
+     */
+    key = Key{caller, fn, *shape};
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    lookups++;
+    if (key) {
+      auto iter = instances.find(*key);
+      if (iter != instances.end()) {
+        hits++;
+        return iter->second;
+      }
+    }
+  }
+
+  auto instance = FreshAlphaCopier::copy(generic.get(), context);
+  if (key) {
+    std::lock_guard<std::mutex> lock(mutex);
+    instances.emplace(*key, instance);
+  }
+  return instance;
+}
+
+std::size_t InstantiationCache::getLookups() {
+  std::lock_guard<std::mutex> lock(mutex);
+  return lookups;
+}
+
+std::size_t InstantiationCache::getHits() {
+  std::lock_guard<std::mutex> lock(mutex);
+  return hits;
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "ASTNode.h"
+#include "TipType.h"
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+/*! \class InstantiationCache
+ *
+ *  \brief Shares the instantiated types of polymorphic functions.
+ *
+ *  A generic type is instantiated at a call site by copying it with fresh
+ *  alphas for that call site.  Two calls with arguments of the same types
+ *  bind the alphas of their copies to the same types, provided each alpha
+ *  occurs in the parameter types, so they can share one copy.  The calls
+ *  of a function that share the shape of their arguments therefore reuse
+ *  the instance of the first of them.  Instances are only shared among the
+ *  calls of one caller, as the types of its variables are part of the shape,
+ *  which also keeps the fresh alphas independent of the order in which
+ *  concurrent visitors reach their calls.  A generic type without alphas is
+ *  the same for every call site, so one instance is shared by all calls.
+ *
+ *  The cache may be used concurrently by several constraint visitors.
+ */
+class InstantiationCache {
+public:
+  /*! \brief What is known of the type of an argument of a call.
+   *
+   * Either the declaration of the variable passed, whose type is a single
+   * term wherever it is used, or the text of the closed type of the argument.
+   */
+  using Argument = std::pair<ASTNode *, std::string>;
+
+  //! \brief The types of the arguments of a call.
+  using Shape = std::vector<Argument>;
+
+  InstantiationCache() = default;
+
+  /*! \brief Instantiate the generic type of a function at a call site.
+   *
+   * \param caller The function making the call.
+   * \param fn The declaration of the called function.
+   * \param generic The generic type of the function.
+   * \param context The call site.
+   * \param shape The types of the arguments, if all of them are known.
+   * \return A type with the alphas of the generic type replaced by alphas
+   * specific to the call site or to an earlier call of the same shape.
+   */
+  std::shared_ptr<TipType> instantiate(ASTNode *caller, ASTNode *fn,
+                                       std::shared_ptr<TipType> generic,
+                                       ASTNode *context,
+                                       const std::optional<Shape> &shape);
+
+  //! \brief Number of instantiations requested so far.
+  std::size_t getLookups();
+
+  //! \brief Number of instantiations that reused an earlier instance.
+  std::size_t getHits();
+
+private:
+  using Key = std::tuple<ASTNode *, ASTNode *, Shape>;
+
+  std::mutex mutex;
+  std::map<Key, std::shared_ptr<TipType>> instances;
+  std::size_t lookups = 0;
+  std::size_t hits = 0;
+};
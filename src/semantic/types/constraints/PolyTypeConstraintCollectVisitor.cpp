@@ -2,9 +2,10 @@
 #include "ConstraintCollector.h"
 
 PolyTypeConstraintCollectVisitor::PolyTypeConstraintCollectVisitor(
-    SymbolTable *pTable, CallGraph *callGraph, std::shared_ptr<Unifier> u)
+    SymbolTable *pTable, CallGraph *callGraph, std::shared_ptr<Unifier> u,
+    std::shared_ptr<InstantiationCache> cache)
     : PolyTypeConstraintVisitor(pTable, callGraph, u,
-                                std::move(buildConstraintHandler())) {}
+                                std::move(buildConstraintHandler()), cache) {}
 
 std::unique_ptr<ConstraintHandler>
 PolyTypeConstraintCollectVisitor::buildConstraintHandler() {
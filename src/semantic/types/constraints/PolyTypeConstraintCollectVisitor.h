@@ -20,7 +20,9 @@ class PolyTypeConstraintCollectVisitor : public PolyTypeConstraintVisitor {
 public:
   explicit PolyTypeConstraintCollectVisitor(SymbolTable *pTable,
                                             CallGraph *callGraph,
-                                            std::shared_ptr<Unifier> u);
+                                            std::shared_ptr<Unifier> u,
+                                            std::shared_ptr<InstantiationCache>
+                                                cache = nullptr);
   std::vector<TypeConstraint> &getCollectedConstraints();
 
 private:
@@ -1,13 +1,50 @@
 #include "PolyTypeConstraintVisitor.h"
-#include "FreshAlphaCopier.h"
+#include "ASTVariableExpr.h"
 #include "TypeVars.h"
 #include "loguru.hpp"
+#include <sstream>
 
 PolyTypeConstraintVisitor::PolyTypeConstraintVisitor(
     SymbolTable *st, CallGraph *cg, std::shared_ptr<Unifier> u,
-    std::unique_ptr<ConstraintHandler> handler)
+    std::unique_ptr<ConstraintHandler> handler,
+    std::shared_ptr<InstantiationCache> cache)
     : TypeConstraintVisitor(st, std::move(handler)), callGraph(cg),
-      unifier(u){};
+      unifier(u), instantiations(cache) {
+  if (instantiations == nullptr) {
+    instantiations = std::make_shared<InstantiationCache>();
+  }
+}
+
+bool PolyTypeConstraintVisitor::visit(ASTFunction *element) {
+  function = element;
+  return TypeConstraintVisitor::visit(element);
+}
+
+/*
+ * The types of the arguments of a call as far as they are known while the
+ * constraints of the caller are collected: variables, whose types are the
+ * terms of their declarations, and expressions whose own type rules fixed
+ * their types.  The arguments have been visited before the call, so their
+ * types are looked up rather than derived again.  Returns nothing if the type
+ * of an argument is not known.
+ */
+std::optional<InstantiationCache::Shape>
+PolyTypeConstraintVisitor::argumentShape(ASTFunAppExpr *element) {
+  InstantiationCache::Shape shape;
+  for (auto &a : element->getActuals()) {
+    if (dynamic_cast<ASTVariableExpr *>(a)) {
+      auto var = std::dynamic_pointer_cast<TipVar>(astToVar(a));
+      shape.emplace_back(var->getNode(), "");
+    } else if (auto type = fixedType(a)) {
+      std::stringstream text;
+      text << *type;
+      shape.emplace_back(nullptr, text.str());
+    } else {
+      return std::nullopt;
+    }
+  }
+  return shape;
+}
 
 /*! \brief Polymorphic type constraints for function application.
  *
@@ -29,6 +66,10 @@ PolyTypeConstraintVisitor::PolyTypeConstraintVisitor(
  * types and this makes it possible for a function to match distinct argument
  * and return value typings, e.g., to be polymorphic.
  *
+ * Functions in the same strongly connected component of the call graph as
+ * the calling function are solved together with it, so they have no generic
+ * type yet and calls to them are typed monomorphically.
+ *
  * Note that code generation works just fine with polymorphic typing as long
  * as all of the types have a common representation, i.e., they fit into the
  * same number of bits.
@@ -48,11 +89,13 @@ void PolyTypeConstraintVisitor::endVisit(ASTFunAppExpr *element) {
   for (auto f : callGraph->getCalledFuns(element)) {
     auto fName = f->getName();
     auto fDecl = symbolTable->getFunction(fName);
-    auto isPoly = symbolTable->getPoly(fName);
+    auto isPoly = symbolTable->getPoly(fName) &&
+                  callGraph->getSCCIndex(f) != callGraph->getSCCIndex(function);
 
     if (isPoly) {
       auto genericType = unifier->inferred(astToVar(fDecl));
-      auto copyType = FreshAlphaCopier::copy(genericType.get(), element);
+      auto copyType = instantiations->instantiate(
+          function, fDecl, genericType, element, argumentShape(element));
 
       auto instantiatedType = std::dynamic_pointer_cast<TipFunction>(copyType);
       assert(instantiatedType != nullptr);
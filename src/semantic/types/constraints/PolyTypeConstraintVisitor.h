@@ -1,6 +1,7 @@
 #pragma once
 
 #include "CallGraph.h"
+#include "InstantiationCache.h"
 #include "TypeConstraintVisitor.h"
 #include "Unifier.h"
 
@@ -8,18 +9,29 @@
  *
  *  \brief Visitor generates polymorphic type constraints and collects them.
  *  This visitor is called for a function with the requirement that all
- *  called functions already have a generalized type computed in the given
- *  function polymorphic type inference map.
+ *  called functions outside of its strongly connected component of the call
+ *  graph already have a generalized type computed by the unifier.  Calls to
+ *  functions within the same component are typed monomorphically.
+ *  Instantiations of generic types are made through an InstantiationCache,
+ *  which may be shared by the visitors for several functions, so that calls
+ *  whose arguments have the same types share an instance.
  */
 class PolyTypeConstraintVisitor : public TypeConstraintVisitor {
 public:
   explicit PolyTypeConstraintVisitor(
       SymbolTable *pTable, CallGraph *callGraph, std::shared_ptr<Unifier> u,
-      std::unique_ptr<ConstraintHandler> handler);
+      std::unique_ptr<ConstraintHandler> handler,
+      std::shared_ptr<InstantiationCache> cache = nullptr);
 
+  virtual bool visit(ASTFunction *element) override;
   virtual void endVisit(ASTFunAppExpr *element) override;
 
 private:
+  std::optional<InstantiationCache::Shape>
+  argumentShape(ASTFunAppExpr *element);
+
   CallGraph *callGraph;
+  ASTFunction *function = nullptr;
   std::shared_ptr<Unifier> unifier;
+  std::shared_ptr<InstantiationCache> instantiations;
 };
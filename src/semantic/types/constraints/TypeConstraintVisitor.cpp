@@ -13,7 +13,9 @@
 
 TypeConstraintVisitor::TypeConstraintVisitor(
     SymbolTable *st, std::shared_ptr<ConstraintHandler> handler)
-    : symbolTable(st), constraintHandler(std::move(handler)) {};
+    : symbolTable(st), constraintHandler(std::move(handler)),
+      intType(std::make_shared<TipInt>()),
+      boolType(std::make_shared<TipBool>()) {};
 
 /*! \fn astToVar
  *  \brief Convert an AST node to a type variable.
@@ -30,15 +32,39 @@ std::shared_ptr<TipType> TypeConstraintVisitor::astToVar(ASTNode *n)
     ASTDeclNode *canonical;
     if ((canonical = symbolTable->getLocal(ve->getName(), scope.top())))
     {
-      return std::make_shared<TipVar>(canonical);
+      n = canonical;
     }
     else if ((canonical = symbolTable->getFunction(ve->getName())))
     {
-      return std::make_shared<TipVar>(canonical);
+      n = canonical;
     }
   } // LCOV_EXCL_LINE
 
-  return std::make_shared<TipVar>(n);
+  // Each variable is made once and shared by all constraints that use it
+  auto &var = vars[n];
+  if (var == nullptr)
+  {
+    var = std::make_shared<TipVar>(n);
+  }
+  return var;
+}
+
+/*! \fn fixType
+ *  \brief Constrain the type of a node to a type its rule fixes.
+ *
+ * The type is remembered so that it can be looked up with fixedType while
+ * the constraints of the rest of the function are generated.
+ */
+void TypeConstraintVisitor::fixType(ASTNode *n, std::shared_ptr<TipType> type)
+{
+  fixedTypes[n] = type;
+  constraintHandler->handle(astToVar(n), type);
+}
+
+std::shared_ptr<TipType> TypeConstraintVisitor::fixedType(ASTNode *n)
+{
+  auto iter = fixedTypes.find(n);
+  return iter == fixedTypes.end() ? nullptr : iter->second;
 }
 
 bool TypeConstraintVisitor::visit(ASTFunction *element)
@@ -65,12 +91,12 @@ void TypeConstraintVisitor::endVisit(ASTFunction *element)
     {
       formals.push_back(astToVar(f));
       // all formals are int
-      constraintHandler->handle(astToVar(f), std::make_shared<TipInt>());
+      constraintHandler->handle(astToVar(f), intType);
     }
 
     // Return is the last statement and must be int
     auto ret = dynamic_cast<ASTReturnStmt *>(element->getStmts().back());
-    constraintHandler->handle(astToVar(ret->getArg()), std::make_shared<TipInt>());
+    constraintHandler->handle(astToVar(ret->getArg()), intType);
 
     constraintHandler->handle(
         astToVar(element->getDecl()),
@@ -100,7 +126,7 @@ void TypeConstraintVisitor::endVisit(ASTFunction *element)
  */
 void TypeConstraintVisitor::endVisit(ASTNumberExpr *element)
 {
-  constraintHandler->handle(astToVar(element), std::make_shared<TipInt>());
+  fixType(element, intType);
 }
 
 /*! \brief Type constraints for boolean literal.
@@ -110,7 +136,7 @@ void TypeConstraintVisitor::endVisit(ASTNumberExpr *element)
  */
 void TypeConstraintVisitor::endVisit(ASTBooleanExpr *element)
 {
-  constraintHandler->handle(astToVar(element), std::make_shared<TipBool>());
+  fixType(element, boolType);
 }
 
 /*! \brief Type constraints for binary operators.
@@ -125,17 +151,15 @@ void TypeConstraintVisitor::endVisit(ASTBooleanExpr *element)
 void TypeConstraintVisitor::endVisit(ASTBinaryExpr *element)
 {
   auto op = element->getOp();
-  auto intType = std::make_shared<TipInt>();
-  auto boolType = std::make_shared<TipBool>();
 
   // result type is integer
   if (op == "&" || op == "|" || op == "<" || op == ">" || op == "<=" || op == ">=" || op == "==" || op == "!=")
   {
-    constraintHandler->handle(astToVar(element), boolType);
+    fixType(element, boolType);
   }
   else if (op == "+" || op == "-" || op == "*" || op == "/" || op == "%")
   {
-    constraintHandler->handle(astToVar(element), intType);
+    fixType(element, intType);
   }
 
   if (op == "&" || op == "|")
@@ -165,7 +189,17 @@ void TypeConstraintVisitor::endVisit(ASTBinaryExpr *element)
  */
 void TypeConstraintVisitor::endVisit(ASTInputExpr *element)
 {
-  constraintHandler->handle(astToVar(element), std::make_shared<TipInt>());
+  fixType(element, intType);
+}
+
+/*! \brief Type constraints for clock expression.
+ *
+ * Type rules for "clock":
+ *  [[clock]] = int
+ */
+void TypeConstraintVisitor::endVisit(ASTClockExpr *element)
+{
+  fixType(element, intType);
 }
 
 /*! \brief Type constraints for function application.
@@ -266,8 +300,7 @@ void TypeConstraintVisitor::endVisit(ASTAssignStmt *element)
  */
 void TypeConstraintVisitor::endVisit(ASTWhileStmt *element)
 {
-  constraintHandler->handle(astToVar(element->getCondition()),
-                            std::make_shared<TipBool>());
+  constraintHandler->handle(astToVar(element->getCondition()), boolType);
 }
 
 /*! \brief Type constraints for for loop.
@@ -279,16 +312,12 @@ void TypeConstraintVisitor::endVisit(ASTWhileStmt *element)
  */
 void TypeConstraintVisitor::endVisit(ASTForLoopStmt *element)
 {
-  constraintHandler->handle(astToVar(element->getVar()),
-                            std::make_shared<TipInt>());
-  constraintHandler->handle(astToVar(element->getStart()),
-                            std::make_shared<TipInt>());
-  constraintHandler->handle(astToVar(element->getEnd()),
-                            std::make_shared<TipInt>());
+  constraintHandler->handle(astToVar(element->getVar()), intType);
+  constraintHandler->handle(astToVar(element->getStart()), intType);
+  constraintHandler->handle(astToVar(element->getEnd()), intType);
   if (element->getStep())
   {
-    constraintHandler->handle(astToVar(element->getStep()),
-                              std::make_shared<TipInt>());
+    constraintHandler->handle(astToVar(element->getStep()), intType);
   }
 }
 
@@ -316,8 +345,7 @@ void TypeConstraintVisitor::endVisit(ASTIterStmt *element)
  */
 void TypeConstraintVisitor::endVisit(ASTIfStmt *element)
 {
-  constraintHandler->handle(astToVar(element->getCondition()),
-                            std::make_shared<TipBool>());
+  constraintHandler->handle(astToVar(element->getCondition()), boolType);
 }
 
 /*! \brief Type constraints for ternary expressions.
@@ -328,8 +356,7 @@ void TypeConstraintVisitor::endVisit(ASTIfStmt *element)
  */
 void TypeConstraintVisitor::endVisit(ASTTernaryExpr *element)
 {
-  constraintHandler->handle(astToVar(element->getCondition()),
-                            std::make_shared<TipBool>());
+  constraintHandler->handle(astToVar(element->getCondition()), boolType);
   constraintHandler->handle(astToVar(element->getTrueExpr()),
                             astToVar(element->getFalseExpr()));
   constraintHandler->handle(astToVar(element),
@@ -343,8 +370,7 @@ void TypeConstraintVisitor::endVisit(ASTTernaryExpr *element)
  */
 void TypeConstraintVisitor::endVisit(ASTOutputStmt *element)
 {
-  constraintHandler->handle(astToVar(element->getArg()),
-                            std::make_shared<TipInt>());
+  constraintHandler->handle(astToVar(element->getArg()), intType);
 }
 
 /*! \brief Type constraints for array initializations.
@@ -408,7 +434,7 @@ void TypeConstraintVisitor::endVisit(ASTArrayOfExpr *element)
   std::shared_ptr<TipType> elementType;
 
   lengthType = astToVar(element->getLength());
-  constraintHandler->handle(lengthType, std::make_shared<TipInt>());
+  constraintHandler->handle(lengthType, intType);
   elementType = astToVar(element->getElement());
 
   constraintHandler->handle(astToVar(element),
@@ -431,7 +457,7 @@ void TypeConstraintVisitor::endVisit(ASTArrayRefExpr *element)
   std::shared_ptr<TipType> arrayType;
 
   indexType = astToVar(element->getIndex());
-  constraintHandler->handle(indexType, std::make_shared<TipInt>());
+  constraintHandler->handle(indexType, intType);
   arrayType = astToVar(element->getArray());
 
   std::shared_ptr<TipType> resultType = astToVar(element);
@@ -457,22 +483,22 @@ void TypeConstraintVisitor::endVisit(ASTUnaryExpr *element)
 {
   if (element->getOp() == "#")
   {
-    constraintHandler->handle(astToVar(element), std::make_shared<TipInt>());
+    fixType(element, intType);
   }
   else if (element->getOp() == "!")
   {
-    constraintHandler->handle(astToVar(element), std::make_shared<TipBool>());
-    constraintHandler->handle(astToVar(element->getExpr()), std::make_shared<TipBool>());
+    fixType(element, boolType);
+    constraintHandler->handle(astToVar(element->getExpr()), boolType);
   }
   else if (element->getOp() == "-")
   {
-    constraintHandler->handle(astToVar(element), std::make_shared<TipInt>());
-    constraintHandler->handle(astToVar(element->getExpr()), std::make_shared<TipInt>());
+    fixType(element, intType);
+    constraintHandler->handle(astToVar(element->getExpr()), intType);
   }
   else if (element->getOp() == "++" || element->getOp() == "--")
   {
-    constraintHandler->handle(astToVar(element), std::make_shared<TipInt>());
-    constraintHandler->handle(astToVar(element->getExpr()), std::make_shared<TipInt>());
+    fixType(element, intType);
+    constraintHandler->handle(astToVar(element->getExpr()), intType);
   }
 }
 
@@ -541,6 +567,5 @@ void TypeConstraintVisitor::endVisit(ASTAccessExpr *element)
  */
 void TypeConstraintVisitor::endVisit(ASTErrorStmt *element)
 {
-  constraintHandler->handle(astToVar(element->getArg()),
-                            std::make_shared<TipInt>());
+  constraintHandler->handle(astToVar(element->getArg()), intType);
 }
@@ -8,6 +8,7 @@
 #include <set>
 #include <stack>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 /*! \class TypeConstraintVisitor
@@ -54,6 +55,7 @@ public:
   void endVisit(ASTFunction *element) override;
   void endVisit(ASTIfStmt *element) override;
   void endVisit(ASTInputExpr *element) override;
+  void endVisit(ASTClockExpr *element) override;
   void endVisit(ASTNullExpr *element) override;
   void endVisit(ASTNumberExpr *element) override;
   void endVisit(ASTOutputStmt *element) override;
@@ -70,6 +72,22 @@ protected:
   SymbolTable *symbolTable;
   std::shared_ptr<TipType> astToVar(ASTNode *n);
 
+  // Constrain a node to a type fixed by its own rule, e.g., int for a literal
+  void fixType(ASTNode *n, std::shared_ptr<TipType> type);
+
+  // The type fixed for a node whose constraints were generated, or nullptr
+  std::shared_ptr<TipType> fixedType(ASTNode *n);
+
+  // Types without subterms are shared by all constraints that use them
+  std::shared_ptr<TipType> intType;
+  std::shared_ptr<TipType> boolType;
+
 private:
   std::stack<ASTDeclNode *> scope;
+
+  // Type variables made so far, keyed by the node they stand for
+  std::unordered_map<ASTNode *, std::shared_ptr<TipType>> vars;
+
+  // Types fixed by the rules of the nodes visited so far
+  std::unordered_map<ASTNode *, std::shared_ptr<TipType>> fixedTypes;
 };
@@ -0,0 +1,134 @@
+#include "TypeTermStore.h"
+#include "Type.h"
+
+#include <functional>
+#include <stdexcept>
+
+bool TypeTermStore::Key::operator==(const Key &other) const {
+  return kind == other.kind && children == other.children &&
+         node == other.node && context == other.context && name == other.name;
+}
+
+std::size_t TypeTermStore::KeyHash::operator()(const Key &key) const {
+  auto combine = [](std::size_t seed, std::size_t h) {
+    return seed ^ (h + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2));
+  };
+  std::size_t h = key.kind;
+  for (auto child : key.children) {
+    h = combine(h, child);
+  }
+  h = combine(h, std::hash<const void *>()(key.node));
+  h = combine(h, std::hash<const void *>()(key.context));
+  return combine(h, std::hash<std::string>()(key.name));
+}
+
+/*! \brief Determine the constructor of a term.
+ * We explicitly test the types here which is not robust to the addition of
+ * new subtypes of TipType.  Extend this if you add such a subtype.
+ */
+TypeTermStore::Kind TypeTermStore::kindOf(const TipType *t) {
+  if (dynamic_cast<const TipAlpha *>(t)) {
+    return ALPHA;
+  } else if (dynamic_cast<const TipVar *>(t)) {
+    return VAR;
+  } else if (dynamic_cast<const TipFunction *>(t)) {
+    return FUNCTION;
+  } else if (dynamic_cast<const TipRecord *>(t)) {
+    return RECORD;
+  } else if (dynamic_cast<const TipRef *>(t)) {
+    return REF;
+  } else if (dynamic_cast<const SipArray *>(t)) {
+    return ARRAY;
+  } else if (dynamic_cast<const TipMu *>(t)) {
+    return MU;
+  } else if (dynamic_cast<const TipInt *>(t)) {
+    return INT;
+  } else if (dynamic_cast<const TipBool *>(t)) {
+    return BOOL;
+  }
+  return ABSENT;
+}
+
+/*
+ * Make a shallow copy of t over the given canonical subterms.  Only terms
+ * with subterms are ever rebuilt.
+ */
+std::shared_ptr<TipType>
+TypeTermStore::rebuild(const std::shared_ptr<TipType> &t,
+                       const std::vector<std::shared_ptr<TipType>> &children) {
+  switch (kindOf(t.get())) {
+  case FUNCTION: {
+    std::vector<std::shared_ptr<TipType>> params(children.begin(),
+                                                 children.end() - 1);
+    return std::make_shared<TipFunction>(params, children.back());
+  }
+  case RECORD: {
+    auto record = std::dynamic_pointer_cast<TipRecord>(t);
+    return std::make_shared<TipRecord>(children, record->getNames());
+  }
+  case REF:
+    return std::make_shared<TipRef>(children.front());
+  case ARRAY:
+    return std::make_shared<SipArray>(children.front());
+  case MU:
+    return std::make_shared<TipMu>(
+        std::dynamic_pointer_cast<TipVar>(children.front()), children.back());
+  default:
+    return t;
+  }
+}
+
+TypeTermStore::TermId TypeTermStore::intern(std::shared_ptr<TipType> t) {
+  if (t == nullptr) {
+    throw std::invalid_argument("Refusing to insert a nullptr into the map.");
+  }
+
+  auto idIter = ids.find(t.get());
+  if (idIter != ids.end()) {
+    return idIter->second;
+  }
+
+  Key key;
+  key.kind = kindOf(t.get());
+
+  // Canonicalize the subterms first
+  std::vector<std::shared_ptr<TipType>> children;
+  if (auto cons = std::dynamic_pointer_cast<TipCons>(t)) {
+    children = cons->getArguments();
+  } else if (auto mu = std::dynamic_pointer_cast<TipMu>(t)) {
+    children = {mu->getV(), mu->getT()};
+  } else if (auto var = std::dynamic_pointer_cast<TipVar>(t)) {
+    key.node = var->getNode();
+    if (auto alpha = std::dynamic_pointer_cast<TipAlpha>(t)) {
+      key.context = alpha->getContext();
+      key.name = alpha->getName();
+    }
+  }
+
+  bool isCanonical = true;
+  for (auto &child : children) {
+    auto id = intern(child);
+    key.children.push_back(id);
+    if (terms[id] != child) {
+      isCanonical = false;
+      child = terms[id];
+    }
+  }
+
+  TermId id;
+  auto indexIter = index.find(key);
+  if (indexIter != index.end()) {
+    id = indexIter->second;
+  } else {
+    id = terms.size();
+    terms.push_back(isCanonical ? t : rebuild(t, children));
+    ids.emplace(terms.back().get(), id);
+    index.emplace(std::move(key), id);
+  }
+  return id;
+}
+
+std::shared_ptr<TipType>
+TypeTermStore::canonical(std::shared_ptr<TipType> t) {
+  return terms[intern(std::move(t))];
+}
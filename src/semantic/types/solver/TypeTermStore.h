@@ -0,0 +1,97 @@
+#pragma once
+
+#include "TipType.h"
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class ASTNode;
+
+/*!
+ * \class TypeTermStore
+ *
+ * \brief Hash-consing arena for type terms.
+ *
+ * Interning a term yields a canonical node that is shared by all terms that
+ * are equal under TipType::operator==.  The subterms of a canonical node are
+ * canonical themselves, so two canonical terms are equal exactly when they
+ * are the same node, and equality can be decided by comparing pointers or
+ * term ids.  Canonical nodes are ordinary TipTypes, so they can be printed
+ * and traversed with a TipTypeVisitor as usual.
+ *
+ * Terms are assumed to be immutable once interned.  Only canonical nodes are
+ * kept by the store; other terms interned are left to their owners, so the
+ * many short-lived copies made while solving are freed as soon as they are
+ * no longer used.
+ */
+class TypeTermStore {
+public:
+  using TermId = std::size_t;
+
+  TypeTermStore() = default;
+
+  /*! \brief Intern a term and all of its subterms.
+   *
+   * The first term interned for a given structure becomes its canonical node
+   * if its subterms are canonical; otherwise a shallow copy over the
+   * canonical subterms is made.  In particular, type variables are always
+   * canonicalized to the first instance that was interned.
+   * \param t The term to intern.
+   * \return The dense id of the canonical node for t.
+   * \throws std::invalid_argument when t is a nullptr.
+   */
+  TermId intern(std::shared_ptr<TipType> t);
+
+  /*! \brief Return the canonical node equal to t.
+   */
+  std::shared_ptr<TipType> canonical(std::shared_ptr<TipType> t);
+
+  /*! \brief Return the canonical node with the given id.
+   */
+  const std::shared_ptr<TipType> &term(TermId id) const { return terms[id]; }
+
+  //! \brief Number of canonical nodes in the store.
+  std::size_t size() const { return terms.size(); }
+
+private:
+  enum Kind { VAR, ALPHA, FUNCTION, RECORD, REF, ARRAY, MU, INT, BOOL, ABSENT };
+
+  /*
+   * Terms are identified by their constructor, the ids of their canonical
+   * subterms and, for type variables, the data distinguishing them.  Record
+   * field names are ignored just as they are by TipRecord::operator==.
+   */
+  struct Key {
+    Kind kind;
+    std::vector<TermId> children;
+    ASTNode *node = nullptr;
+    ASTNode *context = nullptr;
+    std::string name;
+
+    bool operator==(const Key &other) const;
+  };
+
+  struct KeyHash {
+    std::size_t operator()(const Key &key) const;
+  };
+
+  static Kind kindOf(const TipType *t);
+
+  static std::shared_ptr<TipType>
+  rebuild(const std::shared_ptr<TipType> &t,
+          const std::vector<std::shared_ptr<TipType>> &children);
+
+  // Canonical nodes indexed by their term id.
+  std::vector<std::shared_ptr<TipType>> terms;
+
+  /*
+   * Term ids of the canonical nodes keyed by address.  The store owns these
+   * nodes, so an address cannot be reused by another term while it is here.
+   */
+  std::unordered_map<const TipType *, TermId> ids;
+
+  // Term ids of the canonical nodes keyed by structure.
+  std::unordered_map<Key, TermId, KeyHash> index;
+};
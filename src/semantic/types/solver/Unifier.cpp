@@ -15,20 +15,24 @@
 
 namespace { // Anonymous namespace for local helper functions
 
-bool contains(std::set<std::shared_ptr<TipVar>> s, std::shared_ptr<TipVar> t) {
-  // LOG_S(3) << "Contains looking for " << *t;
-  for (auto e : s) {
-    if (*e.get() == *t.get()) {
-      // LOG_S(3) << "Contains found " << *e;
+// Canonical terms are equal iff identical, so they are looked up by address
+bool contains(const std::set<std::shared_ptr<TipType>> &s,
+              const std::shared_ptr<TipType> &t) {
+  return s.find(t) != s.end();
+}
+
+// The free variables of a type are fresh copies, so they are compared by value
+bool containsEqual(const std::set<std::shared_ptr<TipVar>> &s,
+                   const std::shared_ptr<TipVar> &t) {
+  for (auto &e : s) {
+    if (*e == *t) {
       return true;
     }
-    // LOG_S(3) << "Contains checking " << *e;
   }
-  // LOG_S(3) << "Contains not found";
   return false;
 }
 
-std::string print(std::set<std::shared_ptr<TipVar>> varSet) {
+template <typename T> std::string print(const std::set<T> &varSet) {
   std::stringstream s;
   s << "{ ";
   for (auto v : varSet) {
@@ -42,61 +46,38 @@ std::string print(std::set<std::shared_ptr<TipVar>> varSet) {
 
 Unifier::Unifier() : unionFind(std::move(std::make_shared<UnionFind>())) {}
 
-Unifier::Unifier(std::vector<TypeConstraint> constrs)
-    : constraints(std::move(constrs)) {
-  std::vector<std::shared_ptr<TipType>> types;
-  for (TypeConstraint &constraint : constraints) {
-    auto lhs = constraint.lhs;
-    auto rhs = constraint.rhs;
-    types.push_back(lhs);
-    types.push_back(rhs);
-
-    if (auto f1 = std::dynamic_pointer_cast<TipCons>(lhs)) {
-      for (auto &a : f1->getArguments()) {
-        types.push_back(a);
-      }
-    }
-    if (auto f2 = std::dynamic_pointer_cast<TipCons>(rhs)) {
-      for (auto &a : f2->getArguments()) {
-        types.push_back(a);
-      }
-    }
-  }
-
-  unionFind = std::make_shared<UnionFind>(types);
+Unifier::Unifier(std::vector<TypeConstraint> constrs) : Unifier() {
+  add(std::move(constrs));
 }
 
+/*
+ * The constraints are kept over canonical terms, which also adds the terms to
+ * the union-find structure.  The terms of the constraints passed in are then
+ * freed with them unless the caller keeps them.
+ */
 void Unifier::add(std::vector<TypeConstraint> constrs) {
-  std::vector<std::shared_ptr<TipType>> types;
+  closedTypes.clear();
+  closedReps.clear();
+
+  constraints.reserve(constraints.size() + constrs.size());
   for (TypeConstraint &constraint : constrs) {
-    // Add to the stored constraints
-    constraints.push_back(constraint);
-
-    // Extract the underylying types terms to add to the union-find structure
-    auto lhs = constraint.lhs;
-    auto rhs = constraint.rhs;
-    types.push_back(lhs);
-    types.push_back(rhs);
-
-    if (auto f1 = std::dynamic_pointer_cast<TipCons>(lhs)) {
-      for (auto &a : f1->getArguments()) {
-        types.push_back(a);
-      }
-    }
-    if (auto f2 = std::dynamic_pointer_cast<TipCons>(rhs)) {
-      for (auto &a : f2->getArguments()) {
-        types.push_back(a);
-      }
-    }
+    constraints.emplace_back(unionFind->canonical(constraint.lhs),
+                             unionFind->canonical(constraint.rhs));
   }
-
-  unionFind->add(types);
 }
 
 void Unifier::solve() {
-  for (TypeConstraint &constraint : constraints) {
-    unify(constraint.lhs, constraint.rhs);
+  for (; solved < constraints.size(); solved++) {
+    unify(constraints[solved].lhs, constraints[solved].rhs);
+  }
+}
+
+std::vector<TypeConstraint> Unifier::solution() {
+  std::vector<TypeConstraint> result;
+  for (auto &binding : unionFind->bindings()) {
+    result.emplace_back(binding.first, binding.second);
   }
+  return result;
 }
 
 /*! \fn unify
@@ -120,13 +101,21 @@ void Unifier::solve() {
  */
 void Unifier::unify(std::shared_ptr<TipType> t1, std::shared_ptr<TipType> t2) {
   LOG_S(3) << "Unifying " << *t1 << " and " << *t2;
+  unifications++;
+
+  // Unifying may change the solution the cached types were closed in
+  if (!closedTypes.empty() || !closedReps.empty()) {
+    closedTypes.clear();
+    closedReps.clear();
+  }
 
   auto rep1 = unionFind->find(t1);
   auto rep2 = unionFind->find(t2);
 
   LOG_S(3) << "Unifying with representatives " << *rep1 << " and " << *rep2;
 
-  if (*rep1 == *rep2) {
+  // Representatives are canonical terms so they are equal iff identical
+  if (rep1 == rep2) {
     return;
   }
 
@@ -167,30 +156,46 @@ void Unifier::unify(std::shared_ptr<TipType> t1, std::shared_ptr<TipType> t2) {
  * the type expression (i.e., the one's not bound in mu quantifiers).
  * \sa Substituter
  * \sa TypeVars
+ *
+ * The variables being closed are tracked in visited, which holds their
+ * canonical terms and is restored before returning.  The closed type of a
+ * representative is cached until the solution changes, unless closing it
+ * ended at a variable that was already being closed, since the result then
+ * depends on where the representative was reached from.
  */
 std::shared_ptr<TipType>
 Unifier::close(std::shared_ptr<TipType> type,
-               std::set<std::shared_ptr<TipVar>> visited) {
+               std::set<std::shared_ptr<TipType>> &visited) {
 
   if (isVar(type)) {
     auto v = std::dynamic_pointer_cast<TipVar>(type);
+    auto key = unionFind->canonical(v);
+    auto rep = unionFind->find(v);
 
     LOG_S(3) << "Close starting var " << *v << " with visited "
              << print(visited);
     LOG_S(3) << "Close starting var " << *v << " with union-find "
              << *unionFind;
 
-    if (!contains(visited, v) && (unionFind->find(v) != v)) {
+    if (!contains(visited, key) && rep != key) {
       // No cyclic reference to v and it does not map to itself
-      visited.insert(v);
+      LOG_S(3) << "Close var " << *v << " does not map to itself, it maps to "
+               << *rep;
 
-      if (unionFind->find(v) != v) {
-        LOG_S(3) << "Close var " << *v << " does not map to itself, it maps to "
-                 << *unionFind->find(v);
+      std::shared_ptr<TipType> closedV;
+      auto cached = closedReps.find(rep.get());
+      if (cached != closedReps.end()) {
+        closedV = cached->second;
+      } else {
+        auto cutsBefore = cycleCuts;
+        visited.insert(key);
+        closedV = close(rep, visited);
+        visited.erase(key);
+        if (cycleCuts == cutsBefore) {
+          closedReps.emplace(rep.get(), closedV);
+        }
       }
 
-      auto closedV = close(unionFind->find(v), visited);
-
       // If the variable is an alpha, then reuse it else create a new alpha with
       // the node.
       auto newV = (isAlpha(v)) ? v : std::make_shared<TipAlpha>(v->getNode());
@@ -200,7 +205,7 @@ Unifier::close(std::shared_ptr<TipType> type,
 
       auto freeV = TypeVars::collect(closedV.get());
 
-      if ((*closedV.get() != *newV.get()) && contains(freeV, newV)) {
+      if ((*closedV.get() != *newV.get()) && containsEqual(freeV, newV)) {
         // Cyclic reference requires a mu type constructor
         auto substClosedV =
             Substituter::substitute(closedV.get(), v.get(), newV);
@@ -219,6 +224,10 @@ Unifier::close(std::shared_ptr<TipType> type,
         return closedV;
       }
     } else {
+      if (contains(visited, key)) {
+        cycleCuts++;
+      }
+
       // Unconstrained type variable - should we start with fresh names to make
       // output cleaner?
       auto alpha = std::make_shared<TipAlpha>(v->getNode());
@@ -290,10 +299,21 @@ Unifier::close(std::shared_ptr<TipType> type,
  * their base types.  The close() function may update
  * the unionFind structure, by generating new types, and this
  * is essential for the staged nature of polymorphic type inference.
+ * Closed types are memoized until the next call to add or unify.
  */
 std::shared_ptr<TipType> Unifier::inferred(std::shared_ptr<TipType> v) {
-  std::set<std::shared_ptr<TipVar>> visited;
+  std::lock_guard<std::mutex> lock(closeMutex);
+
+  // Equal types close to equal types, so the canonical term is the key
+  auto key = unionFind->canonical(v);
+  auto iter = closedTypes.find(key.get());
+  if (iter != closedTypes.end()) {
+    return iter->second;
+  }
+
+  std::set<std::shared_ptr<TipType>> visited;
   auto closedV = close(v, visited);
+  closedTypes.emplace(key.get(), closedV);
   return closedV;
 }
 
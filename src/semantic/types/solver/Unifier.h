@@ -4,7 +4,10 @@
 #include "TipVar.h"
 #include "TypeConstraint.h"
 #include "UnionFind.h"
+#include <cstddef>
+#include <mutex>
 #include <set>
+#include <unordered_map>
 #include <vector>
 
 /*!
@@ -46,15 +49,33 @@ public:
    * \pre The unifier has been constructed with seed values. 
    * Incremental solving can be achieved by adding constraints, via
    * the add method, after solving.  This will cause the new constraints
-   * to be unified with the currently unified constraints.
+   * to be unified with the currently unified constraints.  Only the
+   * constraints added since the last call are unified, the earlier ones
+   * already hold in the union-find structure.
    */
   void solve();
 
+  /*! \brief Constraints that hold exactly when the solved constraints do.
+   * \pre The unifier has computed a solution.
+   * Each term is equated with the representative of its class, so adding
+   * these constraints to another unifier merges the solution into it
+   * without solving the original constraints again.
+   */
+  std::vector<TypeConstraint> solution();
+
+  /*! \brief Number of calls to unify made so far, including the calls
+   * made for the subterms of type constructors.
+   */
+  std::size_t getUnificationCount() const { return unifications; }
+
   /*! \brief Returns the inferred type for a given type.
    * \pre The unifier has computed a solution.
    * This will close the type by replacing any variables that
    * are bound to proper types in the inferred solution with that
-   * proper type.
+   * proper type.  It may be called concurrently from several threads, but
+   * not concurrently with add, solve or unify.  Closed types are cached
+   * until the solution changes, so repeated queries for the same type are
+   * answered without closing it again.
    */
   std::shared_ptr<TipType> inferred(std::shared_ptr<TipType> t);
 
@@ -66,10 +87,26 @@ public:
 
 private:
   std::shared_ptr<TipType> close(std::shared_ptr<TipType> type,
-                                 std::set<std::shared_ptr<TipVar>> visited);
+                                 std::set<std::shared_ptr<TipType>> &visited);
   void throwUnifyException(std::shared_ptr<TipType> TipType1,
                            std::shared_ptr<TipType> TipType2);
 
   std::vector<TypeConstraint> constraints;
   std::shared_ptr<UnionFind> unionFind;
+
+  // Number of constraints that have been unified by solve
+  std::size_t solved = 0;
+  std::size_t unifications = 0;
+
+  // Serializes closing of types, which updates the union-find structure
+  std::mutex closeMutex;
+
+  // Closed types keyed by the canonical term they were computed for
+  std::unordered_map<const TipType *, std::shared_ptr<TipType>> closedTypes;
+
+  // Closed types of the representatives closed since the solution changed
+  std::unordered_map<const TipType *, std::shared_ptr<TipType>> closedReps;
+
+  // Number of times closing reached a variable that was already being closed
+  std::size_t cycleCuts = 0;
 };
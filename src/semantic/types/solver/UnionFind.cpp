@@ -1,61 +1,43 @@
 #include "UnionFind.h"
-#include "Copier.h"
 
 #include "loguru.hpp"
-#include <algorithm>
+#include <cassert>
 #include <set>
+#include <sstream>
 #include <string>
 
-namespace { // Anonymous namespace for local helpers
-bool verbose = false;
-
-bool equalType(std::shared_ptr<TipType> t1, std::shared_ptr<TipType> t2) {
-  return *(t1.get()) == *(t2.get());
-}
-} // namespace
-
-// Check Union-Find data structure invariants
-void UnionFind::invariant() {
-    // No two edges in the Union-Find structure should the same originating
-    // TipType
-    for(auto outerIter = edges.begin(); outerIter != edges.end(); outerIter++) {
-        const auto& edge1 = *outerIter;
-        auto innerIter = outerIter;
-        innerIter++;
-        for(; innerIter != edges.end(); innerIter++) {
-            const auto& edge2 = *innerIter;
-            if(equalType(edge1.first, edge2.first)) {
-                LOG_S(3) << "UnionFind invariant violated found pair of edges: "
-                         << *edge1.first << "(" << edge1.first.get() << ") => "
-                         << *edge1.second << " and " << *edge2.first << "("
-                         << edge2.first.get() << ") => " << *edge2.second;
-                assert(!equalType(edge1.first, edge2.first));
-            }
-        }
-    }
-}
-
-std::shared_ptr<TipType> UnionFind::lookup(std::shared_ptr<TipType> t) {
-  for (auto const &edge : edges) {
-    if (equalType(t, edge.first)) {
-      return edge.second;
+/*
+ * Check Union-Find data structure invariants for the terms with ids from
+ * "from" onwards.  Only terms added since the last check can violate them, so
+ * the check is proportional to the size of the batch rather than the forest.
+ * Uniqueness of terms is guaranteed by the store.  It is compiled in debug
+ * builds only.
+ */
+void UnionFind::invariant(std::size_t from) {
+#ifdef TIPC_DEBUG
+  for (auto id = from; id < parents.size(); id++) {
+    // Representatives must be members of the class they represent
+    auto r = root(id);
+    if (root(representatives[r]) != r) {
+      LOG_S(3) << "UnionFind invariant violated representative "
+               << *store.term(representatives[r]) << " is not in the class of "
+               << *store.term(id);
+      assert(root(representatives[r]) == r);
     }
   }
-  return nullptr;
+#endif
 }
 
 UnionFind::UnionFind(std::vector<std::shared_ptr<TipType>> seed) {
-  for (auto &term : seed) {
-    smart_insert(term);
-  }
-  invariant();
+  add(seed);
 }
 
 void UnionFind::add(std::vector<std::shared_ptr<TipType>> seed) {
+  auto from = parents.size();
   for (auto &term : seed) {
     smart_insert(term);
   }
-  invariant();
+  invariant(from);
 }
 
 std::ostream &operator<<(std::ostream &os, const UnionFind &obj) {
@@ -64,10 +46,15 @@ std::ostream &operator<<(std::ostream &os, const UnionFind &obj) {
 
 std::ostream &UnionFind::print(std::ostream &out) const {
   std::set<std::string> edgeSet;
-  for (auto edge : edges) {
+  for (std::size_t id = 0; id < parents.size(); id++) {
+    // Find the root without compressing so that printing stays const
+    auto r = id;
+    while (parents[r] != r) {
+      r = parents[r];
+    }
     std::stringstream edgeStr;
-    edgeStr << "  " << *edge.first << "(" << edge.first.get() << ")"
-            << " => " << *edge.second;
+    edgeStr << "  " << *store.term(id) << "(" << store.term(id).get() << ")"
+            << " => " << *store.term(representatives[r]);
     edgeSet.insert(edgeStr.str());
   }
   out << "UnionFind edges {\n";
@@ -78,89 +65,87 @@ std::ostream &UnionFind::print(std::ostream &out) const {
   return out;
 }
 
+std::size_t UnionFind::root(std::size_t id) {
+  // Path halving: every other node on the path is pointed at its grandparent
+  while (parents[id] != id) {
+    parents[id] = parents[parents[id]];
+    id = parents[id];
+  }
+  return id;
+}
+
 std::shared_ptr<TipType> UnionFind::find(std::shared_ptr<TipType> t) {
   LOG_S(3) << "UnionFind looking for representive of " << *t;
 
-  t = smart_insert(t);
-
-  auto parent = t;
-  while (!equalType(get_parent(parent), parent)) {
-    parent = get_parent(parent);
-  }
+  auto representative =
+      store.term(representatives[root(smart_insert(t))]);
 
-  LOG_S(3) << "UnionFind found representative " << *parent;
+  LOG_S(3) << "UnionFind found representative " << *representative;
 
-  invariant();
+  return representative;
+}
 
-  return parent;
+std::shared_ptr<TipType> UnionFind::canonical(std::shared_ptr<TipType> t) {
+  return store.term(smart_insert(t));
 }
 
+/*
+ * Joins the classes of t1 and t2.  The representative of t2's class becomes
+ * the representative of the joined class, independent of which root ends up
+ * on top of the tree.
+ */
 void UnionFind::quick_union(std::shared_ptr<TipType> t1,
                             std::shared_ptr<TipType> t2) {
-  t1 = smart_insert(t1);
-  t2 = smart_insert(t2);
-
-  auto t1_root = find(t1);
-  auto t2_root = find(t2);
-
-  // semantics-based insert
-  for (auto const &edge : edges) {
-    // THINK
-    if (equalType(t1_root, edge.first)) {
-      LOG_S(3) << "UnionFind replacing " << *edge.first << " => "
-               << *edge.second << " with " << *t1_root << " => " << *t2_root;
-      edges.erase(edge.first);
-      edges.insert(
-          std::pair<std::shared_ptr<TipType>, std::shared_ptr<TipType>>(
-              t1_root, t2_root));
-      break;
-    }
+  auto t1_root = root(smart_insert(t1));
+  auto t2_root = root(smart_insert(t2));
+  if (t1_root == t2_root) {
+    return;
   }
 
-  invariant();
+  LOG_S(3) << "UnionFind joining " << *store.term(representatives[t1_root])
+           << " with " << *store.term(representatives[t2_root]);
+
+  auto representative = representatives[t2_root];
+  if (ranks[t1_root] > ranks[t2_root]) {
+    std::swap(t1_root, t2_root);
+  } else if (ranks[t1_root] == ranks[t2_root]) {
+    ranks[t2_root]++;
+  }
+  parents[t1_root] = t2_root;
+  representatives[t2_root] = representative;
 }
 
 bool UnionFind::connected(std::shared_ptr<TipType> t1,
                           std::shared_ptr<TipType> t2) {
-  return *find(t1) == *find(t2);
+  return root(smart_insert(t1)) == root(smart_insert(t2));
 } // LCOV_EXCL_LINE
 
-/*! \fn get_parent
- *
- * Unification ensures that the forest that includes all relevant type nodes.
- * A tree within the forest is traversed by directed edges to the parent.
- * During closure of terms, new type nodes may be generated by substitution.
- * When they are encountered they are added to the forest.
- */
-std::shared_ptr<TipType> UnionFind::get_parent(std::shared_ptr<TipType> t) {
-  auto parent = lookup(t);
-
-  if (parent != nullptr)
-    return parent;
-
-  auto inserted = smart_insert(t);
-
-  invariant();
-
-  return inserted;
+std::vector<std::pair<std::shared_ptr<TipType>, std::shared_ptr<TipType>>>
+UnionFind::bindings() {
+  std::vector<std::pair<std::shared_ptr<TipType>, std::shared_ptr<TipType>>>
+      result;
+  for (std::size_t id = 0; id < parents.size(); id++) {
+    auto representative = representatives[root(id)];
+    if (representative != id) {
+      result.emplace_back(store.term(id), store.term(representative));
+    }
+  }
+  return result;
 }
 
 /**
- * Inserts should be based on the dereferenced value.
+ * Inserts should be based on the dereferenced value.  The store interns the
+ * term and its subterms, all of which become singleton classes if new.
  */
-std::shared_ptr<TipType> UnionFind::smart_insert(std::shared_ptr<TipType> t) {
-  if (t == nullptr) {
-    throw std::invalid_argument("Refusing to insert a nullptr into the map.");
+std::size_t UnionFind::smart_insert(std::shared_ptr<TipType> t) {
+  auto id = store.intern(t);
+
+  for (auto newId = parents.size(); newId < store.size(); newId++) {
+    LOG_S(3) << "UnionFind adding " << *store.term(newId) << " to graph";
+    parents.push_back(newId);
+    ranks.push_back(0);
+    representatives.push_back(newId);
   }
 
-  if (lookup(t) != nullptr)
-    return lookup(t);
-
-  LOG_S(3) << "UnionFind adding " << *t << " to graph";
-  edges.insert(
-      std::pair<std::shared_ptr<TipType>, std::shared_ptr<TipType>>(t, t));
-
-  invariant();
-
-  return t;
+  return id;
 }
@@ -1,8 +1,10 @@
 #pragma once
 
+#include "TypeTermStore.h"
 #include <TipType.h>
+#include <cstddef>
 #include <iostream>
-#include <map>
+#include <utility>
 #include <vector>
 
 /*!
@@ -10,6 +12,15 @@
  *
  * \brief Specialized implementation of a union-find data structure tailored to
  * work with TipTypes wrapped in shared pointers.
+ *
+ * Terms are hash-consed in a TypeTermStore, which gives each structurally
+ * distinct term a dense term id, and find returns canonical terms so they can
+ * be compared by pointer.  The forest is stored over the term ids and uses
+ * path compression and union by rank.  Union by rank only shapes the trees;
+ * the canonical representative of a class is tracked separately so that the
+ * term passed as the second argument of quick_union always becomes the
+ * representative, as required by the Unifier to ensure that proper types win
+ * over type variables.
  */
 class UnionFind {
 public:
@@ -22,24 +33,45 @@ public:
   void add(std::vector<std::shared_ptr<TipType>> seed);
 
   std::shared_ptr<TipType> find(std::shared_ptr<TipType> t1);
+
+  /*! \brief Return the canonical term equal to t, adding it if necessary.
+   *
+   * Unlike find this does not consult the equivalence classes, so terms
+   * that have been unified still have distinct canonical terms.
+   */
+  std::shared_ptr<TipType> canonical(std::shared_ptr<TipType> t);
   void quick_union(std::shared_ptr<TipType> t1, std::shared_ptr<TipType> t2);
   bool connected(std::shared_ptr<TipType> t1, std::shared_ptr<TipType> t2);
 
+  /*! \brief Pair each term that does not represent its class with the
+   * representative of its class, in the order the terms were added.
+   */
+  std::vector<std::pair<std::shared_ptr<TipType>, std::shared_ptr<TipType>>>
+  bindings();
+
   friend std::ostream &operator<<(std::ostream &os, const UnionFind &obj);
 
 private:
-  // A mapping from terms to parents.
-  std::map<std::shared_ptr<TipType>, std::shared_ptr<TipType>> edges;
+  // Hash-consed terms, the forest is kept over their term ids.
+  TypeTermStore store;
+
+  // Parent term id of each term; roots are their own parent.
+  std::vector<std::size_t> parents;
+
+  // Upper bound on the height of the tree rooted at each term.
+  std::vector<std::size_t> ranks;
 
-  std::shared_ptr<TipType> lookup(std::shared_ptr<TipType> t);
+  // Term id of the canonical representative of the class of each root.
+  std::vector<std::size_t> representatives;
 
-  std::shared_ptr<TipType> get_parent(std::shared_ptr<TipType> t);
+  // Returns the root id of the tree holding id, compressing the path to it.
+  std::size_t root(std::size_t id);
 
-  // Returns interred equivalent value or creates new interred value
-  std::shared_ptr<TipType> smart_insert(std::shared_ptr<TipType> t);
+  // Returns id of interred equivalent value or creates new interred value
+  std::size_t smart_insert(std::shared_ptr<TipType> t);
 
-  // Assert datastructure invariants
-  void invariant();
+  // Assert datastructure invariants for the terms from the given id onwards
+  void invariant(std::size_t from);
 
   std::ostream &print(std::ostream &out) const;
 };
@@ -1,14 +1,29 @@
 #include "CodeGenerator.h"
+#include "CompileCache.h"
+#include "CompileServer.h"
 #include "FrontEnd.h"
 #include "InternalError.h"
+#include "MappedFile.h"
 #include "Optimizer.h"
+#include "Parallel.h"
 #include "ParseError.h"
+#include "PhaseTimer.h"
 #include "SemanticAnalysis.h"
 #include "SemanticError.h"
 #include "loguru.hpp"
+#include "llvm/Config/llvm-config.h"
 #include "llvm/Support/CommandLine.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/StringSaver.h"
+#include "llvm/Support/TargetSelect.h"
+#include "llvm/TargetParser/Host.h"
 
 #include <fstream>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <sstream>
 
 using namespace llvm;
 using namespace std;
@@ -24,8 +39,32 @@ static cl::opt<bool>
 static cl::opt<bool> polyinf("pi",
                              cl::desc("perform polymorphic type inference"),
                              cl::cat(TIPcat));
+static cl::opt<unsigned>
+    jobs("jobs", cl::value_desc("N"), cl::init(1),
+         cl::desc("use N threads for type inference, code generation, "
+                  "optimization and object emission (0 uses all hardware "
+                  "threads)"),
+         cl::cat(TIPcat));
 static cl::opt<bool> disopt("do", cl::desc("disable bitcode optimization"),
                             cl::cat(TIPcat));
+static cl::opt<int>
+    optLevel("O", cl::Prefix, cl::value_desc("level"),
+             cl::init(Optimizer::BASIC),
+             cl::desc("optimize with the standard LLVM pipeline of level 0-3"),
+             cl::cat(TIPcat));
+static cl::opt<std::string>
+    passes("passes", cl::value_desc("pipeline"),
+           cl::desc("optimize with a custom LLVM pass pipeline"),
+           cl::cat(TIPcat));
+static cl::opt<bool>
+    lto("lto",
+        cl::desc("link the runtime library into the program to optimize them "
+                 "together (implies -O2)"),
+        cl::cat(TIPcat));
+static cl::opt<std::string>
+    cpu("mcpu", cl::value_desc("cpu"),
+        cl::desc("tune for the named CPU, 'native' for the host CPU"),
+        cl::cat(TIPcat));
 static cl::opt<int> debug(
     "verbose",
     cl::desc("enable log messages (Levels 1-3) \n Level 1 - Basic logging for "
@@ -35,6 +74,18 @@ static cl::opt<int> debug(
 static cl::opt<bool>
     emitHrAsm("asm", cl::desc("emit human-readable LLVM assembly language"),
               cl::cat(TIPcat));
+static cl::opt<bool> emitObj("obj", cl::desc("emit a native object file"),
+                             cl::cat(TIPcat));
+static cl::opt<bool> runProgram("run",
+                                cl::desc("run the program in memory"),
+                                cl::cat(TIPcat));
+static cl::list<std::string>
+    programArgs("args", cl::CommaSeparated, cl::value_desc("values"),
+                cl::desc("comma separated arguments of the program for --run"),
+                cl::cat(TIPcat));
+static cl::opt<std::string>
+    cacheDir("cache-dir", cl::value_desc("directory"),
+             cl::desc("cache compiled code in a directory"), cl::cat(TIPcat));
 static cl::opt<std::string>
     cgFile("pcg", cl::value_desc("call graph output file"),
            cl::desc("print call graph to a file in dot syntax"),
@@ -46,46 +97,304 @@ static cl::opt<std::string>
     logfile("log", cl::value_desc("logfile"),
             cl::desc("log all messages to logfile (enables --verbose 3)"),
             cl::cat(TIPcat));
-static cl::opt<std::string> sourceFile(cl::Positional,
-                                       cl::desc("<tip source file>"),
-                                       cl::Required, cl::cat(TIPcat));
+static cl::opt<bool>
+    timePhases("time-phases",
+               cl::desc("report the time and memory used by each phase"),
+               cl::cat(TIPcat));
+static cl::opt<std::string>
+    timeFile("time-phases-json", cl::value_desc("file"),
+             cl::desc("write the time and memory used by each phase to a file "
+                      "as JSON"),
+             cl::cat(TIPcat));
+static cl::opt<std::string>
+    serve("serve", cl::value_desc("socket"),
+          cl::desc("serve compile requests on a Unix domain socket"),
+          cl::cat(TIPcat));
+static cl::opt<std::string>
+    server("server", cl::value_desc("socket"),
+           cl::desc("compile with the server listening on a socket"),
+           cl::cat(TIPcat));
+static cl::list<std::string> sourceFiles(cl::Positional,
+                                         cl::desc("<tip source files>"),
+                                         cl::cat(TIPcat));
 static cl::opt<std::string> outputfile("o", cl::value_desc("outputfile"),
                                        cl::desc("write output to <outputfile>"),
                                        cl::cat(TIPcat));
 
-/*! \brief tipc driver.
- *
- * This function is the entry point for tipc.   It handles command line parsing
- * using LLVM CommandLine support.  It runs the phases of the compiler in
- * sequence. If an error is detected, via an exception, it reports the error and
- * exits. If there is no error, then the LLVM bitcode is emitted to a file whose
- * name is the providvvved source file suffixed by ".bc".
+//! The tipc executable, which identifies its build in the compile cache
+static std::string executable;
+
+/*
+ * The settings of a compilation, read from the options.  The server parses
+ * the options of a request while other requests are being compiled, so each
+ * compilation works on a copy of them.
  */
-int main(int argc, char *argv[]) {
-  cl::HideUnrelatedOptions(TIPcat);
-  cl::ParseCommandLineOptions(argc, argv, "tipc - a TIP to llvm compiler\n");
+struct Settings {
+  std::string directory;
+  std::string sourceFile;
+  std::string outputFile;
+  std::string cgFile;
+  std::string astFile;
+  std::string cacheDir;
+  std::string passes;
+  std::string cpu;
+  std::string timeFile;
+  std::vector<std::string> programArgs;
+  unsigned jobs;
+  int optLevel;
+  bool prettyPrint;
+  bool printSymbols;
+  bool printTypes;
+  bool polyInf;
+  bool disableOpt;
+  bool lto;
+  bool emitAsm;
+  bool emitObj;
+  bool run;
+  bool timePhases;
 
-  loguru::g_preamble = false;
-  bool logging = !logfile.getValue().empty();
-  if (debug || logging) {
-    loguru::g_preamble = true;
-    loguru::g_preamble_date = false;
-    loguru::g_preamble_time = false;
-    loguru::g_preamble_uptime = false;
-    loguru::g_preamble_thread = false;
-    loguru::init(argc, argv);
-    loguru::g_stderr_verbosity = logging ? loguru::Verbosity_OFF : debug;
-    if (logging) {
-      loguru::add_file(logfile.getValue().c_str(), loguru::Append,
-                       loguru::Verbosity_MAX);
+  // Relative paths are relative to the directory the request was made in
+  std::string path(const std::string &file) const {
+    if (file.empty() || directory.empty() || sys::path::is_absolute(file)) {
+      return file;
+    }
+    SmallString<128> path(directory);
+    sys::path::append(path, file);
+    return path.str().str();
+  }
+};
+
+static Settings readSettings(const std::string &directory) {
+  Settings settings;
+  settings.directory = directory;
+  settings.outputFile = outputfile;
+  settings.cgFile = cgFile;
+  settings.astFile = astFile;
+  settings.cacheDir = cacheDir;
+  settings.passes = passes;
+  settings.cpu = cpu;
+  settings.timeFile = timeFile;
+  settings.programArgs.assign(programArgs.begin(), programArgs.end());
+  settings.jobs = jobs;
+  settings.optLevel = optLevel;
+  settings.prettyPrint = ppretty;
+  settings.printSymbols = psym;
+  settings.printTypes = ptypes;
+  settings.polyInf = polyinf;
+  settings.disableOpt = disopt;
+  settings.lto = lto;
+  settings.emitAsm = emitHrAsm;
+  settings.emitObj = emitObj;
+  settings.run = runProgram;
+  settings.timePhases = timePhases;
+
+  /*
+   * The basic passes neither inline nor remove functions, which is what
+   * linking the runtime library is for, so --lto implies -O2 unless another
+   * pipeline is chosen.
+   */
+  if (settings.lto && settings.optLevel == Optimizer::BASIC &&
+      settings.passes.empty()) {
+    settings.optLevel = 2;
+  }
+  return settings;
+}
+
+/*
+ * Check the options for errors the command line parser does not detect.  The
+ * errors are written to err, and false is returned if there are any.
+ */
+static bool checkOptions(std::ostream &err) {
+  if (sourceFiles.empty()) {
+    err << "tipc: error: no input file\n";
+    return false;
+  }
+  if (sourceFiles.size() > 1 &&
+      (!outputfile.getValue().empty() || !cgFile.getValue().empty() ||
+       !astFile.getValue().empty() || !timeFile.getValue().empty() ||
+       runProgram)) {
+    err << "tipc: error: -o, --pa, --pcg, --run and --time-phases-json "
+           "require a single input file\n";
+    return false;
+  }
+  if (optLevel.getNumOccurrences() > 0 && (optLevel < 0 || optLevel > 3)) {
+    err << "tipc: error: invalid optimization level '" << optLevel << "'\n";
+    return false;
+  }
+  if (!passes.getValue().empty()) {
+    auto error = Optimizer::checkPasses(passes);
+    if (!error.empty()) {
+      err << "tipc: error: invalid pass pipeline: " << error << "\n";
+      return false;
     }
   }
+  auto cpuError = Optimizer::checkCPU(cpu);
+  if (!cpuError.empty()) {
+    err << "tipc: error: invalid --mcpu: " << cpuError << "\n";
+    return false;
+  }
+  if (!programArgs.empty() && !runProgram) {
+    err << "tipc: error: --args requires --run\n";
+    return false;
+  }
+  return true;
+}
+
+/*
+ * Code is cached in a subdirectory of the cache directory for each build of
+ * tipc, which is identified by its version of LLVM and the size and
+ * modification time of its executable, so that code compiled by another
+ * build is never used.
+ */
+static std::string cacheDirectory(const Settings &settings) {
+  std::vector<std::string> build{LLVM_VERSION_STRING};
+  sys::fs::file_status status;
+  if (!sys::fs::status(executable, status)) {
+    build.push_back(std::to_string(status.getSize()));
+    build.push_back(std::to_string(
+        status.getLastModificationTime().time_since_epoch().count()));
+  }
+
+  SmallString<128> directory(settings.path(settings.cacheDir));
+  sys::path::append(directory, CompileCache::key("", build));
+  return directory.str().str();
+}
+
+/*
+ * The output of a compilation depends on the source and on these settings,
+ * which make up its key in the compile cache.
+ */
+static std::vector<std::string> compileSettings(const Settings &settings) {
+  std::vector<std::string> key{
+      sys::getProcessTriple(), settings.sourceFile,
+      settings.emitObj ? "obj" : (settings.emitAsm ? "asm" : "bc"),
+      settings.polyInf ? "pi" : "", settings.lto ? "lto" : ""};
+
+  key.push_back(settings.cpu);
+  if (settings.cpu == "native") {
+    key.push_back(sys::getHostCPUName().str());
+    StringMap<bool> hostFeatures;
+    sys::getHostCPUFeatures(hostFeatures);
+    std::map<std::string, bool> features;
+    for (auto &feature : hostFeatures) {
+      features[feature.getKey().str()] = feature.getValue();
+    }
+    for (auto &feature : features) {
+      key.push_back((feature.second ? "+" : "-") + feature.first);
+    }
+  }
+
+  if (settings.disableOpt) {
+    key.push_back("do");
+  } else {
+    key.push_back(std::to_string(settings.optLevel));
+    key.push_back(settings.passes);
+    // Only the basic passes give the same result for any number of jobs
+    if (settings.optLevel != Optimizer::BASIC || !settings.passes.empty()) {
+      auto threads =
+          settings.jobs == 0 ? Parallel::hardwareJobs() : settings.jobs;
+      key.push_back(std::to_string(threads));
+    }
+  }
+
+  // Objects are generated in as many partitions as there are jobs
+  if (settings.emitObj) {
+    auto threads =
+        settings.jobs == 0 ? Parallel::hardwareJobs() : settings.jobs;
+    key.push_back("cg" + std::to_string(threads));
+  }
+  return key;
+}
+
+static std::size_t countNodes(ASTNode *node) {
+  std::size_t count = 1;
+  for (auto &child : node->getChildren()) {
+    count += countNodes(child.get());
+  }
+  return count;
+}
+
+/*
+ * Report the phase times of a compilation, as a table with --time-phases and
+ * as JSON in a file with --time-phases-json.  Returns false if the file cannot
+ * be written.
+ */
+static bool report(const Settings &settings, const PhaseTimer &timer,
+                   std::ostream &out, std::ostream &err) {
+  if (settings.timePhases) {
+    out << "Phase times for " << settings.sourceFile << ":\n";
+    timer.print(out);
+  }
+  if (!settings.timeFile.empty()) {
+    std::ofstream json(settings.path(settings.timeFile));
+    timer.printJSON(json, settings.sourceFile);
+    if (!json.good()) {
+      err << "tipc: error: failed to open '" << settings.timeFile
+          << "' for writing\n";
+      return false;
+    }
+  }
+  return true;
+}
+
+/*
+ * Run the phases of the compiler in sequence.  Printed program information
+ * is written to out and errors to err.  Returns the exit status of tipc.
+ */
+static int compile(const Settings &settings, std::ostream &out,
+                   std::ostream &err) {
+  // The source is lexed and hashed where it is mapped, without copies
+  MappedFile source(settings.path(settings.sourceFile));
+  if (!source.good()) {
+    err << "tipc: error: no such file: '" << settings.sourceFile << "'\n";
+    return EXIT_FAILURE;
+  }
+
+  std::string outputFile = settings.outputFile;
+  if (outputFile.empty()) {
+    outputFile = settings.sourceFile +
+                 (settings.emitObj
+                      ? NATIVE_OBJ_EXT
+                      : (settings.emitAsm ? LLVM_ASM_EXT : LLVM_BC_EXT));
+  }
+  outputFile = settings.path(outputFile);
 
-  std::ifstream stream;
-  stream.open(sourceFile);
-  if (!stream.good()) {
-    LOG_S(ERROR) << "tipc: error: no such file: '" << sourceFile << "'";
-    std::exit(EXIT_FAILURE);
+  // The phases of the compilation are timed on request
+  bool timing = settings.timePhases || !settings.timeFile.empty();
+  PhaseTimer timer;
+  std::optional<PhaseTimer::Recording> recording;
+  if (timing) {
+    recording.emplace(timer);
+  }
+
+  /*
+   * A compilation whose output is in the compile cache is skipped altogether,
+   * and its report only holds the time taken to fetch the output.  Options
+   * that print the program need its analyses, and programs that are run have
+   * their native code cached instead.
+   */
+  std::string cache;
+  if (!settings.cacheDir.empty()) {
+    cache = cacheDirectory(settings);
+  }
+  std::string cacheKey;
+  bool printing = settings.prettyPrint || settings.printSymbols ||
+                  settings.printTypes || !settings.cgFile.empty() ||
+                  !settings.astFile.empty();
+  if (!cache.empty() && !settings.run && !printing) {
+    bool hit;
+    {
+      PhaseTimer::Phase phase("fetchCached");
+      cacheKey =
+          CompileCache::key(source.contents(), compileSettings(settings));
+      hit = CompileCache(cache).fetch(cacheKey, outputFile);
+    }
+    if (hit) {
+      if (timing && !report(settings, timer, out, err)) {
+        return EXIT_FAILURE;
+      }
+      return EXIT_SUCCESS;
+    }
   }
 
   /*
@@ -95,75 +404,390 @@ int main(int argc, char *argv[]) {
    * the underlying pointer, i.e., via a call to get().
    */
   try {
-    std::shared_ptr<ASTProgram> ast = FrontEnd::parse(stream);
+    std::shared_ptr<ASTProgram> ast;
+    {
+      PhaseTimer::Phase phase("parse");
+      ast = FrontEnd::parse(source.contents());
+      if (timing) {
+        PhaseTimer::count("astNodes", countNodes(ast.get()));
+      }
+    }
 
     try {
-      auto analysisResults = SemanticAnalysis::analyze(ast.get(), polyinf);
+      std::shared_ptr<SemanticAnalysis> analysisResults;
+      {
+        PhaseTimer::Phase phase("analyze");
+        analysisResults = SemanticAnalysis::analyze(
+            ast.get(), settings.polyInf, settings.jobs);
+      }
 
-      if (ppretty) {
-        FrontEnd::prettyprint(ast.get(), std::cout);
+      if (settings.prettyPrint) {
+        FrontEnd::prettyprint(ast.get(), out);
       }
 
-      if (ptypes) {
-        analysisResults->getTypeResults()->print(std::cout);
-      } else if (psym) {
-        analysisResults->getSymbolTable()->print(std::cout);
+      if (settings.printTypes) {
+        analysisResults->getTypeResults()->print(out);
+      } else if (settings.printSymbols) {
+        analysisResults->getSymbolTable()->print(out);
       }
 
-      bool printCG = !cgFile.getValue().empty();
+      bool printCG = !settings.cgFile.empty();
       if (printCG) {
         std::ofstream cgStream;
-        cgStream.open(cgFile);
+        cgStream.open(settings.path(settings.cgFile));
         if (!cgStream.good()) {
-          LOG_S(ERROR) << "tipc: error: failed to open '" << cgFile
-                       << "' for writing";
-          std::exit(EXIT_FAILURE);
+          err << "tipc: error: failed to open '" << settings.cgFile
+              << "' for writing\n";
+          return EXIT_FAILURE;
         }
 
         analysisResults->getCallGraph()->print(cgStream);
       }
 
-      auto llvmModule =
-          CodeGenerator::generate(ast.get(), analysisResults.get(), sourceFile);
+      std::shared_ptr<llvm::Module> llvmModule;
+      {
+        PhaseTimer::Phase phase("generate");
+        llvmModule =
+            CodeGenerator::generate(ast.get(), analysisResults.get(),
+                                    settings.sourceFile, settings.jobs, cache);
+        if (timing) {
+          PhaseTimer::count("instructions", llvmModule->getInstructionCount());
+        }
+      }
+
+      if (settings.lto || settings.run) {
+        PhaseTimer::Phase phase("linkRuntime");
+        CodeGenerator::linkRuntime(llvmModule.get());
+        if (timing) {
+          PhaseTimer::count("instructions", llvmModule->getInstructionCount());
+        }
+      }
+
+      if (!settings.cpu.empty()) {
+        Optimizer::tune(llvmModule.get(), settings.cpu);
+      }
+
+      if (!settings.disableOpt) {
+        PhaseTimer::Phase phase("optimize");
+        Optimizer::optimize(llvmModule.get(), settings.jobs, settings.optLevel,
+                            settings.passes, cache);
+        if (timing) {
+          PhaseTimer::count("instructions", llvmModule->getInstructionCount());
+        }
+      }
 
-      if (!disopt) {
-        Optimizer::optimize(llvmModule.get());
+      if (!settings.run) {
+        PhaseTimer::Phase phase("emit");
+        if (settings.emitObj) {
+          CodeGenerator::emitObject(llvmModule.get(), outputFile,
+                                   settings.jobs);
+        } else if (settings.emitAsm) {
+          CodeGenerator::emitHumanReadableAssembly(llvmModule.get(),
+                                                   outputFile);
+        } else {
+          CodeGenerator::emit(llvmModule.get(), outputFile);
+        }
       }
 
-      if (emitHrAsm) {
-        CodeGenerator::emitHumanReadableAssembly(llvmModule.get(), outputfile);
-      } else {
-        CodeGenerator::emit(llvmModule.get(), outputfile);
+      if (!cacheKey.empty()) {
+        CompileCache(cache).store(cacheKey, outputFile);
       }
 
-      bool printAST = !astFile.getValue().empty();
+      bool printAST = !settings.astFile.empty();
       if (printAST) {
         std::ofstream astStream;
-        astStream.open(astFile);
+        astStream.open(settings.path(settings.astFile));
         if (!astStream.good()) {
-          LOG_S(ERROR) << "tipc: error: failed to open '" << astFile
-                       << "' for writing";
+          err << "tipc: error: failed to open '" << settings.astFile
+              << "' for writing\n";
         } else {
           FrontEnd::astVisualize(ast, astStream);
         }
       }
 
+      if (timing && !report(settings, timer, out, err)) {
+        return EXIT_FAILURE;
+      }
+
+      if (settings.run) {
+        std::vector<std::string> args{settings.sourceFile};
+        args.insert(args.end(), settings.programArgs.begin(),
+                    settings.programArgs.end());
+        return CodeGenerator::run(llvmModule.get(), args, cache);
+      }
+
     } catch (SemanticError &e) {
-      LOG_S(ERROR) << "tipc: " << e.what();
-      LOG_S(ERROR) << "tipc: semantic error";
-      std::exit(EXIT_FAILURE);
+      err << "tipc: " << e.what() << "\n";
+      err << "tipc: semantic error\n";
+      return EXIT_FAILURE;
     } catch (InternalError &e) { // LCOV_EXCL_LINE
       /* Internal errors should never happen, but we have logic to catch
        * them just in case.  We do not want to count these lines toward
        * coverage goals since a working compiler will never cover these.
        */
-      LOG_S(ERROR) << "tipc: " << e.what();   // LCOV_EXCL_LINE
-      LOG_S(ERROR) << "tipc: internal error"; // LCOV_EXCL_LINE
-      std::exit(EXIT_FAILURE);                // LCOV_EXCL_LINE
+      err << "tipc: " << e.what() << "\n"; // LCOV_EXCL_LINE
+      err << "tipc: internal error\n";      // LCOV_EXCL_LINE
+      return EXIT_FAILURE;                  // LCOV_EXCL_LINE
     }
   } catch (ParseError &e) {
-    LOG_S(ERROR) << "tipc: " << e.what();
-    LOG_S(ERROR) << "tipc: parse error";
-    std::exit(EXIT_FAILURE);
-  } // LCOV_EXCL_LINE
+    err << "tipc: " << e.what() << "\n";
+    err << "tipc: parse error\n";
+    return EXIT_FAILURE;
+  } catch (std::exception &e) {
+    /*
+     * Nothing else should be thrown, but a compilation must not end those
+     * of other files or requests running alongside it.
+     */
+    err << "tipc: " << e.what() << "\n";
+    err << "tipc: internal error\n";
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
+
+/*
+ * Compile each of the source files with the given settings.  Several files
+ * are compiled concurrently by the threads of --jobs, each on a single
+ * thread, and a failure to compile one does not stop the others.  What they
+ * print is written in the order of the files, followed by a summary.
+ */
+static int compileAll(const Settings &settings,
+                      const std::vector<std::string> &files, std::ostream &out,
+                      std::ostream &err) {
+  if (files.size() == 1) {
+    Settings single = settings;
+    single.sourceFile = files.front();
+    return compile(single, out, err);
+  }
+
+  /*
+   * CPU time and memory are measured for the whole process, so files whose
+   * phases are timed are compiled one at a time, each with all the jobs.
+   */
+  bool sequential = settings.timePhases;
+  std::vector<int> status(files.size());
+  std::vector<std::ostringstream> outs(files.size()), errs(files.size());
+  Parallel::forEach(sequential ? 1 : settings.jobs, files.size(),
+                    [&](std::size_t i) {
+                      Settings single = settings;
+                      single.sourceFile = files[i];
+                      if (!sequential) {
+                        single.jobs = 1;
+                      }
+                      status[i] = compile(single, outs[i], errs[i]);
+                    });
+
+  std::vector<std::string> failed;
+  for (std::size_t i = 0; i < files.size(); i++) {
+    out << outs[i].str();
+    if (!errs[i].str().empty()) {
+      err << "tipc: in " << files[i] << ":\n" << errs[i].str();
+    }
+    if (status[i] != EXIT_SUCCESS) {
+      failed.push_back(files[i]);
+    }
+  }
+
+  out << "tipc: compiled " << files.size() - failed.size() << " of "
+      << files.size() << " files\n";
+  for (auto &file : failed) {
+    out << "tipc: failed to compile " << file << "\n";
+  }
+  return failed.empty() ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+//! Log errors reported by compile() a line at a time
+static void logErrors(const std::string &errors) {
+  std::istringstream lines(errors);
+  std::string line;
+  while (std::getline(lines, line)) {
+    LOG_S(ERROR) << line;
+  }
+}
+
+/*
+ * Requests carry the options of a tipc command line.  The options are global,
+ * so only one request at a time parses them, after which its compilation runs
+ * concurrently with those of other requests.
+ */
+static std::mutex optionsMutex;
+
+/*
+ * Only the options of tipc are taken from requests.  The other options of
+ * LLVM are global to the server, so they would change the compilations of
+ * other requests running concurrently and the code they cache, and its
+ * informational options, e.g., --help and --version, print and exit, which
+ * would end the server for all of its clients.  Response files could hold
+ * such options, and clients expand their own.  --verbose and --log set up
+ * the logging of the whole server, which is done when it starts, so they
+ * are refused too rather than silently ignored.
+ */
+static bool serverCannotParse(const std::string &arg, std::ostream &err) {
+  if (arg.size() > 1 && arg[0] == '@') {
+    err << "tipc: error: response file '" << arg
+        << "' cannot be sent to a server\n";
+    return true;
+  }
+  if (arg.size() < 2 || arg[0] != '-') {
+    return false;
+  }
+
+  // Prefix options, e.g., -O2, are registered under a prefix of the argument
+  auto name = arg.substr(arg[1] == '-' ? 2 : 1);
+  name = name.substr(0, name.find('='));
+  auto &options = cl::getRegisteredOptions();
+  for (auto length = name.size(); length > 0; length--) {
+    auto option = options.find(name.substr(0, length));
+    if (option == options.end()) {
+      continue;
+    }
+    bool prefix = option->second->getFormattingFlag() == cl::Prefix ||
+                  option->second->getFormattingFlag() == cl::AlwaysPrefix;
+    bool logging = option->second == &debug || option->second == &logfile;
+    if ((length == name.size() || prefix) && !logging &&
+        is_contained(option->second->Categories, &TIPcat)) {
+      return false;
+    }
+    break;
+  }
+  err << "tipc: error: " << arg << " cannot be sent to a server\n";
+  return true;
+}
+
+static CompileServer::Response answer(const CompileServer::Request &request) {
+  for (auto &arg : request.args) {
+    if (arg == "--") {
+      break;
+    }
+    std::ostringstream err;
+    if (serverCannotParse(arg, err)) {
+      return {EXIT_FAILURE, "", err.str()};
+    }
+  }
+
+  Settings settings;
+  std::vector<std::string> files;
+  {
+    std::lock_guard<std::mutex> lock(optionsMutex);
+    cl::ResetAllOptionOccurrences();
+
+    std::vector<const char *> argv{"tipc"};
+    for (auto &arg : request.args) {
+      argv.push_back(arg.c_str());
+    }
+    std::string errors;
+    raw_string_ostream errorStream(errors);
+    if (!cl::ParseCommandLineOptions(argv.size(), argv.data(), "",
+                                     &errorStream)) {
+      return {EXIT_FAILURE, "", errorStream.str()};
+    }
+
+    std::ostringstream err;
+    if (!serve.getValue().empty() || runProgram) {
+      err << "tipc: error: --serve and --run cannot be sent to a server\n";
+      return {EXIT_FAILURE, "", err.str()};
+    }
+    // Requests are compiled concurrently, which would skew their timings
+    if (timePhases || !timeFile.getValue().empty()) {
+      err << "tipc: error: --time-phases and --time-phases-json cannot be "
+             "sent to a server\n";
+      return {EXIT_FAILURE, "", err.str()};
+    }
+    if (!checkOptions(err)) {
+      return {EXIT_FAILURE, "", err.str()};
+    }
+    settings = readSettings(request.directory);
+    files.assign(sourceFiles.begin(), sourceFiles.end());
+  }
+
+  std::ostringstream out, err;
+  int status = compileAll(settings, files, out, err);
+  return {status, out.str(), err.str()};
+}
+
+/*! \brief tipc driver.
+ *
+ * This function is the entry point for tipc.   It handles command line parsing
+ * using LLVM CommandLine support.  It runs the phases of the compiler in
+ * sequence. If an error is detected, via an exception, it reports the error and
+ * exits. If there is no error, then the LLVM bitcode is emitted to a file whose
+ * name is the providvvved source file suffixed by ".bc".  Several source files
+ * are compiled independently of one another, see compileAll().
+ *
+ * With --serve tipc instead runs as a server that compiles the programs sent
+ * to it over a socket, which spares each compilation the start up of tipc.
+ * With --server the command line is sent to such a server to compile.
+ */
+int main(int argc, char *argv[]) {
+  cl::HideUnrelatedOptions(TIPcat);
+  cl::ParseCommandLineOptions(argc, argv, "tipc - a TIP to llvm compiler\n");
+  executable = sys::fs::getMainExecutable(argv[0], (void *)&compile);
+
+  loguru::g_preamble = false;
+  bool logging = !logfile.getValue().empty();
+  if (debug || logging) {
+    loguru::g_preamble = true;
+    loguru::g_preamble_date = false;
+    loguru::g_preamble_time = false;
+    loguru::g_preamble_uptime = false;
+    loguru::g_preamble_thread = false;
+    loguru::init(argc, argv);
+    loguru::g_stderr_verbosity = logging ? loguru::Verbosity_OFF : debug;
+    if (logging) {
+      loguru::add_file(logfile.getValue().c_str(), loguru::Append,
+                       loguru::Verbosity_MAX);
+    }
+  }
+
+  /*
+   * Targets are initialized once, rather than by each compilation, since
+   * registering them races with the concurrent compilations of a batch or of
+   * the requests to a server.
+   */
+  InitializeNativeTarget();
+  InitializeNativeTargetAsmPrinter();
+
+  if (!serve.getValue().empty()) {
+    try {
+      CompileServer::serve(serve, answer);
+    } catch (std::system_error &e) {
+      LOG_S(ERROR) << "tipc: error: cannot serve on '" << serve
+                   << "': " << e.code().message();
+    }
+    return EXIT_FAILURE;
+  }
+
+  if (!server.getValue().empty()) {
+    SmallString<128> directory;
+    sys::fs::current_path(directory);
+
+    // Response files are named relative to the client, so it expands them
+    BumpPtrAllocator allocator;
+    StringSaver saver(allocator);
+    SmallVector<const char *, 32> args(argv + 1, argv + argc);
+    cl::ExpandResponseFiles(saver, cl::TokenizeGNUCommandLine, args);
+
+    CompileServer::Request request{directory.str().str(),
+                                   std::vector<std::string>(args.begin(),
+                                                            args.end())};
+    try {
+      auto response = CompileServer::send(server, request);
+      std::cout << response.out;
+      logErrors(response.err);
+      return response.status;
+    } catch (std::system_error &e) {
+      LOG_S(ERROR) << "tipc: error: cannot reach server '" << server
+                   << "': " << e.code().message();
+      return EXIT_FAILURE;
+    }
+  }
+
+  std::ostringstream errors;
+  int status = EXIT_FAILURE;
+  if (checkOptions(errors)) {
+    std::vector<std::string> files(sourceFiles.begin(), sourceFiles.end());
+    status = compileAll(readSettings(""), files, std::cout, errors);
+  }
+  logErrors(errors.str());
+  return status;
 } // LCOV_EXCL_LINE
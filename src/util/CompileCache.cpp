@@ -0,0 +1,106 @@
+#include "CompileCache.h"
+
+#include "loguru.hpp"
+#include "picosha2.h"
+
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <sstream>
+
+namespace fs = std::filesystem;
+
+namespace {
+// Options are terminated so that they cannot run into each other
+void hashOptions(picosha2::hash256_one_by_one &hasher,
+                 const std::vector<std::string> &options) {
+  for (auto &option : options) {
+    hasher.process(option.begin(), option.end());
+    const char terminator = '\0';
+    hasher.process(&terminator, &terminator + 1);
+  }
+}
+} // namespace
+
+CompileCache::CompileCache(std::string directory)
+    : directory(std::move(directory)) {}
+
+std::string CompileCache::key(std::string_view source,
+                              const std::vector<std::string> &options) {
+  picosha2::hash256_one_by_one hasher;
+  hashOptions(hasher, options);
+  hasher.process(source.begin(), source.end());
+  hasher.finish();
+  return picosha2::get_hash_hex_string(hasher);
+}
+
+std::string CompileCache::entry(const std::string &key) const {
+  return (fs::path(directory) / key).string();
+}
+
+std::string CompileCache::temporary(const std::string &key) const {
+  return entry(key) + ".tmp" + std::to_string(std::random_device()());
+}
+
+bool CompileCache::fetch(const std::string &key,
+                         const std::string &file) const {
+  std::error_code error;
+  if (!fs::copy_file(entry(key), file, fs::copy_options::overwrite_existing,
+                     error)) {
+    return false;
+  }
+  LOG_S(1) << "Using cached output " << entry(key) << " for " << file;
+  return true;
+}
+
+void CompileCache::store(const std::string &key,
+                         const std::string &file) const {
+  std::error_code error;
+  fs::create_directories(directory, error);
+
+  auto copy = temporary(key);
+  if (!error) {
+    fs::copy_file(file, copy, fs::copy_options::overwrite_existing, error);
+  }
+  if (!error) {
+    fs::rename(copy, entry(key), error);
+  }
+  if (error) {
+    LOG_S(1) << "Cannot cache output " << file << ": " << error.message();
+    fs::remove(copy, error);
+  }
+}
+
+bool CompileCache::load(const std::string &key, std::string &contents) const {
+  std::ifstream stream(entry(key), std::ios::binary);
+  if (!stream) {
+    return false;
+  }
+  std::ostringstream buffer;
+  buffer << stream.rdbuf();
+  contents = buffer.str();
+  return true;
+}
+
+void CompileCache::save(const std::string &key,
+                        std::string_view contents) const {
+  std::error_code error;
+  fs::create_directories(directory, error);
+
+  auto copy = temporary(key);
+  if (!error) {
+    std::ofstream stream(copy, std::ios::binary);
+    stream.write(contents.data(), contents.size());
+    stream.close();
+    if (!stream) {
+      error = std::make_error_code(std::errc::io_error);
+    }
+  }
+  if (!error) {
+    fs::rename(copy, entry(key), error);
+  }
+  if (error) {
+    LOG_S(1) << "Cannot cache entry " << key << ": " << error.message();
+    fs::remove(copy, error);
+  }
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+/*! \class CompileCache
+ *  \brief A cache of compiler outputs in a directory.
+ *
+ * Each output is stored in a file named by the key of the compilation that
+ * produced it, a hash of the source text and of everything else the output
+ * depends on.  Entries are written to a temporary file that is then renamed,
+ * so compilers sharing the directory never see a partial entry.  The cache
+ * is best effort: failures to store an entry are logged and ignored.
+ */
+class CompileCache {
+public:
+  /*! \brief Create a cache in a directory, which is created when needed.
+   * \param directory The directory holding the cached outputs.
+   */
+  explicit CompileCache(std::string directory);
+
+  /*! \brief Compute the key of a compilation.
+   * \param source The source, e.g., a program or the code of a function.
+   * \param options The options, compiler version and other settings that
+   * affect the output.
+   * \return The SHA-256 hash of the source and options in hexadecimal.
+   */
+  static std::string key(std::string_view source,
+                         const std::vector<std::string> &options);
+
+  /*! \brief Copy the cached output of a compilation to a file.
+   * \param key The key of the compilation.
+   * \param file The file to write the output to.
+   * \return true if the output was found in the cache.
+   */
+  bool fetch(const std::string &key, const std::string &file) const;
+
+  /*! \brief Add the output of a compilation to the cache.
+   * \param key The key of the compilation.
+   * \param file The file holding the output.
+   */
+  void store(const std::string &key, const std::string &file) const;
+
+  /*! \brief Read a cached output into memory.
+   * \param key The key of the compilation.
+   * \param contents Receives the output.
+   * \return true if the output was found in the cache.
+   */
+  bool load(const std::string &key, std::string &contents) const;
+
+  /*! \brief Add an output held in memory to the cache.
+   * \param key The key of the compilation.
+   * \param contents The output.
+   */
+  void save(const std::string &key, std::string_view contents) const;
+
+private:
+  std::string entry(const std::string &key) const;
+  std::string temporary(const std::string &key) const;
+
+  std::string directory;
+};
@@ -0,0 +1,286 @@
+#include "CompileServer.h"
+#include "Parallel.h"
+
+#include "loguru.hpp"
+
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <csignal>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <mutex>
+#include <system_error>
+#include <thread>
+
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+/*
+ * Requests hold a directory and the arguments of a command line, so a length
+ * or count beyond these is refused rather than allocated.
+ */
+constexpr std::uint32_t maxRequestString = 1 << 16;
+constexpr std::uint32_t maxRequestArgs = 1 << 16;
+
+// Clients that send nothing give up their handler after this time
+constexpr time_t requestTimeout = 30;
+
+/*
+ * Messages are sequences of strings, each preceded by its length.  Client and
+ * server run on the same host, so integers are sent in its byte order.
+ */
+class Connection {
+public:
+  explicit Connection(int fd) : fd(fd) {}
+  ~Connection() { close(fd); }
+  Connection(const Connection &) = delete;
+  Connection &operator=(const Connection &) = delete;
+
+  void write(const void *data, std::size_t size) {
+    auto bytes = static_cast<const char *>(data);
+    while (size > 0) {
+      auto written = ::write(fd, bytes, size);
+      if (written < 0 && errno == EINTR) {
+        continue;
+      }
+      if (written < 0) {
+        throw std::system_error(errno, std::generic_category(), "write");
+      }
+      bytes += written;
+      size -= written;
+    }
+  }
+
+  void read(void *data, std::size_t size) {
+    auto bytes = static_cast<char *>(data);
+    while (size > 0) {
+      auto count = ::read(fd, bytes, size);
+      if (count < 0 && errno == EINTR) {
+        continue;
+      }
+      if (count < 0) {
+        throw std::system_error(errno, std::generic_category(), "read");
+      }
+      if (count == 0) {
+        throw std::system_error(ECONNRESET, std::generic_category(), "read");
+      }
+      bytes += count;
+      size -= count;
+    }
+  }
+
+  void writeNumber(std::uint32_t number) { write(&number, sizeof(number)); }
+
+  std::uint32_t readNumber() {
+    std::uint32_t number;
+    read(&number, sizeof(number));
+    return number;
+  }
+
+  void writeString(const std::string &string) {
+    writeNumber(string.size());
+    write(string.data(), string.size());
+  }
+
+  std::string readString(
+      std::uint32_t limit = std::numeric_limits<std::uint32_t>::max()) {
+    auto size = readNumber();
+    if (size > limit) {
+      throw std::system_error(EMSGSIZE, std::generic_category(), "read");
+    }
+    std::string string(size, '\0');
+    read(string.data(), string.size());
+    return string;
+  }
+
+private:
+  int fd;
+};
+
+sockaddr_un address(const std::string &socketPath) {
+  sockaddr_un address{};
+  address.sun_family = AF_UNIX;
+  if (socketPath.size() >= sizeof(address.sun_path)) {
+    throw std::system_error(ENAMETOOLONG, std::generic_category(), socketPath);
+  }
+  std::strcpy(address.sun_path, socketPath.c_str());
+  return address;
+}
+
+int connectTo(const std::string &socketPath) {
+  auto server = address(socketPath);
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0) {
+    throw std::system_error(errno, std::generic_category(), "socket");
+  }
+  if (connect(fd, reinterpret_cast<sockaddr *>(&server), sizeof(server)) < 0) {
+    auto error = errno;
+    close(fd);
+    throw std::system_error(error, std::generic_category(), socketPath);
+  }
+  return fd;
+}
+
+/*
+ * Counts the connections being answered so that accepting a connection can
+ * wait for one of them to end.
+ */
+class Handlers {
+public:
+  explicit Handlers(unsigned limit) : free(limit) {}
+
+  void acquire() {
+    std::unique_lock<std::mutex> lock(mutex);
+    released.wait(lock, [this] { return free > 0; });
+    free--;
+  }
+
+  void release() {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      free++;
+    }
+    released.notify_one();
+  }
+
+private:
+  std::mutex mutex;
+  std::condition_variable released;
+  unsigned free;
+};
+
+void answer(int fd,
+            const std::function<CompileServer::Response(
+                const CompileServer::Request &)> &handle,
+            Handlers &handlers) {
+  Connection connection(fd);
+  try {
+    CompileServer::Request request;
+    request.directory = connection.readString(maxRequestString);
+    auto count = connection.readNumber();
+    if (count > maxRequestArgs) {
+      throw std::system_error(EMSGSIZE, std::generic_category(), "read");
+    }
+    for (; count > 0; count--) {
+      request.args.push_back(connection.readString(maxRequestString));
+    }
+
+    // The server outlives requests its handler fails to answer
+    CompileServer::Response response;
+    try {
+      response = handle(request);
+    } catch (std::exception &e) {
+      LOG_S(ERROR) << "Cannot answer request: " << e.what();
+      std::string error = "tipc: error: ";
+      response = {EXIT_FAILURE, "", error + e.what() + "\n"};
+    }
+    connection.writeNumber(response.status);
+    connection.writeString(response.out);
+    connection.writeString(response.err);
+  } catch (std::exception &e) {
+    // Nothing thrown here may escape the thread and end the server
+    LOG_S(1) << "Dropping connection: " << e.what();
+  }
+  handlers.release();
+}
+
+//! Whether accept failed for want of a resource that other connections hold
+bool outOfResources(int error) {
+  return error == EMFILE || error == ENFILE || error == ENOBUFS ||
+         error == ENOMEM;
+}
+} // namespace
+
+void CompileServer::serve(
+    const std::string &socketPath,
+    const std::function<Response(const Request &)> &handle) {
+  auto server = address(socketPath);
+
+  // A socket nobody answers on is left over from a server that has exited
+  struct stat status;
+  if (stat(socketPath.c_str(), &status) == 0 && S_ISSOCK(status.st_mode)) {
+    bool running = true;
+    try {
+      close(connectTo(socketPath));
+    } catch (std::system_error &) {
+      running = false;
+    }
+    if (running) {
+      throw std::system_error(EADDRINUSE, std::generic_category(), socketPath);
+    }
+    unlink(socketPath.c_str());
+  }
+
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0) {
+    throw std::system_error(errno, std::generic_category(), "socket");
+  }
+  if (bind(fd, reinterpret_cast<sockaddr *>(&server), sizeof(server)) < 0 ||
+      listen(fd, SOMAXCONN) < 0) {
+    auto error = errno;
+    close(fd);
+    throw std::system_error(error, std::generic_category(), socketPath);
+  }
+
+  // Clients that go away must not take the server with them
+  std::signal(SIGPIPE, SIG_IGN);
+
+  /*
+   * Connections are answered by at most as many threads as the hardware
+   * runs, the others wait in the backlog of the socket.  Handlers are never
+   * destroyed, since the threads answering requests outlive this function
+   * when the process ends.
+   */
+  auto handlers = new Handlers(Parallel::hardwareJobs());
+  timeval timeout{requestTimeout, 0};
+
+  LOG_S(1) << "Serving compile requests on " << socketPath;
+  while (true) {
+    handlers->acquire();
+    int client = accept(fd, nullptr, nullptr);
+    if (client < 0) {
+      auto error = errno;
+      handlers->release();
+      if (error == EINTR || error == ECONNABORTED) {
+        continue;
+      }
+      // Retrying at once would fail the same way until resources are freed
+      LOG_S(ERROR) << "Cannot accept connection: " << std::strerror(error);
+      std::this_thread::sleep_for(outOfResources(error)
+                                      ? std::chrono::milliseconds(100)
+                                      : std::chrono::seconds(1));
+      continue;
+    }
+    setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    try {
+      std::thread(answer, client, handle, std::ref(*handlers)).detach();
+    } catch (std::system_error &e) {
+      LOG_S(ERROR) << "Cannot answer connection: " << e.what();
+      close(client);
+      handlers->release();
+    }
+  }
+}
+
+CompileServer::Response CompileServer::send(const std::string &socketPath,
+                                            const Request &request) {
+  Connection connection(connectTo(socketPath));
+  connection.writeString(request.directory);
+  connection.writeNumber(request.args.size());
+  for (auto &arg : request.args) {
+    connection.writeString(arg);
+  }
+
+  Response response;
+  response.status = static_cast<int>(connection.readNumber());
+  response.out = connection.readString();
+  response.err = connection.readString();
+  return response;
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+
+/*! \class CompileServer
+ *  \brief A server answering compile requests over a Unix domain socket.
+ *
+ * A request carries the command line of a compilation and the directory it
+ * was issued in, a response its exit status and the text it printed.  Each
+ * connection carries a single request and is handled on a thread of its own,
+ * so requests are answered concurrently, as many at a time as the hardware
+ * runs threads.  Requests that are too large are dropped unanswered.
+ * Failures to set up the socket or to reach the server are reported by
+ * throwing std::system_error.
+ */
+class CompileServer {
+public:
+  //! A compilation requested by a client
+  struct Request {
+    std::string directory;
+    std::vector<std::string> args;
+  };
+
+  //! The result of a compilation
+  struct Response {
+    int status;
+    std::string out;
+    std::string err;
+  };
+
+  /*! \brief Answer requests until the process is terminated.
+   *
+   * A stale socket left behind by a server that is no longer running is
+   * replaced, but a socket a server is still listening on is not.
+   * \param socketPath The path of the socket to listen on.
+   * \param handle Computes the response to a request, called concurrently.
+   */
+  static void serve(const std::string &socketPath,
+                    const std::function<Response(const Request &)> &handle);
+
+  /*! \brief Send a request to a server and wait for its response.
+   * \param socketPath The path of the socket the server listens on.
+   * \param request The request.
+   * \return The response of the server.
+   */
+  static Response send(const std::string &socketPath, const Request &request);
+};
@@ -0,0 +1,58 @@
+#include "MappedFile.h"
+
+#include "loguru.hpp"
+
+#include <array>
+#include <cerrno>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+MappedFile::MappedFile(const std::string &path) {
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return;
+  }
+
+  struct stat status;
+  if (fstat(fd, &status) == 0 && S_ISREG(status.st_mode) &&
+      status.st_size > 0) {
+    void *address =
+        mmap(nullptr, status.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (address != MAP_FAILED) {
+      // The lexer reads the source from start to end
+      madvise(address, status.st_size, MADV_SEQUENTIAL);
+      close(fd);
+      opened = mapped = true;
+      data = static_cast<const char *>(address);
+      size = status.st_size;
+      return;
+    }
+    LOG_S(1) << "Reading " << path << " as it cannot be mapped";
+  }
+
+  std::array<char, 1 << 16> block;
+  ssize_t count;
+  while ((count = read(fd, block.data(), block.size())) != 0) {
+    if (count < 0 && errno == EINTR) {
+      continue;
+    }
+    if (count < 0) {
+      close(fd);
+      return;
+    }
+    buffer.append(block.data(), count);
+  }
+  close(fd);
+  opened = true;
+  data = buffer.data();
+  size = buffer.size();
+}
+
+MappedFile::~MappedFile() {
+  if (mapped) {
+    munmap(const_cast<char *>(data), size);
+  }
+}
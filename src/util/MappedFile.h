@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+/*! \class MappedFile
+ *  \brief The contents of a file mapped read-only into memory.
+ *
+ * Mapping a file makes its bytes available without copying them into a
+ * buffer, and the pages are only read as they are touched.  Files that cannot
+ * be mapped, e.g., pipes, are read into memory instead, so the contents are
+ * always available when the file could be opened.
+ */
+class MappedFile {
+public:
+  /*! \brief Map a file, reading it if it cannot be mapped.
+   * \param path The path of the file.
+   */
+  explicit MappedFile(const std::string &path);
+  ~MappedFile();
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+
+  /*! \brief Whether the file was opened and its contents are available.
+   */
+  bool good() const { return opened; }
+
+  /*! \brief The contents of the file, valid while it is mapped.
+   */
+  std::string_view contents() const { return {data, size}; }
+
+private:
+  bool opened = false;
+  bool mapped = false;
+  const char *data = nullptr;
+  std::size_t size = 0;
+  std::string buffer;
+};
@@ -0,0 +1,46 @@
+#include "Parallel.h"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <thread>
+#include <vector>
+
+unsigned Parallel::hardwareJobs() {
+  return std::max(1u, std::thread::hardware_concurrency());
+}
+
+void Parallel::forEach(unsigned jobs, std::size_t count,
+                       const std::function<void(std::size_t)> &task) {
+  if (jobs == 0) {
+    jobs = hardwareJobs();
+  }
+  jobs = std::min<std::size_t>(jobs, count);
+
+  std::atomic<std::size_t> next{0};
+  std::vector<std::exception_ptr> errors(count);
+  auto worker = [&]() {
+    for (auto i = next++; i < count; i = next++) {
+      try {
+        task(i);
+      } catch (...) {
+        errors[i] = std::current_exception();
+      }
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (unsigned t = 1; t < jobs; t++) {
+    threads.emplace_back(worker);
+  }
+  worker();
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  for (auto &error : errors) {
+    if (error) {
+      std::rethrow_exception(error);
+    }
+  }
+}
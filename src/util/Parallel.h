@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+
+/*! \class Parallel
+ *  \brief Helpers for running independent tasks on a set of threads.
+ *
+ * Work is distributed dynamically: each thread repeatedly claims the next
+ * unclaimed task.  The calling thread participates, so no threads are
+ * started when a single job is requested.
+ */
+class Parallel {
+public:
+  /*! \brief Run task(i) for every i in [0, count) using up to jobs threads.
+   *
+   * Tasks must be independent of one another.  If any tasks throw, the
+   * remaining tasks are still run and the exception of the lowest numbered
+   * failing task is rethrown once all threads have finished, so errors are
+   * reported the same way regardless of the number of jobs.
+   * \param jobs The maximum number of threads, 0 selects hardwareJobs().
+   * \param count The number of tasks.
+   * \param task The task to run for each index.
+   */
+  static void forEach(unsigned jobs, std::size_t count,
+                      const std::function<void(std::size_t)> &task);
+
+  /*! \brief The number of threads supported by the hardware, at least 1.
+   */
+  static unsigned hardwareJobs();
+};
@@ -0,0 +1,122 @@
+#include "PhaseTimer.h"
+
+#include <iomanip>
+#include <sys/resource.h>
+
+namespace {
+thread_local PhaseTimer *current = nullptr;
+
+// The peak resident set size of the process in kilobytes
+long peakResidentSize() {
+  rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+  return usage.ru_maxrss / 1024;
+#else
+  return usage.ru_maxrss;
+#endif
+}
+
+void printString(std::ostream &os, const std::string &s) {
+  os << '"';
+  for (char c : s) {
+    if (c == '"' || c == '\\') {
+      os << '\\' << c;
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      os << "\\u" << std::hex << std::setw(4) << std::setfill('0')
+         << static_cast<int>(c) << std::dec << std::setfill(' ');
+    } else {
+      os << c;
+    }
+  }
+  os << '"';
+}
+} // namespace
+
+PhaseTimer::Phase::Phase(std::string name) : timer(current) {
+  if (timer == nullptr) {
+    return;
+  }
+  index = timer->records.size();
+  timer->records.push_back(
+      {std::move(name), static_cast<unsigned>(timer->running.size()), 0, 0,
+       0, {}});
+  timer->running.push_back(index);
+
+  peakRSS = peakResidentSize();
+  cpu = std::clock();
+  wall = std::chrono::steady_clock::now();
+}
+
+PhaseTimer::Phase::~Phase() {
+  if (timer == nullptr) {
+    return;
+  }
+  auto &record = timer->records[index];
+  record.wall = std::chrono::duration<double>(
+                    std::chrono::steady_clock::now() - wall)
+                    .count();
+  record.cpu = static_cast<double>(std::clock() - cpu) / CLOCKS_PER_SEC;
+  record.peakRSS = peakResidentSize() - peakRSS;
+  timer->running.pop_back();
+}
+
+PhaseTimer::Recording::Recording(PhaseTimer &timer) : previous(current) {
+  current = &timer;
+}
+
+PhaseTimer::Recording::~Recording() { current = previous; }
+
+void PhaseTimer::count(const std::string &name, std::size_t value) {
+  if (current == nullptr || current->running.empty()) {
+    return;
+  }
+  auto &counts = current->records[current->running.back()].counts;
+  for (auto &count : counts) {
+    if (count.first == name) {
+      count.second += value;
+      return;
+    }
+  }
+  counts.emplace_back(name, value);
+}
+
+void PhaseTimer::print(std::ostream &os) const {
+  auto flags = os.flags();
+  os << "   Wall (s)     CPU (s)  Peak RSS (KB)  Phase\n";
+  for (auto &record : records) {
+    os << std::fixed << std::setprecision(6) << std::setw(11) << record.wall
+       << std::setw(12) << record.cpu << std::setw(15) << record.peakRSS
+       << "  " << std::string(2 * record.depth, ' ') << record.name;
+    for (std::size_t i = 0; i < record.counts.size(); i++) {
+      os << (i == 0 ? " (" : ", ") << record.counts[i].first << ": "
+         << record.counts[i].second;
+    }
+    os << (record.counts.empty() ? "" : ")") << "\n";
+  }
+  os.flags(flags);
+}
+
+void PhaseTimer::printJSON(std::ostream &os,
+                           const std::string &source) const {
+  auto flags = os.flags();
+  os << "{\"source\": ";
+  printString(os, source);
+  os << ", \"phases\": [";
+  for (std::size_t i = 0; i < records.size(); i++) {
+    auto &record = records[i];
+    os << (i == 0 ? "\n" : ",\n") << "  {\"name\": ";
+    printString(os, record.name);
+    os << ", \"depth\": " << record.depth << std::fixed << std::setprecision(6)
+       << ", \"wall\": " << record.wall << ", \"cpu\": " << record.cpu
+       << ", \"peakRSS\": " << record.peakRSS << ", \"counts\": {";
+    for (std::size_t j = 0; j < record.counts.size(); j++) {
+      os << (j == 0 ? "" : ", ");
+      printString(os, record.counts[j].first);
+      os << ": " << record.counts[j].second;
+    }
+    os << "}}";
+  }
+  os << "\n]}\n";
+  os.flags(flags);
+}
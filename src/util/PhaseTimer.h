@@ -0,0 +1,101 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <ctime>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+/*! \class PhaseTimer
+ *  \brief Measures the time and memory used by the phases of a compilation.
+ *
+ * A phase is timed by a PhaseTimer::Phase that lives for as long as the phase
+ * runs; phases started while another is running are its sub-phases.  Phases
+ * are only recorded on a thread that a PhaseTimer::Recording has made record
+ * into a timer, so the compiler marks its phases at no cost when they are not
+ * timed.  CPU time and peak resident memory are those of the whole process,
+ * including the threads that a phase runs work on.
+ */
+class PhaseTimer {
+public:
+  //! The measurements of a phase
+  struct Record {
+    std::string name;
+    //! The number of phases this is a sub-phase of
+    unsigned depth;
+    //! Elapsed and CPU time in seconds
+    double wall;
+    double cpu;
+    //! The growth of the peak resident set size in kilobytes
+    long peakRSS;
+    //! Sizes of the program, e.g., the number of AST nodes, in the phase
+    std::vector<std::pair<std::string, std::size_t>> counts;
+  };
+
+  /*! \class Phase
+   *  \brief Times a phase from its construction to its destruction.
+   */
+  class Phase {
+  public:
+    /*! \brief Start a phase of the timer of the calling thread, if any.
+     * \param name The name of the phase.
+     */
+    explicit Phase(std::string name);
+    ~Phase();
+    Phase(const Phase &) = delete;
+    Phase &operator=(const Phase &) = delete;
+
+  private:
+    PhaseTimer *timer;
+    std::size_t index;
+    std::chrono::steady_clock::time_point wall;
+    std::clock_t cpu;
+    long peakRSS;
+  };
+
+  /*! \class Recording
+   *  \brief Makes the calling thread record its phases into a timer.
+   */
+  class Recording {
+  public:
+    explicit Recording(PhaseTimer &timer);
+    ~Recording();
+    Recording(const Recording &) = delete;
+    Recording &operator=(const Recording &) = delete;
+
+  private:
+    PhaseTimer *previous;
+  };
+
+  /*! \brief Add to a count of the innermost phase of the calling thread.
+   * \param name The name of the count.
+   * \param value The amount to add.
+   */
+  static void count(const std::string &name, std::size_t value);
+
+  //! The phases in the order they were started
+  const std::vector<Record> &getRecords() const { return records; }
+
+  /*! \brief Print the phases as a table, sub-phases indented.
+   * \param os The stream to print to.
+   */
+  void print(std::ostream &os) const;
+
+  /*! \brief Print the phases as a JSON object.
+   *
+   * The object holds the source and an array of the records of the phases,
+   * e.g., {"source": "fib.tip", "phases": [{"name": "parse", "depth": 0,
+   * "wall": 0.0021, "cpu": 0.0020, "peakRSS": 812, "counts": {"astNodes":
+   * 97}}]}.
+   * \param os The stream to print to.
+   * \param source The source file that was compiled.
+   */
+  void printJSON(std::ostream &os, const std::string &source) const;
+
+private:
+  std::vector<Record> records;
+  //! The indices of the phases that are running, innermost last
+  std::vector<std::size_t> running;
+};
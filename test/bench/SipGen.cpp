@@ -0,0 +1,79 @@
+#include "SyntheticProgram.h"
+#include "llvm/Support/CommandLine.h"
+
+#include <fstream>
+#include <iostream>
+
+using namespace llvm;
+
+static cl::OptionCategory sipgenCat("sipgen Options",
+                                    "Options for controlling the program "
+                                    "that is generated.");
+static cl::opt<std::string> outputFile("o", cl::value_desc("outputfile"),
+                                       cl::desc("write the program to a file "
+                                                "instead of the standard "
+                                                "output"),
+                                       cl::cat(sipgenCat));
+static cl::opt<unsigned> seed("seed", cl::init(1), cl::value_desc("N"),
+                              cl::desc("the seed of the generator"),
+                              cl::cat(sipgenCat));
+static cl::opt<unsigned> functions("functions", cl::init(100),
+                                   cl::value_desc("N"),
+                                   cl::desc("the number of functions"),
+                                   cl::cat(sipgenCat));
+static cl::opt<unsigned>
+    statements("statements", cl::init(8), cl::value_desc("N"),
+               cl::desc("the number of statements per function"),
+               cl::cat(sipgenCat));
+static cl::opt<unsigned>
+    fanOut("fan-out", cl::init(2), cl::value_desc("N"),
+           cl::desc("the number of calls per function"), cl::cat(sipgenCat));
+static cl::opt<unsigned>
+    depth("depth", cl::init(2), cl::value_desc("N"),
+          cl::desc("the nesting depth of statements"), cl::cat(sipgenCat));
+static cl::opt<unsigned> fields("fields", cl::init(2), cl::value_desc("N"),
+                                cl::desc("the number of record fields"),
+                                cl::cat(sipgenCat));
+static cl::opt<unsigned> elements("elements", cl::init(4),
+                                  cl::value_desc("N"),
+                                  cl::desc("the number of array elements"),
+                                  cl::cat(sipgenCat));
+static cl::opt<bool>
+    polymorphic("polymorphic",
+                cl::desc("call poly functions at several types, which "
+                         "requires --poly to compile"),
+                cl::cat(sipgenCat));
+
+/*! \brief sipgen driver.
+ *
+ * Writes a synthetic SIP program of the requested shape, e.g., for stress
+ * testing the compiler.  The same options always produce the same program.
+ */
+int main(int argc, char *argv[]) {
+  cl::HideUnrelatedOptions(sipgenCat);
+  cl::ParseCommandLineOptions(argc, argv,
+                              "sipgen - synthetic SIP program generator\n");
+
+  SyntheticProgram::Shape shape;
+  shape.seed = seed;
+  shape.functions = functions;
+  shape.statements = statements;
+  shape.fanOut = fanOut;
+  shape.depth = depth;
+  shape.fields = fields;
+  shape.elements = elements;
+  shape.polymorphic = polymorphic;
+
+  if (outputFile.getNumOccurrences() == 0) {
+    SyntheticProgram::generate(shape, std::cout);
+    return EXIT_SUCCESS;
+  }
+
+  std::ofstream os(outputFile);
+  if (!os.good()) {
+    std::cerr << "sipgen: cannot open " << outputFile << "\n";
+    return EXIT_FAILURE;
+  }
+  SyntheticProgram::generate(shape, os);
+  return os.good() ? EXIT_SUCCESS : EXIT_FAILURE;
+}
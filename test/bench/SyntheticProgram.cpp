@@ -0,0 +1,287 @@
+#include "SyntheticProgram.h"
+
+#include <algorithm>
+#include <random>
+#include <sstream>
+
+namespace {
+/*
+ * Writes a program a statement at a time.  The variables of a function keep
+ * their types throughout it: y, x, n, the loop variables e<l> and k<l> are
+ * ints, r is a record, a an array of ints, m an array of arrays of ints, b a
+ * bool, p a pointer to an int and g a function like the others.  The arrays
+ * all have the same number of elements, so their indices are in bounds.
+ *
+ * Choices are made with the output of a Mersenne twister, whose sequence is
+ * fixed by the standard, reduced modulo the number of alternatives; the
+ * distributions of the standard library differ between implementations.
+ */
+class Generator {
+public:
+  Generator(const SyntheticProgram::Shape &shape, std::ostream &os)
+      : shape(shape), os(os), random(shape.seed),
+        fields(std::max(1u, shape.fields)),
+        elements(std::max(1u, shape.elements)) {}
+
+  void program() {
+    polyFunctions();
+    for (unsigned i = 0; i < shape.functions; i++) {
+      function(i);
+    }
+
+    os << "main() {\n";
+    line(1) << "var n;\n";
+    line(1) << "n = input;\n";
+    if (shape.functions > 0) {
+      line(1) << "output f0(2, n);\n";
+    }
+    line(1) << "return 0;\n";
+    os << "}\n";
+  }
+
+private:
+  const SyntheticProgram::Shape &shape;
+  std::ostream &os;
+  std::mt19937 random;
+  unsigned fields;
+  unsigned elements;
+
+  unsigned choose(unsigned alternatives) { return random() % alternatives; }
+
+  std::ostream &line(unsigned level) {
+    return os << std::string(2 * level, ' ');
+  }
+
+  std::string record(const std::string &value) {
+    std::string record = "{";
+    for (unsigned f = 0; f < fields; f++) {
+      record += (f == 0 ? "a" : ", a") + std::to_string(f) + ": " + value;
+    }
+    return record + "}";
+  }
+
+  std::string array(const std::string &value) {
+    std::string array = "[" + value;
+    for (unsigned e = 1; e < elements; e++) {
+      array += ", " + value + " + " + std::to_string(e);
+    }
+    return array + "]";
+  }
+
+  void polyFunctions() {
+    os << "pick(c, u, v) poly {\n";
+    line(1) << "var w;\n";
+    line(1) << "if (c) {\n";
+    line(2) << "w = u;\n";
+    line(1) << "} else {\n";
+    line(2) << "w = v;\n";
+    line(1) << "}\n";
+    line(1) << "return w;\n";
+    os << "}\n\n";
+
+    os << "first(s) poly {\n";
+    line(1) << "return s[0];\n";
+    os << "}\n\n";
+
+    os << "apply(h, n, x) poly {\n";
+    line(1) << "return h(n, x);\n";
+    os << "}\n\n";
+  }
+
+  void function(unsigned i) {
+    os << "f" << i << "(n, x) {\n";
+    line(1) << "var y, r, a, m, b, p, g";
+    for (unsigned l = 0; l < shape.depth; l++) {
+      os << ", e" << l << ", k" << l;
+    }
+    os << ";\n";
+
+    line(1) << "y = x;\n";
+    line(1) << "r = " << record("x") << ";\n";
+    line(1) << "a = " << array("x") << ";\n";
+    line(1) << "m = [" << elements << " of a];\n";
+    line(1) << "b = x > 0;\n";
+    line(1) << "p = alloc x;\n";
+    line(1) << "g = f" << i << ";\n";
+    for (unsigned l = 0; l < shape.depth; l++) {
+      line(1) << "e" << l << " = 0;\n";
+      line(1) << "k" << l << " = 0;\n";
+    }
+
+    // The calls are spread evenly at random among the statements
+    auto calls = shape.fanOut;
+    for (auto slots = shape.statements + shape.fanOut; slots > 0; slots--) {
+      if (choose(slots) < calls) {
+        call(1);
+        calls--;
+      } else {
+        statement(1, shape.depth);
+      }
+    }
+
+    line(1) << "return y;\n";
+    os << "}\n\n";
+  }
+
+  void call(unsigned level) {
+    auto callee = "f" + std::to_string(choose(shape.functions));
+    line(level) << "if (n > 0) {\n";
+    switch (choose(3)) {
+    case 0:
+      line(level + 1) << "y = y + " << callee << "(n - 1, y);\n";
+      break;
+    case 1:
+      line(level + 1) << "g = " << callee << ";\n";
+      line(level + 1) << "y = y + g(n - 1, y);\n";
+      break;
+    default:
+      line(level + 1) << "y = y + apply(" << callee << ", n - 1, y);\n";
+    }
+    line(level) << "}\n";
+  }
+
+  void statement(unsigned level, unsigned depth) {
+    if (depth > 0 && choose(3) == 0) {
+      compound(level, depth);
+    } else {
+      simple(level);
+    }
+  }
+
+  /*
+   * A compound statement nests another down to the given depth, so that the
+   * size of a function grows linearly with the depth.
+   */
+  void compound(unsigned level, unsigned depth) {
+    auto l = std::to_string(shape.depth - depth);
+    switch (choose(5)) {
+    case 0:
+      line(level) << "if (y > " << choose(100) << ") {\n";
+      body(level + 1, depth);
+      if (choose(2) == 0) {
+        line(level) << "} else {\n";
+        simple(level + 1);
+      }
+      line(level) << "}\n";
+      break;
+    case 1:
+      line(level) << "k" << l << " = 0;\n";
+      line(level) << "while (k" << l << " < " << elements << ") {\n";
+      body(level + 1, depth);
+      line(level + 1) << "k" << l << "++;\n";
+      line(level) << "}\n";
+      break;
+    case 2:
+      line(level) << "for (e" << l << " : a) {\n";
+      line(level + 1) << "y = y + e" << l << ";\n";
+      body(level + 1, depth);
+      line(level) << "}\n";
+      break;
+    case 3:
+      line(level) << "for (k" << l << " : 0 .. #a"
+                  << (choose(2) == 0 ? " by 2" : "") << ") {\n";
+      line(level + 1) << "a[k" << l << "] = a[k" << l << "] + y;\n";
+      body(level + 1, depth);
+      line(level) << "}\n";
+      break;
+    default:
+      line(level) << "{\n";
+      body(level + 1, depth);
+      line(level) << "}\n";
+    }
+  }
+
+  void body(unsigned level, unsigned depth) {
+    simple(level);
+    if (depth > 1) {
+      compound(level, depth - 1);
+    } else {
+      simple(level);
+    }
+  }
+
+  void simple(unsigned level) {
+    switch (choose(12)) {
+    case 0:
+      line(level) << "y = (y * " << 2 + choose(8) << " + x) % "
+                  << 1000 + choose(1000) << ";\n";
+      break;
+    case 1:
+      line(level) << "y = y / " << 2 + choose(8) << " - x;\n";
+      break;
+    case 2:
+      line(level) << "r = " << record("y + " + std::to_string(choose(10)))
+                  << ";\n";
+      line(level) << "y = y + r.a" << choose(fields) << ";\n";
+      break;
+    case 3:
+      line(level) << "r.a" << choose(fields) << " = y;\n";
+      break;
+    case 4:
+      line(level) << "a = " << array("y") << ";\n";
+      line(level) << "y = y + a[" << choose(elements) << "];\n";
+      break;
+    case 5:
+      line(level) << "m = [" << elements << " of [" << elements
+                  << " of y]];\n";
+      line(level) << "m[" << choose(elements) << "][" << choose(elements)
+                  << "] = x;\n";
+      line(level) << "y = y + m[" << choose(elements) << "]["
+                  << choose(elements) << "] + #m;\n";
+      break;
+    case 6:
+      if (choose(2) == 0) {
+        line(level) << "p = alloc y;\n";
+        line(level) << "*p = *p + x;\n";
+        line(level) << "y = *p;\n";
+      } else {
+        line(level) << "p = &y;\n";
+        line(level) << "*p = *p + 1;\n";
+      }
+      break;
+    case 7:
+      line(level) << "b = y > x and not b or (y % 2 == 0);\n";
+      break;
+    case 8:
+      line(level) << "y = b ? y + 1 : y - " << 1 + choose(9) << ";\n";
+      break;
+    case 9: {
+      static const char *updates[] = {"y++;",     "y--;",      "y += x;",
+                                      "y -= 3;",  "y *= 2;",   "y /= 2;",
+                                      "y %= 1000;", "a[0]++;"};
+      line(level) << updates[choose(8)] << "\n";
+      break;
+    }
+    case 10:
+      if (shape.polymorphic) {
+        line(level) << "b = pick(b, true, y > x);\n";
+        line(level) << "p = pick(b, p, alloc y);\n";
+        line(level) << "y = y + first(first(m));\n";
+      } else {
+        line(level) << "y = pick(b, y, x) + first(a);\n";
+      }
+      break;
+    default:
+      if (choose(2) == 0) {
+        line(level) << "if (p != null) {\n";
+        line(level + 1) << "y = y + *p;\n";
+        line(level) << "}\n";
+      } else {
+        line(level) << "if (#a != " << elements << ") {\n";
+        line(level + 1) << "error #a;\n";
+        line(level) << "}\n";
+      }
+    }
+  }
+};
+} // namespace
+
+std::string SyntheticProgram::generate(const Shape &shape) {
+  std::ostringstream os;
+  generate(shape, os);
+  return os.str();
+}
+
+void SyntheticProgram::generate(const Shape &shape, std::ostream &os) {
+  Generator(shape, os).program();
+}
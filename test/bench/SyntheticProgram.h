@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+/*! \class SyntheticProgram
+ *  \brief Generates SIP programs whose size and shape are parameterized.
+ *
+ * A program is a set of functions f0(n, x), f1(n, x), ... and main.  Each
+ * function runs statements drawn from the whole of the language: records,
+ * arrays and arrayOf expressions, iterator and range for loops, pointers,
+ * booleans, calls of poly functions, and calls of the functions, directly,
+ * through function values and recursively.  Calls are only made while the
+ * budget n is positive, so the programs terminate when they are run.
+ *
+ * The statements are drawn from a generator seeded by the shape, so a shape
+ * always yields the same program.  The programs are type correct under
+ * monomorphic inference, unless the shape asks for the poly functions to be
+ * called at more than one type, which requires polymorphic inference.
+ */
+class SyntheticProgram {
+public:
+  //! The parameters of a program
+  struct Shape {
+    //! The seed of the generator of the statements
+    std::uint32_t seed = 1;
+    //! The number of functions besides main and the poly functions
+    unsigned functions = 100;
+    //! The number of statements in each function besides its calls
+    unsigned statements = 8;
+    //! The number of calls of other functions in each function
+    unsigned fanOut = 2;
+    //! The depth of the nest of compound statements
+    unsigned depth = 2;
+    //! The number of fields of records, at least 1
+    unsigned fields = 2;
+    //! The number of elements of arrays, at least 1
+    unsigned elements = 4;
+    //! Whether the poly functions are called at more than one type
+    bool polymorphic = false;
+  };
+
+  /*! \brief Generate the source of a program.
+   * \param shape The parameters of the program.
+   * \return The SIP source of the program.
+   */
+  static std::string generate(const Shape &shape);
+
+  /*! \brief Write the source of a program to a stream.
+   * \param shape The parameters of the program.
+   * \param os The stream to write to.
+   */
+  static void generate(const Shape &shape, std::ostream &os);
+};
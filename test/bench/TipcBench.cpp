@@ -0,0 +1,206 @@
+#include "CallGraph.h"
+#include "CodeGenerator.h"
+#include "FrontEnd.h"
+#include "Optimizer.h"
+#include "PhaseTimer.h"
+#include "SemanticAnalysis.h"
+#include "SymbolTable.h"
+#include "SyntheticProgram.h"
+#include "TypeInference.h"
+#include "llvm/Support/CommandLine.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <map>
+
+using namespace llvm;
+
+static cl::OptionCategory
+    benchCat("tipc_bench Options",
+             "Options for controlling the compile phase benchmarks.");
+static cl::opt<unsigned>
+    steps("steps", cl::init(5), cl::value_desc("N"),
+          cl::desc("double each parameter N-1 times"), cl::cat(benchCat));
+static cl::opt<unsigned>
+    repetitions("repetitions", cl::init(3), cl::value_desc("N"),
+                cl::desc("time each phase N times, keeping the fastest"),
+                cl::cat(benchCat));
+static cl::opt<unsigned> functions("functions", cl::init(100),
+                                   cl::value_desc("N"),
+                                   cl::desc("the initial number of functions"),
+                                   cl::cat(benchCat));
+static cl::opt<unsigned>
+    fanOut("fan-out", cl::init(2), cl::value_desc("N"),
+           cl::desc("the initial number of calls per function"),
+           cl::cat(benchCat));
+static cl::opt<unsigned>
+    depth("depth", cl::init(2), cl::value_desc("N"),
+          cl::desc("the initial nesting depth of statements"),
+          cl::cat(benchCat));
+static cl::opt<unsigned> fields("fields", cl::init(2), cl::value_desc("N"),
+                                cl::desc("the initial number of record fields"),
+                                cl::cat(benchCat));
+static cl::opt<double> maxExponent(
+    "max-exponent", cl::init(0), cl::value_desc("k"),
+    cl::desc("fail if the time of a phase grows faster than n^k (0 never "
+             "fails)"),
+    cl::cat(benchCat));
+
+//! The phases in the order they are run and reported
+static const std::vector<std::string> phases{
+    "parse", "symbolTable", "callGraph", "monoTypes",
+    "polyTypes", "generate", "optimize"};
+
+/*
+ * Compile a program through the public interfaces of the phases, returning
+ * the elapsed time of each of them.
+ */
+static std::map<std::string, double> compile(const std::string &source) {
+  PhaseTimer timer;
+  {
+    PhaseTimer::Recording recording(timer);
+
+    std::shared_ptr<ASTProgram> ast;
+    {
+      PhaseTimer::Phase phase("parse");
+      ast = FrontEnd::parse(std::string_view(source));
+    }
+    std::shared_ptr<SymbolTable> symbols;
+    {
+      PhaseTimer::Phase phase("symbolTable");
+      symbols = SymbolTable::build(ast.get());
+    }
+    std::shared_ptr<CallGraph> callGraph;
+    {
+      PhaseTimer::Phase phase("callGraph");
+      callGraph = CallGraph::build(ast.get(), symbols.get());
+    }
+    std::shared_ptr<TypeInference> types;
+    {
+      PhaseTimer::Phase phase("monoTypes");
+      types = TypeInference::run(ast.get(), false, callGraph.get(),
+                                 symbols.get());
+    }
+    {
+      PhaseTimer::Phase phase("polyTypes");
+      TypeInference::run(ast.get(), true, callGraph.get(), symbols.get());
+    }
+    SemanticAnalysis analysis(symbols, types, callGraph);
+    std::shared_ptr<llvm::Module> module;
+    {
+      PhaseTimer::Phase phase("generate");
+      module = CodeGenerator::generate(ast.get(), &analysis, "bench");
+    }
+    {
+      PhaseTimer::Phase phase("optimize");
+      Optimizer::optimize(module.get());
+    }
+  }
+
+  std::map<std::string, double> times;
+  for (auto &record : timer.getRecords()) {
+    times[record.name] = record.wall;
+  }
+  return times;
+}
+
+/*
+ * The exponent k of the best fit of time = c * n^k, i.e., the slope of the
+ * least squares line through the points (log n, log time).
+ */
+static double growth(const std::vector<double> &sizes,
+                     const std::vector<double> &times) {
+  double n = sizes.size(), sx = 0, sy = 0, sxx = 0, sxy = 0;
+  for (std::size_t i = 0; i < sizes.size(); i++) {
+    double x = std::log(sizes[i]);
+    double y = std::log(std::max(times[i], 1e-9));
+    sx += x;
+    sy += y;
+    sxx += x * x;
+    sxy += x * y;
+  }
+  double d = n * sxx - sx * sx;
+  return d == 0 ? 0 : (n * sxy - sx * sy) / d;
+}
+
+/*
+ * Time the phases on programs whose parameter is doubled at each step, the
+ * others staying at their initial values.  Returns false if a phase grows
+ * faster than allowed.
+ */
+static bool scale(const std::string &name,
+                  unsigned SyntheticProgram::Shape::*parameter) {
+  SyntheticProgram::Shape shape;
+  shape.functions = functions;
+  shape.fanOut = fanOut;
+  shape.depth = depth;
+  shape.fields = fields;
+
+  std::cout << "Scaling " << name << " (functions " << shape.functions
+            << ", fan-out " << shape.fanOut << ", depth " << shape.depth
+            << ", fields " << shape.fields << ")\n";
+  std::cout << std::setw(10) << name;
+  for (auto &phase : phases) {
+    std::cout << std::setw(12) << phase;
+  }
+  std::cout << "\n";
+
+  std::vector<double> sizes;
+  std::map<std::string, std::vector<double>> times;
+  for (unsigned step = 0; step < steps; step++) {
+    auto source = SyntheticProgram::generate(shape);
+    std::map<std::string, double> fastest;
+    for (unsigned r = 0; r < std::max(1u, repetitions.getValue()); r++) {
+      for (auto &[phase, time] : compile(source)) {
+        fastest[phase] = r == 0 ? time : std::min(fastest[phase], time);
+      }
+    }
+
+    sizes.push_back(std::max(1u, shape.*parameter));
+    std::cout << std::setw(10) << shape.*parameter << std::fixed
+              << std::setprecision(6);
+    for (auto &phase : phases) {
+      times[phase].push_back(fastest[phase]);
+      std::cout << std::setw(12) << fastest[phase];
+    }
+    std::cout << "\n";
+    shape.*parameter = std::max(1u, 2 * shape.*parameter);
+  }
+
+  bool ok = true;
+  std::cout << std::setw(10) << "n^k, k =" << std::setprecision(2);
+  for (auto &phase : phases) {
+    auto k = growth(sizes, times[phase]);
+    std::cout << std::setw(12) << k;
+    ok = ok && (maxExponent <= 0 || k <= maxExponent);
+  }
+  std::cout << "\n\n" << std::defaultfloat;
+  return ok;
+}
+
+/*! \brief tipc_bench driver.
+ *
+ * Runs the phases of tipc on synthetic programs of growing size, one
+ * parameter of their shape at a time, and reports the time of each phase and
+ * the exponent of its growth.  An exponent near 1 is linear growth, one near
+ * 2 points at a quadratic algorithm.
+ */
+int main(int argc, char *argv[]) {
+  cl::HideUnrelatedOptions(benchCat);
+  cl::ParseCommandLineOptions(argc, argv,
+                              "tipc_bench - benchmarks of the tipc phases\n");
+
+  bool ok = true;
+  ok = scale("functions", &SyntheticProgram::Shape::functions) && ok;
+  ok = scale("fan-out", &SyntheticProgram::Shape::fanOut) && ok;
+  ok = scale("depth", &SyntheticProgram::Shape::depth) && ok;
+  ok = scale("fields", &SyntheticProgram::Shape::fields) && ok;
+  if (!ok) {
+    std::cout << "tipc_bench: a phase grows faster than n^" << maxExponent
+              << "\n";
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
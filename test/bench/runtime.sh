@@ -0,0 +1,117 @@
+#!/bin/bash
+# Times the benchmark programs compiled without optimization and with each of
+# the optimizing pipelines of tipc, and summarizes the times over the trials.
+#
+#   usage: runtime.sh [-n trials] [programs ...]
+#
+# Each program times its own kernel with the clock expression, outputs the
+# elapsed nanoseconds and then returns a checksum, which must be the same
+# for all of the pipelines.
+declare -r ROOT_DIR=${TRAVIS_BUILD_DIR:-$(git rev-parse --show-toplevel)}
+declare -r TIPC=${ROOT_DIR}/build/src/tipc
+declare -r RTLIB=${ROOT_DIR}/rtlib
+declare -r SCRATCH_DIR=$(mktemp -d)
+
+if [ -z "${TIPCLANG}" ]; then
+  echo error: TIPCLANG env var must be set
+  exit 1
+fi
+
+trials=5
+while getopts "n:" opt; do
+  case ${opt} in
+    n) trials=${OPTARG} ;;
+    *) echo "usage: $0 [-n trials] [programs ...]"; exit 1 ;;
+  esac
+done
+shift $((OPTIND - 1))
+
+if [ $# -eq 0 ]; then
+  set -- "$(dirname "$0")"/programs/*.sip
+fi
+
+# The unoptimized pipeline comes first as the others are compared to it
+# --lto implies -O2, so it is compared with -O2 to see the effect of the runtime
+declare -r pipelines=("-do" "" "-O2" "-O3" "--lto")
+declare -r names=("-do" "default" "-O2" "-O3" "--lto")
+
+# Prints the minimum, median, mean and sample standard deviation, in
+# milliseconds, of the nanoseconds read one per line
+summarize() {
+  sort -n | awk '
+    { t[NR] = $1 / 1e6; sum += t[NR] }
+    END {
+      mean = sum / NR
+      for (i = 1; i <= NR; i++) ss += (t[i] - mean) ^ 2
+      median = NR % 2 ? t[(NR + 1) / 2] : (t[NR / 2] + t[NR / 2 + 1]) / 2
+      stddev = NR > 1 ? sqrt(ss / (NR - 1)) : 0
+      printf "%.3f %.3f %.3f %.3f\n", t[1], median, mean, stddev
+    }'
+}
+
+numfailures=0
+
+printf "%-12s %-8s %10s %10s %10s %10s %8s\n" program pipeline "min ms" \
+  "median ms" "mean ms" "stddev ms" speedup
+for program in "$@"
+do
+  base="$(basename $program .sip)"
+  executable=${SCRATCH_DIR}/${base}
+  expected=""
+  baseline=""
+
+  for p in ${!pipelines[@]}
+  do
+    options=${pipelines[$p]}
+    if ! ${TIPC} ${options} ${program} -o ${executable}.bc; then
+      echo "${base} ${names[$p]}: compilation failed"
+      ((numfailures++))
+      continue
+    fi
+    if [ "${options}" = "--lto" ]; then
+      ${TIPCLANG} -w ${executable}.bc -o ${executable}
+    else
+      ${TIPCLANG} -w ${executable}.bc ${RTLIB}/tip_rtlib.bc -o ${executable}
+    fi
+
+    times=""
+    for ((trial = 0; trial < trials; trial++))
+    do
+      output="$(${executable})"
+      exit_code=${?}
+      elapsed="$(echo "${output}" | sed -n '1s/^Program output: //p')"
+      checksum="$(echo "${output}" | sed -n '2s/^Program output: //p')"
+      if [ ${exit_code} -ne 0 ] || [ -z "${elapsed}" ]; then
+        echo "${base} ${names[$p]}: run failed: ${output}"
+        ((numfailures++))
+        break
+      fi
+      if [ -z "${expected}" ]; then
+        expected=${checksum}
+      elif [ "${checksum}" != "${expected}" ]; then
+        echo "${base} ${names[$p]}: checksum ${checksum} differs from ${expected}"
+        ((numfailures++))
+      fi
+      times+="${elapsed}"$'\n'
+    done
+    if [ -z "${times}" ]; then
+      continue
+    fi
+
+    read min median mean stddev <<< "$(echo -n "${times}" | summarize)"
+    if [ ${p} -eq 0 ]; then
+      baseline=${median}
+    fi
+    speedup=$(awk -v b="${baseline}" -v m="${median}" \
+      'BEGIN { if (b != "" && m > 0) printf "%.2fx", b / m; else print "-" }')
+    printf "%-12s %-8s %10s %10s %10s %10s %8s\n" ${base} ${names[$p]} \
+      ${min} ${median} ${mean} ${stddev} ${speedup}
+  done
+done
+
+rm -r ${SCRATCH_DIR}
+
+if [ ${numfailures} -ne 0 ]; then
+  echo "${numfailures} benchmark failures"
+  exit 1
+fi
@@ -24,90 +24,102 @@ initialize_test() {
   ((numtests++))
 }
 
-# Self contained test cases
-for i in selftests/*.tip
-do
-  base="$(basename $i .tip)"
+# Self contained test cases are compiled with each set of options by a
+# single run of tipc, then linked and run one at a time.
+run_selftests() {
+  local options="$1"
+  local rtlib="$2"
+  shift 2
+
+  ${TIPC} --jobs=0 ${options} "$@" >/dev/null
+  for i in "$@"
+  do
+    base="$(basename $i .tip)"
+
+    initialize_test
+    ${TIPCLANG} -w $i.bc ${rtlib} -o $base
+
+    ./${base} &>/dev/null
+    exit_code=${?}
+    if [ ${exit_code} -ne 0 ]; then
+      echo -n "Test failure for : " 
+      echo $i
+      ./${base}
+      ((numfailures++))
+    else 
+      rm ${base}
+    fi 
+    rm $i.bc
+  done
+}
 
-  # test optimized program
-  initialize_test
-  ${TIPC} $i
-  ${TIPCLANG} -w $i.bc ${RTLIB}/tip_rtlib.bc -o $base
+# Printed types of test cases are checked by a single run of tipc, whose
+# output is that of each file in order followed by a summary.  Only if it
+# differs is each file printed on its own, to tell which ones differ.
+# Expected output that is missing is saved from a run of its own, as the
+# output of a single run does not mark where each file's ends.
+check_printing() {
+  local options="$1"
+  shift
+
+  for i in "$@"
+  do
+    if [[ ! -f $i.pppt ]]; then
+      echo "No expected output found for $i. Saving generated output as expected."
+      ${TIPC} ${options} $i >$i.pppt
+    fi
+  done
 
-  ./${base} &>/dev/null
-  exit_code=${?}
-  if [ ${exit_code} -ne 0 ]; then
-    echo -n "Test failure for : " 
-    echo $i
-    ./${base}
-    ((numfailures++))
-  else 
-    rm ${base}
-  fi 
-  rm $i.bc
-
-  # test unoptimized program
   initialize_test
-  ${TIPC} -do $i
-  ${TIPCLANG} -w $i.bc ${RTLIB}/tip_rtlib.bc -o $base
+  for i in "$@"
+  do
+    cat $i.pppt
+  done >${SCRATCH_DIR}/expected.pppt
+  echo "tipc: compiled $# of $# files" >>${SCRATCH_DIR}/expected.pppt
+  ${TIPC} --jobs=0 ${options} "$@" >${SCRATCH_DIR}/generated.pppt 2>/dev/null
+  if cmp -s ${SCRATCH_DIR}/expected.pppt ${SCRATCH_DIR}/generated.pppt; then
+    return
+  fi
 
-  ./${base} &>/dev/null
-  exit_code=${?}
-  if [ ${exit_code} -ne 0 ]; then
-    echo -n "Test failure for : " 
-    echo $i
-    ./${base}
-    ((numfailures++))
-  else 
-    rm ${base}
-  fi 
-  rm $i.bc
-done
+  local differences=0
+  for i in "$@"
+  do
+    base="$(basename $i .tip)"
+    ${TIPC} ${options} $i >${SCRATCH_DIR}/$base.pppt
+    diff $i.pppt ${SCRATCH_DIR}/$base.pppt >${SCRATCH_DIR}/$base.diff
+    if [[ -s ${SCRATCH_DIR}/$base.diff ]]
+    then
+      echo -n "Test differences for : " 
+      echo $i
+      cat ${SCRATCH_DIR}/$base.diff
+      ((differences++))
+    fi 
+  done
+  if [ ${differences} -eq 0 ]; then
+    echo "Test differences for : $options $*"
+    diff ${SCRATCH_DIR}/expected.pppt ${SCRATCH_DIR}/generated.pppt
+    differences=1
+  fi
+  ((numfailures += differences))
+}
 
-#self contained test cases for SIPC
+# Self contained test cases for TIP and for SIPC
 #note: should change file extension to .sip?
-# Self contained test cases
-for i in sipc/*.tip
+for tests in selftests sipc
 do
-  base="$(basename $i .tip)"
-
   # test optimized program
-  initialize_test
-  ${TIPC} $i
-  ${TIPCLANG} -w $i.bc ${RTLIB}/tip_rtlib.bc -o $base
+  run_selftests "" ${RTLIB}/tip_rtlib.bc ${tests}/*.tip
 
-  ./${base} &>/dev/null
-  exit_code=${?}
-  if [ ${exit_code} -ne 0 ]; then
-    echo -n "Test failure for : " 
-    echo $i
-    ./${base}
-    ((numfailures++))
-  else 
-    rm ${base}
-  fi 
-  rm $i.bc
+  # test program optimized with the standard pipeline
+  run_selftests -O3 ${RTLIB}/tip_rtlib.bc ${tests}/*.tip
 
-  # test unoptimized program
-  initialize_test
-  ${TIPC} -do $i
-  ${TIPCLANG} -w $i.bc ${RTLIB}/tip_rtlib.bc -o $base
+  # test program optimized together with the runtime library
+  run_selftests --lto "" ${tests}/*.tip
 
-  ./${base} &>/dev/null
-  exit_code=${?}
-  if [ ${exit_code} -ne 0 ]; then
-    echo -n "Test failure for : " 
-    echo $i
-    ./${base}
-    ((numfailures++))
-  else 
-    rm ${base}
-  fi 
-  rm $i.bc
+  # test unoptimized program
+  run_selftests -do ${RTLIB}/tip_rtlib.bc ${tests}/*.tip
 done
 
-
-
 # IO related test cases
 for i in iotests/*.expected
 do
@@ -137,6 +149,30 @@ do
   rm $executable
 done
 
+# IO related test cases run in memory
+for i in iotests/*.expected
+do
+  initialize_test
+
+  expected="$(basename $i .tip)"
+  executable="$(echo $expected | cut -f1 -d-)"
+  input="$(echo $expected | cut -f2 -d- | cut -f1 -d.)"
+
+  ${TIPC} --run ${input:+--args=$input} iotests/$executable.tip >iotests/$executable.output 2>iotests/$executable.output
+
+  diff iotests/$executable.output $i > ${SCRATCH_DIR}/$executable.diff
+
+  if [[ -s ${SCRATCH_DIR}/$executable.diff ]]
+  then
+    echo -n "Test differences for --run : " 
+    echo $i
+    cat ${SCRATCH_DIR}/$executable.diff
+    ((numfailures++))
+  fi 
+
+  rm iotests/$executable.output
+done
+
 # Tests to cover driver logic for error and argument handling
 for i in iotests/*error.tip
 do
@@ -154,37 +190,8 @@ do
 done
 
 # System tests for polymorphic type inference
-for i in polytests/*.tip
-do
-  base="$(basename $i .tip)"
-
-  # test optimized program
-  initialize_test
-  ${TIPC} --pi $i
-  ${TIPCLANG} -w $i.bc ${RTLIB}/tip_rtlib.bc -o $base
-
-  ./${base} &>/dev/null
-  exit_code=${?}
-  if [ ${exit_code} -ne 0 ]; then
-    echo -n "Test failure for : "
-    echo $i
-    ./${base}
-    ((numfailures++))
-  else
-    rm ${base}
-  fi
-  rm $i.bc
-
-  ${TIPC} --pp --pt --pi $i >${SCRATCH_DIR}/$base.pppt
-  diff $i.pppt ${SCRATCH_DIR}/$base.pppt >${SCRATCH_DIR}/$base.diff
-  if [[ -s ${SCRATCH_DIR}/$base.diff ]]
-  then
-    echo -n "Test differences for : " 
-    echo $i
-    cat ${SCRATCH_DIR}/$base.diff
-    ((numfailures++))
-  fi 
-done
+run_selftests --pi ${RTLIB}/tip_rtlib.bc polytests/*.tip
+check_printing "--pp --pt --pi" polytests/*.tip
 
 # Tests to cover argument handling
 # Test pretty printing and symbol printing.
@@ -223,6 +230,16 @@ if [ -s $diffed ]; then
   ((numfailures++))
 fi 
 
+# Test that the runtime library is inlined into programs compiled with --lto.
+initialize_test
+input=iotests/main.tip
+output=${SCRATCH_DIR}/main.tip.ll
+${TIPC} --lto --asm $input -o $output
+if [ ! -f $output ] || grep -q "@_tip_output(" $output; then
+  echo "Test failure for --lto: _tip_output was not inlined in $input"
+  ((numfailures++))
+fi
+
 # Test call graph.
 initialize_test
 input=iotests/fib.tip
@@ -254,49 +271,102 @@ if [ ${exit_code} -eq 0 ]; then
   ((numfailures++))
 fi
 
-# Type checking at the system level
-for i in selftests/*.tip
-do
-  initialize_test
-  base="$(basename $i .tip)"
+# Test bad pass pipeline.
+initialize_test
+${TIPC} --passes=nosuchpass iotests/fib.tip &>/dev/null
+exit_code=${?}
+if [ ${exit_code} -eq 0 ]; then
+  echo -n "Test failure for invalid pass pipeline" 
+  ((numfailures++))
+fi
 
-  ${TIPC} -pp -pt $i >${SCRATCH_DIR}/$base.pppt
-  diff $i.pppt ${SCRATCH_DIR}/$base.pppt >${SCRATCH_DIR}/$base.diff
-  if [[ -s ${SCRATCH_DIR}/$base.diff ]]
-  then
-    echo -n "Test differences for : " 
-    echo $i
-    cat ${SCRATCH_DIR}/$base.diff
-    ((numfailures++))
-  fi 
+# Test bad CPU.
+initialize_test
+${TIPC} --mcpu=nosuchcpu iotests/fib.tip &>/dev/null
+exit_code=${?}
+if [ ${exit_code} -eq 0 ]; then
+  echo -n "Test failure for invalid CPU" 
+  ((numfailures++))
+fi
+
+# Test compile cache, a cached compilation yields the same bitcode.
+initialize_test
+${TIPC} --cache-dir=${SCRATCH_DIR}/cache iotests/fib.tip
+mv iotests/fib.tip.bc ${SCRATCH_DIR}/fib.bc
+${TIPC} --cache-dir=${SCRATCH_DIR}/cache iotests/fib.tip
+if ! cmp -s iotests/fib.tip.bc ${SCRATCH_DIR}/fib.bc; then
+  echo -n "Test failure for compile cache" 
+  ((numfailures++))
+fi
+rm -f iotests/fib.tip.bc
+rm -rf ${SCRATCH_DIR}/cache
+
+# Test compile server, a served compilation yields the same bitcode.
+initialize_test
+${TIPC} --serve=${SCRATCH_DIR}/tipc.sock &
+server_pid=$!
+for retry in {1..50}; do
+  [ -S ${SCRATCH_DIR}/tipc.sock ] && break
+  sleep 0.1
 done
+${TIPC} iotests/fib.tip
+mv iotests/fib.tip.bc ${SCRATCH_DIR}/fib.bc
+${TIPC} --server=${SCRATCH_DIR}/tipc.sock iotests/fib.tip
+if ! cmp -s iotests/fib.tip.bc ${SCRATCH_DIR}/fib.bc; then
+  echo -n "Test failure for compile server"
+  ((numfailures++))
+fi
+rm -f iotests/fib.tip.bc
+# Options of LLVM outside those of tipc are refused by the server
+${TIPC} --server=${SCRATCH_DIR}/tipc.sock -inline-threshold=0 iotests/fib.tip &>/dev/null
+if [ ${?} -eq 0 ]; then
+  echo -n "Test failure for compile server refusing LLVM options"
+  ((numfailures++))
+fi
+rm -f iotests/fib.tip.bc
+${TIPC} --server=${SCRATCH_DIR}/tipc.sock --time-phases iotests/fib.tip &>/dev/null
+if [ ${?} -eq 0 ]; then
+  echo -n "Test failure for compile server refusing to time phases"
+  ((numfailures++))
+fi
+rm -f iotests/fib.tip.bc
+# A request the server fails to compile does not end it
+${TIPC} --server=${SCRATCH_DIR}/tipc.sock iotests/rangeerror.tip &>/dev/null
+${TIPC} --server=${SCRATCH_DIR}/tipc.sock iotests/fib.tip
+if [ ! -f iotests/fib.tip.bc ]; then
+  echo -n "Test failure for compile server after an error"
+  ((numfailures++))
+fi
+rm -f iotests/fib.tip.bc
+kill ${server_pid}
+wait ${server_pid} 2>/dev/null
 
-#type checking and pretty printing of SIPC
-for i in sipc/*.tip
-do
-  initialize_test
-  base="$(basename $i .tip)"
-  expected="$i.pppt"  # Expected pretty print output file
-  generated="${SCRATCH_DIR}/$base.pppt"  # Generated output for this test run
-
-  # Run the type-checking and pretty-printing
-  ${TIPC} -pp -pt $i > "$generated"
-
-  # TEMP CODE: if expected pretty print output does not exist, saves generated as expected
-  if [[ ! -f "$expected" ]]; then
-    echo "No expected output found for $i. Saving generated output as expected."
-    cp "$generated" "$expected"  # Save generated output as expected for next run
-  else
-    # If the expected file exists, compare it with the generated output
-    diff "$expected" "$generated" > "${SCRATCH_DIR}/$base.diff"
-    if [[ -s ${SCRATCH_DIR}/$base.diff ]]; then
-      echo -n "Test differences for : " 
-      echo $i
-      cat "${SCRATCH_DIR}/$base.diff"
-      ((numfailures++))
-    fi 
+# Test phase timing, every phase is reported in the JSON file.
+initialize_test
+${TIPC} --time-phases --time-phases-json=${SCRATCH_DIR}/fib.json iotests/fib.tip >/dev/null
+for phase in parse analyze typeInference generate optimize emit; do
+  if ! grep -q "\"name\": \"${phase}\"" ${SCRATCH_DIR}/fib.json; then
+    echo -n "Test failure for phase timing of ${phase}"
+    ((numfailures++))
   fi
 done
+rm -f iotests/fib.tip.bc
+
+# Test batch compilation, an error in one file does not stop the others.
+initialize_test
+${TIPC} iotests/semanticerror.tip iotests/fib.tip &>/dev/null
+exit_code=${?}
+if [ ${exit_code} -eq 0 ] || [ ! -f iotests/fib.tip.bc ]; then
+  echo -n "Test failure for batch compilation"
+  ((numfailures++))
+fi
+rm -f iotests/fib.tip.bc
+
+# Type checking at the system level
+check_printing "-pp -pt" selftests/*.tip
+
+#type checking and pretty printing of SIPC
+check_printing "-pp -pt" sipc/*.tip
 
 
 # Test unwritable output file for both ast and call graph printing
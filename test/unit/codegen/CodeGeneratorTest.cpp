@@ -0,0 +1,46 @@
+#include "ASTHelper.h"
+#include "CodeGenerator.h"
+#include "SemanticAnalysis.h"
+#include "llvm/BinaryFormat/Magic.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Program.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <sstream>
+
+TEST_CASE("CodeGenerator: objects are emitted in partitions",
+          "[CodeGenerator]") {
+  // The objects of the partitions are combined by the system linker
+  REQUIRE(llvm::sys::findProgramByName("ld"));
+
+  for (unsigned jobs : {1, 4}) {
+    std::stringstream source;
+    source << R"(
+      inc(x) { return x + 1; }
+      twice(x) { return inc(inc(x)); }
+      sum(n) {
+        var s;
+        s = 0;
+        while (n > 0) { s = s + n; n = n - 1; }
+        return s;
+      }
+      main(n) { return twice(n) + sum(n); }
+    )";
+    auto ast = ASTHelper::build_ast(source);
+    auto analysisResults = SemanticAnalysis::analyze(ast.get(), false);
+    auto module =
+        CodeGenerator::generate(ast.get(), analysisResults.get(), "prog");
+
+    llvm::SmallString<128> path;
+    REQUIRE_FALSE(llvm::sys::fs::createTemporaryFile("tipc-test", "o", path));
+    REQUIRE(CodeGenerator::emitObject(module.get(), path.str().str(), jobs) ==
+            jobs);
+
+    llvm::file_magic magic;
+    REQUIRE_FALSE(llvm::identify_magic(path, magic));
+    REQUIRE((magic == llvm::file_magic::elf_relocatable ||
+             magic == llvm::file_magic::macho_object));
+    llvm::sys::fs::remove(path);
+  }
+}
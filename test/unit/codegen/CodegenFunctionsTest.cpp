@@ -1,14 +1,21 @@
 #include "AST.h"
+#include "ASTHelper.h"
 #include "ASTNodeHelpers.h"
+#include "CodeGenContext.h"
 #include "InternalError.h"
 #include "ParserHelper.h"
+#include "SemanticAnalysis.h"
+#include "llvm/IR/Verifier.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/raw_ostream.h"
 
 #include <catch2/catch_test_macros.hpp>
 
 TEST_CASE("CodegenFunction: ASTDeclNode throws InternalError on codegen",
           "[CodegenFunctions]") {
   ASTDeclNode node("foo");
-  REQUIRE_THROWS_AS(node.codegen(), InternalError);
+  CodeGenContext ctx;
+  REQUIRE_THROWS_AS(node.codegen(ctx), InternalError);
 }
 
 TEST_CASE("CodegenFunction: ASTAssignsStmt throws InternalError on LHS codegen "
@@ -16,7 +23,8 @@ TEST_CASE("CodegenFunction: ASTAssignsStmt throws InternalError on LHS codegen "
           "[CodegenFunctions]") {
   ASTAssignStmt assignStmt(std::make_shared<nullcodegen::MockASTExpr>(),
                            std::make_shared<ASTInputExpr>());
-  REQUIRE_THROWS_AS(assignStmt.codegen(), InternalError);
+  CodeGenContext ctx;
+  REQUIRE_THROWS_AS(assignStmt.codegen(ctx), InternalError);
 }
 
 TEST_CASE("CodegenFunction: ASTAssignsStmt throws InternalError on RHS codegen "
@@ -24,7 +32,8 @@ TEST_CASE("CodegenFunction: ASTAssignsStmt throws InternalError on RHS codegen "
           "[CodegenFunctions]") {
   ASTAssignStmt assignStmt(std::make_shared<ASTInputExpr>(),
                            std::make_shared<nullcodegen::MockASTExpr>());
-  REQUIRE_THROWS_AS(assignStmt.codegen(), InternalError);
+  CodeGenContext ctx;
+  REQUIRE_THROWS_AS(assignStmt.codegen(ctx), InternalError);
 }
 
 TEST_CASE(
@@ -34,7 +43,8 @@ TEST_CASE(
       std::make_shared<nullcodegen::MockASTExpr>(),
       std::make_shared<ASTReturnStmt>(std::make_shared<ASTNumberExpr>(42)),
       std::make_shared<ASTReturnStmt>(std::make_shared<ASTNumberExpr>(42)));
-  REQUIRE_THROWS_AS(ifStmt.codegen(), InternalError);
+  CodeGenContext ctx;
+  REQUIRE_THROWS_AS(ifStmt.codegen(ctx), InternalError);
 }
 
 TEST_CASE("CodegenFunction: ASTBinaryExpr throws InternalError on LHS codegen "
@@ -42,7 +52,8 @@ TEST_CASE("CodegenFunction: ASTBinaryExpr throws InternalError on LHS codegen "
           "[CodegenFunctions]") {
   ASTBinaryExpr binaryExpr("+", std::make_shared<nullcodegen::MockASTExpr>(),
                            std::make_shared<ASTInputExpr>());
-  REQUIRE_THROWS_AS(binaryExpr.codegen(), InternalError);
+  CodeGenContext ctx;
+  REQUIRE_THROWS_AS(binaryExpr.codegen(ctx), InternalError);
 }
 
 TEST_CASE("CodegenFunction: ASTBinaryExpr throws InternalError on RHS codegen "
@@ -50,56 +61,64 @@ TEST_CASE("CodegenFunction: ASTBinaryExpr throws InternalError on RHS codegen "
           "[CodegenFunctions]") {
   ASTBinaryExpr binaryExpr("+", std::make_shared<ASTInputExpr>(),
                            std::make_shared<nullcodegen::MockASTExpr>());
-  REQUIRE_THROWS_AS(binaryExpr.codegen(), InternalError);
+  CodeGenContext ctx;
+  REQUIRE_THROWS_AS(binaryExpr.codegen(ctx), InternalError);
 }
 
 TEST_CASE("CodegenFunction: ASTBinaryExpr throws InternalError on bad OP",
           "[CodegenFunctions]") {
   ASTBinaryExpr binaryExpr("ADDITION", std::make_shared<ASTInputExpr>(),
                            std::make_shared<ASTInputExpr>());
-  REQUIRE_THROWS_AS(binaryExpr.codegen(), InternalError);
+  CodeGenContext ctx;
+  REQUIRE_THROWS_AS(binaryExpr.codegen(ctx), InternalError);
 }
 
 TEST_CASE("CodegenFunction: ASTOutputStmt throws InternalError on ARG codegen "
           "nullptr",
           "[CodegenFunctions]") {
   ASTOutputStmt outputStmt(std::make_shared<nullcodegen::MockASTExpr>());
-  REQUIRE_THROWS_AS(outputStmt.codegen(), InternalError);
+  CodeGenContext ctx;
+  REQUIRE_THROWS_AS(outputStmt.codegen(ctx), InternalError);
 }
 
 TEST_CASE(
     "CodegenFunction: ASTErrorStmt throws InternalError on ARG codegen nullptr",
     "[CodegenFunctions]") {
   ASTErrorStmt errorStmt(std::make_shared<nullcodegen::MockASTExpr>());
-  REQUIRE_THROWS_AS(errorStmt.codegen(), InternalError);
+  CodeGenContext ctx;
+  REQUIRE_THROWS_AS(errorStmt.codegen(ctx), InternalError);
 }
 
 TEST_CASE(
     "CodegenFunction: ASTVariableExpr throws InternalError on unknown NAME",
     "[CodegenFunctions]") {
   ASTVariableExpr variableExpr("foobar");
-  REQUIRE_THROWS_AS(variableExpr.codegen(), InternalError);
+  CodeGenContext ctx;
+  REQUIRE_THROWS_AS(variableExpr.codegen(ctx), InternalError);
 }
 
 TEST_CASE("CodegenFunction: ASTAllocExpr throws InternalError on INIT codegen "
           "nullptr",
           "[CodegenFunctions]") {
   ASTAllocExpr allocExpr(std::make_shared<nullcodegen::MockASTExpr>());
-  REQUIRE_THROWS_AS(allocExpr.codegen(), InternalError);
+  CodeGenContext ctx;
+  REQUIRE_THROWS_AS(allocExpr.codegen(ctx), InternalError);
 }
 
 TEST_CASE(
     "CodegenFunction: ASTRefExpr throws InternalError on VAR codegen nullptr",
     "[CodegenFunctions]") {
   ASTRefExpr refExpr(std::make_shared<nullcodegen::MockASTExpr>());
-  REQUIRE_THROWS_AS(refExpr.codegen(), InternalError);
+  CodeGenContext ctx;
+  REQUIRE_THROWS_AS(refExpr.codegen(ctx), InternalError);
 }
 
 TEST_CASE(
     "CodegenFunction: ASTDeRefExpr throws InternalError on VAR codegen nullptr",
     "[CodegenFunctions]") {
   ASTDeRefExpr deRefExpr(std::make_shared<nullcodegen::MockASTExpr>());
-  REQUIRE_THROWS_AS(deRefExpr.codegen(), InternalError);
+  CodeGenContext ctx;
+  REQUIRE_THROWS_AS(deRefExpr.codegen(ctx), InternalError);
 }
 
 TEST_CASE(
@@ -107,7 +126,8 @@ TEST_CASE(
     "[CodegenFunctions]") {
   ASTAccessExpr accessExpr(std::make_shared<nullcodegen::MockASTExpr>(),
                            "foobar");
-  REQUIRE_THROWS_AS(accessExpr.codegen(), InternalError);
+  CodeGenContext ctx;
+  REQUIRE_THROWS_AS(accessExpr.codegen(ctx), InternalError);
 }
 
 TEST_CASE("CodegenFunction: ASTFunAppExpr throws InternalError on FUN codegen "
@@ -116,5 +136,119 @@ TEST_CASE("CodegenFunction: ASTFunAppExpr throws InternalError on FUN codegen "
   std::vector<std::shared_ptr<ASTExpr>> actuals;
   ASTFunAppExpr funAppExpr(std::make_shared<nullcodegen::MockASTExpr>(),
                            actuals);
-  REQUIRE_THROWS_AS(funAppExpr.codegen(), InternalError);
+  CodeGenContext ctx;
+  REQUIRE_THROWS_AS(funAppExpr.codegen(ctx), InternalError);
+}
+
+TEST_CASE("CodegenFunction: modules keep their LLVM context alive",
+          "[CodegenFunctions]") {
+  std::shared_ptr<llvm::Module> first;
+  std::shared_ptr<llvm::Module> second;
+  {
+    CodeGenContext ctx1;
+    CodeGenContext ctx2;
+    first = ctx1.createModule("first");
+    second = ctx2.createModule("second");
+  }
+
+  // Each compilation has an LLVM context of its own
+  REQUIRE(&first->getContext() != &second->getContext());
+  REQUIRE(first->getFunction("main") == nullptr);
+  REQUIRE(llvm::Type::getInt64Ty(first->getContext())->getIntegerBitWidth() ==
+          64);
+}
+
+TEST_CASE("CodegenFunction: generated module does not depend on the number "
+          "of jobs",
+          "[CodegenFunctions]") {
+  std::stringstream program;
+  program << R"(
+      inc(x) {
+        return x + 1;
+      }
+      twice(f, x) {
+        return f(f(x));
+      }
+      sum(n) {
+        var r;
+        r = {f: n};
+        if (n > 0) {
+          n = sum(n - 1) + r.f;
+        }
+        return n;
+      }
+      main(n) {
+        output twice(inc, n);
+        return sum(n);
+      }
+    )";
+
+  auto ast = ASTHelper::build_ast(program);
+  auto analysisResults = SemanticAnalysis::analyze(ast.get(), false);
+
+  std::vector<std::string> printed;
+  for (unsigned jobs : {1, 4}) {
+    auto module = ast->codegen(analysisResults.get(), "prog", jobs);
+    REQUIRE_FALSE(llvm::verifyModule(*module, &llvm::errs()));
+    REQUIRE(module->getFunction("inc")->hasInternalLinkage());
+    REQUIRE(module->getFunction("_tip_main")->hasExternalLinkage());
+
+    std::string ir;
+    llvm::raw_string_ostream stream(ir);
+    module->print(stream, nullptr);
+    printed.push_back(stream.str());
+  }
+  REQUIRE(printed[0] == printed[1]);
+}
+
+TEST_CASE("CodegenFunction: cached functions are only generated when they "
+          "change",
+          "[CodegenFunctions]") {
+  std::string functions = R"(
+      twice(f, x) {
+        return f(f(x));
+      }
+      main(n) {
+        return twice(inc, n);
+      }
+    )";
+  std::string original = "inc(x) { return x + 1; }" + functions;
+  std::string changed = "inc(x) { return x + 2; }" + functions;
+
+  llvm::SmallString<128> directory;
+  REQUIRE_FALSE(llvm::sys::fs::createUniqueDirectory("tipc-cache", directory));
+  auto countEntries = [&directory]() {
+    int count = 0;
+    std::error_code error;
+    for (llvm::sys::fs::directory_iterator entry(directory, error), end;
+         !error && entry != end; entry.increment(error)) {
+      count++;
+    }
+    return count;
+  };
+
+  // Modules generated with and without the cache are the same
+  auto generate = [](const std::string &source, const std::string &cache) {
+    std::stringstream program(source);
+    auto ast = ASTHelper::build_ast(program);
+    auto analysisResults = SemanticAnalysis::analyze(ast.get(), false);
+    CodeGenContext ctx;
+    ctx.functionCache = cache;
+    auto module = ast->codegen(ctx, analysisResults.get(), "prog");
+    std::string ir;
+    llvm::raw_string_ostream stream(ir);
+    module->print(stream, nullptr);
+    return stream.str();
+  };
+
+  REQUIRE(generate(original, directory.str().str()) == generate(original, ""));
+  REQUIRE(countEntries() == 3);
+  REQUIRE(generate(original, directory.str().str()) == generate(original, ""));
+  REQUIRE(countEntries() == 3);
+
+  // Only the changed function is added
+  REQUIRE(generate(changed, directory.str().str()) == generate(changed, ""));
+  REQUIRE(countEntries() == 4);
+
+  llvm::sys::fs::remove_directories(directory);
 }
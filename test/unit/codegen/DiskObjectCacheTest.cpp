@@ -0,0 +1,83 @@
+#include "ASTHelper.h"
+#include "CodeGenerator.h"
+#include "DiskObjectCache.h"
+#include "SemanticAnalysis.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <sstream>
+
+TEST_CASE("DiskObjectCache: objects are found by module identifier",
+          "[DiskObjectCache]") {
+  llvm::SmallString<128> directory;
+  REQUIRE_FALSE(llvm::sys::fs::createUniqueDirectory("tipc-cache", directory));
+  llvm::SmallString<128> objects(directory);
+  llvm::sys::path::append(objects, "objects");
+
+  llvm::LLVMContext context;
+  llvm::Module first("0123abcd", context);
+  llvm::Module second("4567cdef", context);
+
+  // The directory is only created once an object is stored
+  DiskObjectCache cache(objects.str().str());
+  REQUIRE(cache.getObject(&first) == nullptr);
+  cache.notifyObjectCompiled(&first,
+                             llvm::MemoryBufferRef("object code", "first"));
+
+  // Objects outlive the cache that stored them
+  DiskObjectCache other(objects.str().str());
+  auto object = other.getObject(&first);
+  REQUIRE(object != nullptr);
+  REQUIRE(object->getBuffer() == "object code");
+  REQUIRE(other.getObject(&second) == nullptr);
+
+  llvm::sys::fs::remove_directories(directory);
+}
+
+TEST_CASE("DiskObjectCache: programs run in memory cache their native code",
+          "[DiskObjectCache]") {
+  std::stringstream program;
+  program << R"(
+      inc(x) {
+        return x + 1;
+      }
+      main(n) {
+        var x;
+        x = inc(n);
+        if (x != 42) error x;
+        return x;
+      }
+    )";
+
+  auto ast = ASTHelper::build_ast(program);
+  auto analysisResults = SemanticAnalysis::analyze(ast.get(), false);
+  auto module =
+      CodeGenerator::generate(ast.get(), analysisResults.get(), "prog");
+  CodeGenerator::linkRuntime(module.get());
+
+  llvm::SmallString<128> directory;
+  REQUIRE_FALSE(llvm::sys::fs::createUniqueDirectory("tipc-cache", directory));
+  auto countObjects = [&directory]() {
+    int count = 0;
+    std::error_code error;
+    for (llvm::sys::fs::directory_iterator entry(directory, error), end;
+         !error && entry != end; entry.increment(error)) {
+      count++;
+    }
+    return count;
+  };
+
+  // The second run finds the object of the first
+  REQUIRE(CodeGenerator::run(module.get(), {"prog", "41"},
+                             directory.str().str()) == 0);
+  REQUIRE(countObjects() == 1);
+  REQUIRE(CodeGenerator::run(module.get(), {"prog", "41"},
+                             directory.str().str()) == 0);
+  REQUIRE(countObjects() == 1);
+
+  llvm::sys::fs::remove_directories(directory);
+}
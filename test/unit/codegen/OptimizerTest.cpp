@@ -0,0 +1,160 @@
+#include "ASTHelper.h"
+#include "CodeGenerator.h"
+#include "Optimizer.h"
+#include "SemanticAnalysis.h"
+#include "llvm/IR/Verifier.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <set>
+#include <sstream>
+
+namespace {
+/*
+ * Functions that do not call each other end up in distinct partitions, so
+ * that several jobs split the program, optimize its partitions apart and
+ * put their bodies back into it.
+ */
+const char *const program = R"(
+    inc(x) { return x + 1; }
+    twice(x) { return inc(inc(x)); }
+    sum(n) {
+      var s;
+      s = 0;
+      while (n > 0) { s = s + n; n = n - 1; }
+      return s;
+    }
+    fact(n) {
+      var f;
+      f = 1;
+      while (n > 1) { f = f * n; n = n - 1; }
+      return f;
+    }
+    deref(p) { return *p; }
+    store(p, v) { *p = v; return v; }
+    main(n) { return twice(n) + sum(n); }
+  )";
+
+std::shared_ptr<llvm::Module> generate() {
+  std::stringstream source;
+  source << program;
+  auto ast = ASTHelper::build_ast(source);
+  auto analysisResults = SemanticAnalysis::analyze(ast.get(), false);
+  return CodeGenerator::generate(ast.get(), analysisResults.get(), "prog");
+}
+
+std::set<std::string> definedFunctions(llvm::Module &m) {
+  std::set<std::string> names;
+  for (auto &fn : m) {
+    if (!fn.isDeclaration()) {
+      names.insert(fn.getName().str());
+    }
+  }
+  return names;
+}
+
+std::string print(llvm::Module &m) {
+  std::string text;
+  llvm::raw_string_ostream stream(text);
+  m.print(stream, nullptr);
+  return stream.str();
+}
+} // namespace
+
+TEST_CASE("Optimizer: basic passes give the same module for any jobs",
+          "[Optimizer]") {
+  auto single = generate();
+  auto split = generate();
+  Optimizer::optimize(single.get(), 1);
+  Optimizer::optimize(split.get(), 4);
+
+  REQUIRE_FALSE(llvm::verifyModule(*single, &llvm::errs()));
+  REQUIRE_FALSE(llvm::verifyModule(*split, &llvm::errs()));
+  REQUIRE(definedFunctions(*single) == definedFunctions(*split));
+  REQUIRE(print(*single) == print(*split));
+}
+
+TEST_CASE("Optimizer: partitions optimized at a level give a valid module",
+          "[Optimizer]") {
+  auto single = generate();
+  auto split = generate();
+  Optimizer::optimize(single.get(), 1, 2);
+  Optimizer::optimize(split.get(), 4, 2);
+
+  REQUIRE_FALSE(llvm::verifyModule(*single, &llvm::errs()));
+  REQUIRE_FALSE(llvm::verifyModule(*split, &llvm::errs()));
+  REQUIRE(definedFunctions(*single) == definedFunctions(*split));
+}
+
+TEST_CASE("Optimizer: a connected program is split into partitions",
+          "[Optimizer]") {
+  // Every function is reachable from main and even and odd are recursive
+  std::stringstream source;
+  source << R"(
+    even(n) { var r; if (n == 0) { r = 1; } else { r = odd(n - 1); } return r; }
+    odd(n) { var r; if (n == 0) { r = 0; } else { r = even(n - 1); } return r; }
+    sum(n) {
+      var s;
+      s = 0;
+      while (n > 0) { s = s + n; n = n - 1; }
+      return s;
+    }
+    fact(n) {
+      var f;
+      f = 1;
+      while (n > 1) { f = f * n; n = n - 1; }
+      return f + sum(n);
+    }
+    squares(n) {
+      var s;
+      s = 0;
+      while (n > 0) { s = s + n * n; n = n - 1; }
+      return s + fact(n);
+    }
+    main(n) { return squares(n) + even(n); }
+  )";
+  auto ast = ASTHelper::build_ast(source);
+  auto analysisResults = SemanticAnalysis::analyze(ast.get(), false);
+  auto module =
+      CodeGenerator::generate(ast.get(), analysisResults.get(), "prog");
+  auto names = definedFunctions(*module);
+
+  auto partitions = Optimizer::partition(module.get(), 4);
+  REQUIRE(partitions.size() > 1);
+  std::size_t count = 0;
+  std::set<std::string> partitioned;
+  for (auto &functions : partitions) {
+    count += functions.size();
+    std::set<std::string> members;
+    for (auto *fn : functions) {
+      members.insert(fn->getName().str());
+    }
+    REQUIRE(members.count("even") == members.count("odd"));
+    partitioned.insert(members.begin(), members.end());
+  }
+  REQUIRE(count == names.size());
+  REQUIRE(partitioned == names);
+
+  Optimizer::optimize(module.get(), 4, 2);
+  REQUIRE_FALSE(llvm::verifyModule(*module, &llvm::errs()));
+}
+
+TEST_CASE("Optimizer: runtime functions linked into the program are inlined",
+          "[Optimizer]") {
+  // --lto optimizes the program and the runtime library at level 2
+  std::stringstream source;
+  source << "main(n) { output n; return n; }";
+  auto ast = ASTHelper::build_ast(source);
+  auto analysisResults = SemanticAnalysis::analyze(ast.get(), false);
+  auto module =
+      CodeGenerator::generate(ast.get(), analysisResults.get(), "prog");
+  CodeGenerator::linkRuntime(module.get());
+  REQUIRE(definedFunctions(*module).count("_tip_output") == 1);
+
+  Optimizer::optimize(module.get(), 1, 2);
+
+  REQUIRE_FALSE(llvm::verifyModule(*module, &llvm::errs()));
+  REQUIRE(module->getFunction("_tip_output") == nullptr);
+  REQUIRE(definedFunctions(*module).count("main") == 1);
+}
@@ -1,4 +1,6 @@
 #include "ASTHelper.h"
+#include "ParseError.h"
+#include "PrettyPrinter.h"
 
 #include "antlr4-runtime.h"
 #include <TIPLexer.h>
@@ -7,6 +9,8 @@
 #include <catch2/catch_test_macros.hpp>
 
 #include <iostream>
+#include <thread>
+#include <vector>
 
 TEST_CASE("ASTBuilder: bad op string throws error", "[ASTBuilder]") {
   // Boilerplate just to setup a legitimate builder.
@@ -28,3 +32,62 @@ TEST_CASE("ASTBuilder: bad op string throws error", "[ASTBuilder]") {
 
   REQUIRE_THROWS_AS(tb.visitAdditiveExpr(&context), std::runtime_error);
 }
+
+TEST_CASE("ASTBuilder: numbers out of range throw error", "[ASTBuilder]") {
+  std::stringstream big("main() { return 2147483648; }");
+  REQUIRE_THROWS_AS(ASTHelper::build_ast(big), ParseError);
+
+  std::stringstream small("main() { return -2147483649; }");
+  REQUIRE_THROWS_AS(ASTHelper::build_ast(small), ParseError);
+
+  std::stringstream smallest("main() { return -2147483648; }");
+  REQUIRE_NOTHROW(ASTHelper::build_ast(smallest));
+}
+
+TEST_CASE("ASTBuilder: programs can be built concurrently", "[ASTBuilder]") {
+  // Each program has a different shape, so nodes leaking between builders
+  // would show up in the printed programs.
+  std::vector<std::string> programs;
+  for (int i = 0; i < 8; i++) {
+    std::stringstream program;
+    program << "f" << i << "(p) { var x; x = p";
+    for (int j = 0; j <= i; j++) {
+      program << " + " << j;
+    }
+    program << "; if (x > " << i << ") { output x; } return *&x; }\n";
+    programs.push_back(program.str());
+  }
+
+  auto print = [](const std::string &program) {
+    std::stringstream stream(program);
+    auto ast = ASTHelper::build_ast(stream);
+    std::stringstream printed;
+    PrettyPrinter::print(ast.get(), printed, ' ', 2);
+    return printed.str();
+  };
+
+  std::vector<std::string> expected;
+  for (auto &program : programs) {
+    expected.push_back(print(program));
+  }
+
+  std::vector<std::string> actual(programs.size());
+  std::vector<std::thread> threads;
+  for (std::size_t i = 0; i < programs.size(); i++) {
+    threads.emplace_back([&, i] {
+      for (int round = 0; round < 50; round++) {
+        auto printed = print(programs[i]);
+        if (printed != expected[i]) {
+          actual[i] = printed;
+          return;
+        }
+      }
+      actual[i] = expected[i];
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  REQUIRE(actual == expected);
+}
@@ -159,6 +159,16 @@ TEST_CASE("TIP Parser: input", "[TIP Parser]")
   REQUIRE(ParserHelper::is_parsable(stream));
 }
 
+TEST_CASE("TIP Parser: clock", "[TIP Parser]")
+{
+  std::stringstream stream;
+  stream << R"(
+      elapsed() { var t; t = clock; output clock - t; return clock; }
+    )";
+
+  REQUIRE(ParserHelper::is_parsable(stream));
+}
+
 TEST_CASE("TIP Parser: address of field access", "[TIP Parser]")
 {
   std::stringstream stream;
@@ -347,3 +357,105 @@ TEST_CASE("TIP Parser: Parsing exceptions are thrown", "[TIP Parser]")
   REQUIRE_THROWS_MATCHES(FrontEnd::parse(stream), ParseError,
                          ContainsWhat("missing ';'"));
 }
+
+TEST_CASE("TIP Parser: Parsing exceptions give the location of the error",
+          "[TIP Parser]")
+{
+  std::stringstream stream;
+  stream << R"(
+      main() {
+        var x;
+        x = (1 + 2;
+        return x;
+      }
+    )";
+
+  REQUIRE_THROWS_MATCHES(FrontEnd::parse(stream), ParseError,
+                         ContainsWhat("@4:18"));
+}
+
+TEST_CASE("TIP Parser: Programs SLL cannot predict are parsed with full LL",
+          "[TIP Parser]")
+{
+  /*
+   * Without the context of the statement, SLL prediction takes the "++" of
+   * "x++;" as part of the expression, which leaves the statement without its
+   * operator.  Only the full LL parse that follows accepts the program.
+   */
+  std::stringstream stream;
+  stream << R"(
+      main() {
+        var x;
+        x = 0;
+        x++;
+        return x;
+      }
+    )";
+  std::stringstream expected;
+  expected << R"(
+      main() {
+        var x;
+        x = 0;
+        x = x + 1;
+        return x;
+      }
+    )";
+
+  std::shared_ptr<ASTProgram> program;
+  REQUIRE_NOTHROW(program = FrontEnd::parse(stream));
+
+  std::stringstream programOut, expectedOut;
+  FrontEnd::prettyprint(program.get(), programOut);
+  FrontEnd::prettyprint(FrontEnd::parse(expected).get(), expectedOut);
+  REQUIRE(programOut.str() == expectedOut.str());
+}
+
+TEST_CASE("TIP Parser: text is parsed as a stream is", "[TIP Parser]")
+{
+  std::string program = R"(
+      // A comment
+      inc(x) { return x + 1; }
+      main() { var y; y = inc(input); output y; return 0; }
+    )";
+  std::stringstream stream(program);
+
+  auto fromStream = FrontEnd::parse(stream);
+  auto fromText = FrontEnd::parse(std::string_view(program));
+
+  std::stringstream streamOut, textOut;
+  FrontEnd::prettyprint(fromStream.get(), streamOut);
+  FrontEnd::prettyprint(fromText.get(), textOut);
+  REQUIRE(textOut.str() == streamOut.str());
+  REQUIRE(fromText->getName() == fromStream->getName());
+  for (auto *fn : fromText->getFunctions())
+  {
+    REQUIRE(fn->getSourceHash() ==
+            fromStream->findFunctionByName(fn->getName())->getSourceHash());
+  }
+}
+
+TEST_CASE("TIP Parser: text with UTF-8 comments is parsed", "[TIP Parser]")
+{
+  std::string program = "main() { /* \xc3\xa9t\xc3\xa9 */ return 0; }";
+  std::stringstream stream(program);
+
+  auto fromStream = FrontEnd::parse(stream);
+  auto fromText = FrontEnd::parse(std::string_view(program));
+  REQUIRE(fromText->getName() == fromStream->getName());
+}
+
+TEST_CASE("TIP Parser: Parsing exceptions in text give the location of the "
+          "error",
+          "[TIP Parser]")
+{
+  std::string program = R"(
+      main() {
+        var x;
+        x = (1 + 2;
+        return x;
+      }
+    )";
+
+  REQUIRE_THROWS_MATCHES(FrontEnd::parse(std::string_view(program)),
+                         ParseError, ContainsWhat("@4:18"));
+}
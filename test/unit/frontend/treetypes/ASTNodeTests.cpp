@@ -352,6 +352,26 @@ TEST_CASE("ASTInputExprTest: Test methods of AST subtype.",
    REQUIRE(expr != nullptr);
 }
 
+TEST_CASE("ASTClockExprTest: Test methods of AST subtype.",
+          "[ASTNodes]")
+{
+   std::stringstream stream;
+   stream << R"(
+      foo() {
+         return clock;
+      }
+    )";
+
+   auto ast = ASTHelper::build_ast(stream);
+   auto expr = ASTHelper::find_node<ASTClockExpr>(ast);
+
+   REQUIRE(expr != nullptr);
+
+   std::stringstream o1;
+   o1 << *expr;
+   REQUIRE(o1.str() == "clock");
+}
+
 TEST_CASE("ASTNullExprTest: Test methods of AST subtype.",
           "[ASTNodes]")
 {
@@ -4,7 +4,7 @@
 namespace nullcodegen {
 class MockASTExpr : public ASTExpr {
 public:
-  llvm::Value *codegen() override { return nullptr; }
+  llvm::Value *codegen(CodeGenContext &ctx) override { return nullptr; }
 
   void accept(ASTVisitor *visitor) override {}
 
@@ -13,7 +13,7 @@ public:
 
 class MockASTStmt : public ASTStmt {
 public:
-  llvm::Value *codegen() override { return nullptr; }
+  llvm::Value *codegen(CodeGenContext &ctx) override { return nullptr; }
 
   void accept(ASTVisitor *visitor) override {}
 
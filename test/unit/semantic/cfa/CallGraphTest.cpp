@@ -279,6 +279,91 @@ TEST_CASE("CallGraph: test getCallers by ASTFunction*"
   REQUIRE(callers.find(caller) != callers.end());
 }
 
+TEST_CASE("CallGraph: function returned from a nullary function"
+          "[CallGraph]") {
+  std::stringstream program;
+  program << R"(
+      foo(x) {
+        return x;
+      }
+      bar() {
+        return foo;
+      }
+      main() {
+        return bar()(7);
+      }
+    )";
+
+  /* Call graph should be:
+   *   main->bar	direct call
+   *   main->foo	indirect call through the value returned by bar
+   */
+
+  auto ast = ASTHelper::build_ast(program);
+  auto symTable = SymbolTable::build(ast.get());
+  auto callGraph = CallGraph::build(ast.get(), symTable.get());
+
+  REQUIRE(callGraph.get()->getTotalEdges() == 2);
+  REQUIRE(callGraph.get()->existEdge("main", "bar"));
+  REQUIRE(callGraph.get()->existEdge("main", "foo"));
+}
+
+TEST_CASE("CallGraph: strongly connected components"
+          "[CallGraph]") {
+  std::stringstream program;
+  program << R"(
+      even(n) {
+        var r;
+        if (n == 0) { r = 1; } else { r = odd(n - 1); }
+        return r;
+      }
+      odd(n) {
+        var r;
+        if (n == 0) { r = 0; } else { r = even(n - 1); }
+        return r;
+      }
+      fact(n) {
+        var r;
+        if (n == 0) { r = 1; } else { r = n * fact(n - 1); }
+        return r;
+      }
+      id(x) {
+        return x;
+      }
+      main() {
+        return even(id(4)) + fact(3);
+      }
+    )";
+
+  /* Components in reverse topological order should be:
+   *   {even, odd}, {fact}, {id}, {main}
+   * where callees come before their callers.
+   */
+
+  auto ast = ASTHelper::build_ast(program);
+  auto symTable = SymbolTable::build(ast.get());
+  auto callGraph = CallGraph::build(ast.get(), symTable.get());
+
+  auto even = callGraph->getASTFun("even");
+  auto odd = callGraph->getASTFun("odd");
+  auto fact = callGraph->getASTFun("fact");
+  auto id = callGraph->getASTFun("id");
+  auto main = callGraph->getASTFun("main");
+
+  REQUIRE(callGraph->getSCCs().size() == 4);
+  REQUIRE(callGraph->getSCCIndex(even) == callGraph->getSCCIndex(odd));
+  REQUIRE(callGraph->getSCCs().at(callGraph->getSCCIndex(even)).size() == 2);
+  REQUIRE(callGraph->getSCCIndex(main) == 3);
+  REQUIRE(callGraph->getSCCIndex(fact) < callGraph->getSCCIndex(main));
+  REQUIRE(callGraph->getSCCIndex(id) < callGraph->getSCCIndex(main));
+
+  REQUIRE(callGraph->isRecursive(even));
+  REQUIRE(callGraph->isRecursive(odd));
+  REQUIRE(callGraph->isRecursive(fact));
+  REQUIRE_FALSE(callGraph->isRecursive(id));
+  REQUIRE_FALSE(callGraph->isRecursive(main));
+}
+
 TEST_CASE("CallGraph: test getEdges"
           "[CallGraph]") {
   std::stringstream program;
@@ -0,0 +1,126 @@
+#include "CubicSolver.h"
+#include "ASTHelper.h"
+#include "ASTNumberExpr.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+
+namespace {
+/*
+ * The solver only uses the nodes of constraints as the names of its
+ * variables, so the variables of the tests are distinct number literals.
+ */
+std::vector<std::shared_ptr<ASTNode>> variables(int count) {
+  std::vector<std::shared_ptr<ASTNode>> vars;
+  for (int i = 0; i < count; i++) {
+    vars.push_back(std::make_shared<ASTNumberExpr>(i));
+  }
+  return vars;
+}
+
+std::shared_ptr<ASTProgram> functions() {
+  std::stringstream program;
+  program << R"(
+      f() { return 1; }
+      g() { return 2; }
+      h() { return 3; }
+      k() { return 4; }
+    )";
+  return ASTHelper::build_ast(program);
+}
+
+bool contains(CubicSolver &solver, ASTNode *var, ASTFunction *fn) {
+  auto possible = solver.getPossibleFunctionsForExpr(var);
+  return std::find(possible.begin(), possible.end(), fn) != possible.end();
+}
+} // namespace
+
+TEST_CASE("CubicSolver: tokens flow down a long subset chain",
+          "[CubicSolver]") {
+  auto ast = functions();
+  auto fns = ast->getFunctions();
+  auto f = fns[0], g = fns[1];
+  auto vars = variables(5000);
+
+  CubicSolver solver(fns);
+  solver.addElementofConstraint(f, vars[0].get());
+  for (std::size_t i = 0; i + 1 < vars.size(); i++) {
+    solver.addSubseteqConstraint(vars[i].get(), vars[i + 1].get());
+  }
+  // A token added at the head of the complete chain is propagated in one go
+  solver.addElementofConstraint(g, vars[0].get());
+
+  for (auto &var : vars) {
+    REQUIRE(contains(solver, var.get(), f));
+    REQUIRE(contains(solver, var.get(), g));
+  }
+  REQUIRE(solver.getPossibleFunctionsForExpr(vars.back().get()).size() == 2);
+}
+
+TEST_CASE("CubicSolver: a collapsed cycle shares later tokens",
+          "[CubicSolver]") {
+  auto ast = functions();
+  auto fns = ast->getFunctions();
+  auto f = fns[0], g = fns[1], h = fns[2];
+  auto vars = variables(5);
+
+  CubicSolver solver(fns);
+  solver.addElementofConstraint(f, vars[0].get());
+  solver.addSubseteqConstraint(vars[0].get(), vars[1].get());
+  solver.addSubseteqConstraint(vars[1].get(), vars[2].get());
+  solver.addSubseteqConstraint(vars[2].get(), vars[3].get());
+  // Closing the cycle leaves its members with equal solutions
+  solver.addSubseteqConstraint(vars[3].get(), vars[0].get());
+
+  // Tokens added to any member of the cycle reach all of them
+  solver.addElementofConstraint(g, vars[2].get());
+  solver.addElementofConstraint(h, vars[3].get());
+  for (int i = 0; i < 4; i++) {
+    REQUIRE(contains(solver, vars[i].get(), f));
+    REQUIRE(contains(solver, vars[i].get(), g));
+    REQUIRE(contains(solver, vars[i].get(), h));
+  }
+
+  // As do the supersets of any member
+  solver.addSubseteqConstraint(vars[1].get(), vars[4].get());
+  REQUIRE(solver.getPossibleFunctionsForExpr(vars[4].get()).size() == 3);
+}
+
+TEST_CASE("CubicSolver: conditions on merged variables are activated",
+          "[CubicSolver]") {
+  auto ast = functions();
+  auto fns = ast->getFunctions();
+  auto f = fns[0], g = fns[1], h = fns[2], k = fns[3];
+  auto vars = variables(6);
+  auto a = vars[0].get(), b = vars[1].get();
+
+  CubicSolver solver(fns);
+
+  // A condition on b, which is then merged into a cycle with a
+  solver.addConditionalConstraint(g, b, vars[2].get(), vars[3].get());
+  solver.addElementofConstraint(f, a);
+  solver.addSubseteqConstraint(a, b);
+  solver.addSubseteqConstraint(b, a);
+
+  // The cycle is collapsed when a token next flows along it
+  solver.addElementofConstraint(k, a);
+  REQUIRE(contains(solver, b, k));
+
+  // A condition on a member of the collapsed cycle
+  solver.addConditionalConstraint(h, b, vars[4].get(), vars[5].get());
+
+  solver.addElementofConstraint(f, vars[2].get());
+  solver.addElementofConstraint(f, vars[4].get());
+  REQUIRE_FALSE(contains(solver, vars[3].get(), f));
+  REQUIRE_FALSE(contains(solver, vars[5].get(), f));
+
+  // The conditions hold once their tokens reach the cycle through a
+  solver.addElementofConstraint(g, a);
+  REQUIRE(contains(solver, vars[3].get(), f));
+  REQUIRE_FALSE(contains(solver, vars[5].get(), f));
+
+  solver.addElementofConstraint(h, a);
+  REQUIRE(contains(solver, vars[5].get(), f));
+  REQUIRE(contains(solver, b, h));
+}
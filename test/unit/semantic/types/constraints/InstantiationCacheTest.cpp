@@ -0,0 +1,115 @@
+#include "InstantiationCache.h"
+#include "ASTVariableExpr.h"
+#include "TipAlpha.h"
+#include "TipFunction.h"
+#include "TipInt.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+TEST_CASE("InstantiationCache: types without alphas are shared",
+          "[InstantiationCache]") {
+  ASTVariableExpr caller("main");
+  ASTVariableExpr fn("f");
+  ASTVariableExpr call1("f(1)");
+  ASTVariableExpr call2("f(2)");
+
+  std::vector<std::shared_ptr<TipType>> params{std::make_shared<TipInt>()};
+  std::shared_ptr<TipType> generic =
+      std::make_shared<TipFunction>(params, std::make_shared<TipInt>());
+
+  InstantiationCache cache;
+  auto first = cache.instantiate(&caller, &fn, generic, &call1, std::nullopt);
+  auto second = cache.instantiate(&caller, &fn, generic, &call2, std::nullopt);
+
+  REQUIRE(*first == *generic);
+  REQUIRE(first == second);
+  REQUIRE(cache.getLookups() == 2);
+  REQUIRE(cache.getHits() == 1);
+}
+
+TEST_CASE("InstantiationCache: alphas are fresh for calls of unknown shape",
+          "[InstantiationCache]") {
+  ASTVariableExpr caller("main");
+  ASTVariableExpr fn("ident");
+  ASTVariableExpr param("p");
+  ASTVariableExpr call1("ident(1)");
+  ASTVariableExpr call2("ident(2)");
+
+  auto alpha = std::make_shared<TipAlpha>(&param);
+  std::vector<std::shared_ptr<TipType>> params{alpha};
+  std::shared_ptr<TipType> generic =
+      std::make_shared<TipFunction>(params, alpha);
+
+  InstantiationCache cache;
+  auto first = cache.instantiate(&caller, &fn, generic, &call1, std::nullopt);
+  auto second = cache.instantiate(&caller, &fn, generic, &call2, std::nullopt);
+
+  auto fresh = std::make_shared<TipAlpha>(&param, &call1, "");
+  std::vector<std::shared_ptr<TipType>> freshParams{fresh};
+  TipFunction expected(freshParams, fresh);
+
+  REQUIRE(*first == expected);
+  REQUIRE(*first != *second);
+  REQUIRE(cache.getLookups() == 2);
+  REQUIRE(cache.getHits() == 0);
+}
+
+TEST_CASE("InstantiationCache: calls of the same shape share an instance",
+          "[InstantiationCache]") {
+  ASTVariableExpr caller("main");
+  ASTVariableExpr other("other");
+  ASTVariableExpr fn("ident");
+  ASTVariableExpr param("p");
+  ASTVariableExpr call1("ident(1)");
+  ASTVariableExpr call2("ident(2)");
+  ASTVariableExpr call3("ident(true)");
+  ASTVariableExpr call4("ident(3)");
+
+  auto alpha = std::make_shared<TipAlpha>(&param);
+  std::vector<std::shared_ptr<TipType>> params{alpha};
+  std::shared_ptr<TipType> generic =
+      std::make_shared<TipFunction>(params, alpha);
+
+  InstantiationCache::Shape ints{{nullptr, "int"}};
+  InstantiationCache::Shape bools{{nullptr, "bool"}};
+
+  InstantiationCache cache;
+  auto first = cache.instantiate(&caller, &fn, generic, &call1, ints);
+  auto second = cache.instantiate(&caller, &fn, generic, &call2, ints);
+  auto third = cache.instantiate(&caller, &fn, generic, &call3, bools);
+  auto fourth = cache.instantiate(&other, &fn, generic, &call4, ints);
+
+  auto fresh = std::make_shared<TipAlpha>(&param, &call1, "");
+  std::vector<std::shared_ptr<TipType>> freshParams{fresh};
+  TipFunction expected(freshParams, fresh);
+
+  REQUIRE(*first == expected);
+  REQUIRE(first == second);
+  REQUIRE(*third != *first);
+  REQUIRE(*fourth != *first);
+  REQUIRE(cache.getLookups() == 4);
+  REQUIRE(cache.getHits() == 1);
+}
+
+TEST_CASE("InstantiationCache: alphas only in the return type are fresh",
+          "[InstantiationCache]") {
+  ASTVariableExpr caller("main");
+  ASTVariableExpr fn("make");
+  ASTVariableExpr result("r");
+  ASTVariableExpr call1("make(1)");
+  ASTVariableExpr call2("make(2)");
+
+  // The calls may return values of different types
+  std::vector<std::shared_ptr<TipType>> params{std::make_shared<TipInt>()};
+  std::shared_ptr<TipType> generic = std::make_shared<TipFunction>(
+      params, std::make_shared<TipAlpha>(&result));
+
+  InstantiationCache::Shape ints{{nullptr, "int"}};
+
+  InstantiationCache cache;
+  auto first = cache.instantiate(&caller, &fn, generic, &call1, ints);
+  auto second = cache.instantiate(&caller, &fn, generic, &call2, ints);
+
+  REQUIRE(*first != *second);
+  REQUIRE(cache.getHits() == 0);
+}
@@ -109,3 +109,51 @@ main() {
 
   testidentmain(program, expected);
 }
+
+TEST_CASE("PolyTypeConstraintVisitor: calls with arguments of the same types "
+          "share an instantiation",
+          "[TypeConstraintVisitor]")
+{
+  std::stringstream program;
+  program << R"(ident(p) poly {
+ return p;
+}
+
+main() {
+  var x, y;
+  x = ident(1);
+  y = ident(2);
+  return x + y;
+})";
+
+  auto ast = ASTHelper::build_ast(program);
+  auto symbols = SymbolTable::build(ast.get());
+  auto unifier = std::make_shared<Unifier>();
+  auto cg = CallGraph::build(ast.get(), symbols.get());
+
+  TypeConstraintCollectVisitor identVisitor(symbols.get());
+  cg->getASTFun("ident")->accept(&identVisitor);
+  unifier->add(identVisitor.getCollectedConstraints());
+  unifier->solve();
+
+  auto cache = std::make_shared<InstantiationCache>();
+  PolyTypeConstraintCollectVisitor mainVisitor(symbols.get(), cg.get(),
+                                               unifier, cache);
+  cg->getASTFun("main")->accept(&mainVisitor);
+
+  std::set<std::string> collectedSet;
+  for (auto &constraint : mainVisitor.getCollectedConstraints())
+  {
+    std::stringstream stream;
+    stream << constraint;
+    collectedSet.insert(stream.str());
+  }
+
+  // The second call uses the instance made for the first
+  REQUIRE(collectedSet.count(
+              "(\u03B1<p@1:6{ident(1)@7:6}>) -> "
+              "\u03B1<p@1:6{ident(1)@7:6}> = "
+              "(\u27E62@8:12\u27E7) -> \u27E6ident(2)@8:6\u27E7") == 1);
+  REQUIRE(cache->getLookups() == 2);
+  REQUIRE(cache->getHits() == 1);
+}
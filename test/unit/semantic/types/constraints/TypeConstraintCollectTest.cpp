@@ -68,6 +68,31 @@ TEST_CASE("TypeConstraintVisitor: input, const, arithmetic, return type",
   REQUIRE(*unifier.inferred(yType) == *TypeHelper::intType());
 }
 
+TEST_CASE("TypeConstraintVisitor: clock, return type",
+          "[TypeConstraintVisitor]")
+{
+  std::stringstream program;
+  program << R"(
+            // [[t]] = int, [[test]] = () -> int
+            test() {
+              var t;
+              t = clock;
+              return clock - t;
+            }
+         )";
+
+  auto unifierSymbols = collectAndSolve(program);
+  auto unifier = unifierSymbols.first;
+  auto symbols = unifierSymbols.second;
+  std::vector<std::shared_ptr<TipType>> empty;
+  auto fDecl = symbols->getFunction("test");
+  auto fType = std::make_shared<TipVar>(fDecl);
+  REQUIRE(*unifier.inferred(fType) == *TypeHelper::funType(empty, TypeHelper::intType()));
+
+  auto tType = std::make_shared<TipVar>(symbols->getLocal("t", fDecl));
+  REQUIRE(*unifier.inferred(tType) == *TypeHelper::intType());
+}
+
 TEST_CASE("TypeConstraintVisitor: booleans, return type",
           "[TypeConstraintVisitor]")
 {
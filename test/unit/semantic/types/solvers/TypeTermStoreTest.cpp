@@ -0,0 +1,95 @@
+#include "TypeTermStore.h"
+#include "ASTNumberExpr.h"
+#include "TipAlpha.h"
+#include "TipFunction.h"
+#include "TipInt.h"
+#include "TipMu.h"
+#include "TipRef.h"
+#include "TipVar.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <memory>
+#include <vector>
+
+TEST_CASE("TypeTermStore: Test interning variables", "[TypeTermStore]") {
+  ASTNumberExpr n(42);
+  ASTNumberExpr m(7);
+  auto var = std::make_shared<TipVar>(&n);
+  auto sameVar = std::make_shared<TipVar>(&n);
+  auto otherVar = std::make_shared<TipVar>(&m);
+  auto alpha = std::make_shared<TipAlpha>(&n);
+
+  TypeTermStore store;
+  auto id = store.intern(var);
+
+  REQUIRE(store.intern(sameVar) == id);
+  REQUIRE(store.canonical(sameVar) == var);
+  REQUIRE(store.intern(otherVar) != id);
+  REQUIRE(store.intern(alpha) != id);
+  REQUIRE(store.size() == 3);
+}
+
+TEST_CASE("TypeTermStore: Test sharing of subterms", "[TypeTermStore]") {
+  ASTNumberExpr n(42);
+  auto var = std::make_shared<TipVar>(&n);
+
+  std::vector<std::shared_ptr<TipType>> params{std::make_shared<TipInt>()};
+  auto fun = std::make_shared<TipFunction>(
+      params, std::make_shared<TipRef>(std::make_shared<TipVar>(&n)));
+  auto sameFun = std::make_shared<TipFunction>(
+      params, std::make_shared<TipRef>(std::make_shared<TipVar>(&n)));
+
+  TypeTermStore store;
+  store.intern(var);
+  auto canonicalFun =
+      std::dynamic_pointer_cast<TipFunction>(store.canonical(fun));
+
+  // fun had a non-canonical subterm so a copy was made
+  REQUIRE(*canonicalFun == *fun);
+  REQUIRE(store.canonical(sameFun) == canonicalFun);
+
+  // subterms are canonical
+  auto ref = std::dynamic_pointer_cast<TipRef>(canonicalFun->getReturnType());
+  REQUIRE(ref->getReferencedType() == var);
+  REQUIRE(canonicalFun->getParamTypes().front() ==
+          store.canonical(std::make_shared<TipInt>()));
+}
+
+TEST_CASE("TypeTermStore: Test interning mu types", "[TypeTermStore]") {
+  ASTNumberExpr n(42);
+  auto alpha = std::make_shared<TipAlpha>(&n);
+  auto mu = std::make_shared<TipMu>(alpha, std::make_shared<TipRef>(alpha));
+  auto sameMu = std::make_shared<TipMu>(
+      std::make_shared<TipAlpha>(&n),
+      std::make_shared<TipRef>(std::make_shared<TipAlpha>(&n)));
+
+  TypeTermStore store;
+  auto id = store.intern(mu);
+
+  REQUIRE(store.intern(sameMu) == id);
+  REQUIRE(store.canonical(sameMu) == mu);
+}
+
+TEST_CASE("TypeTermStore: Test duplicates are not kept", "[TypeTermStore]") {
+  ASTNumberExpr n(42);
+  auto var = std::make_shared<TipVar>(&n);
+
+  TypeTermStore store;
+  auto id = store.intern(var);
+
+  auto sameVar = std::make_shared<TipVar>(&n);
+  std::weak_ptr<TipType> duplicate = sameVar;
+  REQUIRE(store.intern(sameVar) == id);
+
+  // Only the canonical term is owned by the store
+  sameVar.reset();
+  REQUIRE(duplicate.expired());
+  REQUIRE(store.intern(std::make_shared<TipVar>(&n)) == id);
+  REQUIRE(store.size() == 1);
+}
+
+TEST_CASE("TypeTermStore: Test inserting nullptrs", "[TypeTermStore]") {
+  TypeTermStore store;
+  REQUIRE_THROWS_AS(store.intern(nullptr), std::invalid_argument);
+}
@@ -430,3 +430,100 @@ TEST_CASE("Unifier: Test closing mu ", "[Unifier]") {
 
   REQUIRE_NOTHROW(ss.str() == "\u03bc\u03B1<f>.(\u03B1<f>,int) -> int");
 }
+
+TEST_CASE("Unifier: Solving only unifies newly added constraints",
+          "[Unifier]") {
+  ASTVariableExpr variableExprA("a");
+  auto tipVarA = std::make_shared<TipVar>(&variableExprA);
+
+  ASTVariableExpr variableExprB("b");
+  auto tipVarB = std::make_shared<TipVar>(&variableExprB);
+
+  auto tipInt = std::make_shared<TipInt>();
+
+  std::vector<TypeConstraint> constraints{TypeConstraint(tipVarA, tipInt)};
+  Unifier unifier(constraints);
+  unifier.solve();
+  REQUIRE(unifier.getUnificationCount() == 1);
+
+  // Solving again has nothing left to unify
+  unifier.solve();
+  REQUIRE(unifier.getUnificationCount() == 1);
+
+  std::vector<TypeConstraint> more{TypeConstraint(tipVarB, tipVarA)};
+  unifier.add(more);
+  unifier.solve();
+  REQUIRE(unifier.getUnificationCount() == 2);
+
+  std::stringstream ss;
+  ss << *unifier.inferred(tipVarB);
+  REQUIRE(ss.str() == "int");
+}
+
+TEST_CASE("Unifier: Inferred types are cached until the solution changes",
+          "[Unifier]") {
+  ASTVariableExpr variableExprA("a");
+  auto tipVarA = std::make_shared<TipVar>(&variableExprA);
+
+  ASTVariableExpr variableExprB("b");
+  auto tipVarB = std::make_shared<TipVar>(&variableExprB);
+
+  auto tipRef = std::make_shared<TipRef>(tipVarB);
+
+  std::vector<TypeConstraint> constraints{TypeConstraint(tipVarA, tipRef)};
+  Unifier unifier(constraints);
+  unifier.solve();
+
+  // Equal type variables share the cached closed type
+  auto first = unifier.inferred(tipVarA);
+  auto second = unifier.inferred(std::make_shared<TipVar>(&variableExprA));
+  REQUIRE(first == second);
+
+  std::stringstream before;
+  before << *first;
+  REQUIRE(before.str() == "\u2B61\u03B1<b@0:0>");
+
+  std::vector<TypeConstraint> more{
+      TypeConstraint(tipVarB, std::make_shared<TipInt>())};
+  unifier.add(more);
+  unifier.solve();
+
+  std::stringstream after;
+  after << *unifier.inferred(tipVarA);
+  REQUIRE(after.str() == "\u2B61int");
+}
+
+TEST_CASE("Unifier: A solution merged into another unifier gives the same "
+          "types",
+          "[Unifier]") {
+  ASTVariableExpr variableExprA("a");
+  auto tipVarA = std::make_shared<TipVar>(&variableExprA);
+
+  ASTVariableExpr variableExprB("b");
+  auto tipVarB = std::make_shared<TipVar>(&variableExprB);
+
+  ASTVariableExpr variableExprC("c");
+  auto tipVarC = std::make_shared<TipVar>(&variableExprC);
+
+  // a and b are solved apart from c, which is only known to the target
+  std::vector<TypeConstraint> constraints{
+      TypeConstraint(tipVarA, std::make_shared<TipRef>(tipVarB)),
+      TypeConstraint(tipVarB, tipVarC)};
+  Unifier component(constraints);
+  component.solve();
+
+  std::vector<TypeConstraint> known{
+      TypeConstraint(tipVarC, std::make_shared<TipInt>())};
+  Unifier target(known);
+  target.solve();
+  target.add(component.solution());
+  target.solve();
+
+  std::stringstream a;
+  a << *target.inferred(tipVarA);
+  REQUIRE(a.str() == "\u2B61int");
+
+  std::stringstream b;
+  b << *target.inferred(tipVarB);
+  REQUIRE(b.str() == "int");
+}
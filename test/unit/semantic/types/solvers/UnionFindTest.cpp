@@ -1,5 +1,7 @@
 #include "UnionFind.h"
 #include "ASTNumberExpr.h"
+#include "TipFunction.h"
+#include "TipInt.h"
 #include "TipVar.h"
 
 #include <catch2/catch_test_macros.hpp>
@@ -111,3 +113,47 @@ TEST_CASE("UnionFind: multiple entries", "[UnionFind]") {
   REQUIRE(*unionFind.find(three) == *five);
   cleanup(tipVars);
 }
+
+TEST_CASE("UnionFind: second argument wins regardless of rank",
+          "[UnionFind]") {
+  std::vector<int> ints{3, 4, 5, 6};
+  auto tipVars = std::move(intsToTipVars(ints));
+
+  auto three = tipVars.at(0);
+  auto four = tipVars.at(1);
+  auto five = tipVars.at(2);
+  auto six = tipVars.at(3);
+
+  UnionFind unionFind(tipVars);
+  unionFind.quick_union(three, four);
+  unionFind.quick_union(five, four);
+
+  // The class of six has a lower rank but must still provide the root
+  unionFind.quick_union(four, six);
+
+  REQUIRE(unionFind.find(three) == six);
+  REQUIRE(unionFind.find(five) == six);
+  cleanup(tipVars);
+}
+
+TEST_CASE("UnionFind: structurally equal terms share a class",
+          "[UnionFind]") {
+  std::vector<int> ints{3, 4};
+  auto tipVars = std::move(intsToTipVars(ints));
+
+  auto three = tipVars.at(0);
+  auto four = tipVars.at(1);
+
+  std::vector<std::shared_ptr<TipType>> params{three};
+  auto fun = std::make_shared<TipFunction>(params, std::make_shared<TipInt>());
+  auto funCopy =
+      std::make_shared<TipFunction>(params, std::make_shared<TipInt>());
+
+  UnionFind unionFind(tipVars);
+  unionFind.quick_union(four, fun);
+
+  // The first inserted term is retained as the representative
+  REQUIRE(unionFind.find(funCopy) == fun);
+  REQUIRE(unionFind.connected(four, funCopy));
+  cleanup(tipVars);
+}
@@ -57,6 +57,7 @@ expr : expr '(' (expr (',' expr)*)? ')' 	#funAppExpr
      | IDENTIFIER				#varExpr
      | NUMBER					#numExpr
      | KINPUT					#inputExpr
+     | KCLOCK					#clockExpr
      | KALLOC expr				#allocExpr
      | KNULL					#nullExpr
      | recordExpr				#recordRule
@@ -134,6 +135,7 @@ NUMBER : [0-9]+ ;
 // their matching relative to IDENTIFIER (which comes later).
 KALLOC  : 'alloc' ;
 KINPUT  : 'input' ;
+KCLOCK  : 'clock' ;
 KWHILE  : 'while' ;
 KFOR    : 'for' ;
 KIF     : 'if' ;